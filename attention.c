@@ -1,69 +1,73 @@
+#define _POSIX_C_SOURCE 200809L
 #include "sakura_signals.h"
 
-AttentionLayer* create_attention_layer(int input_dim, int attention_dim, int sequence_length) {
+// SIMD_ALIGNMENT-aligned block of doubles, released with free()
+static double* alloc_aligned_doubles(size_t count) {
+    void *block = NULL;
+    if (count == 0 || posix_memalign(&block, SIMD_ALIGNMENT, count * sizeof(double)) != 0) return NULL;
+    return block;
+}
+
+// splitmix64: a private, seeded stream, so layer construction neither reads nor
+// disturbs the process-wide rand() state and is safe from any thread
+static uint64_t splitmix64_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// uniform on [-1, 1)
+static double splitmix64_symmetric(uint64_t *state) {
+    return (double)(splitmix64_next(state) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+AttentionLayer* create_attention_layer_seeded(int input_dim, int attention_dim, int sequence_length,
+                                              uint64_t seed) {
+    if (input_dim <= 0 || attention_dim <= 0) return NULL;
+    
     AttentionLayer *layer = malloc(sizeof(AttentionLayer));
     if (!layer) return NULL;
     
     layer->input_dim = input_dim;
     layer->attention_dim = attention_dim;
     layer->sequence_length = sequence_length;
+    layer->model = NULL;
     
-    // allocate weight matricies
-    layer->query_weights = malloc(attention_dim * sizeof(double*));
-    layer->key_weights = malloc(attention_dim * sizeof(double*));
-    layer->value_weights = malloc(attention_dim * sizeof(double*));
-    
-    if (!layer->query_weights || !layer->key_weights || !layer->value_weights) {
-        free(layer->query_weights);
-        free(layer->key_weights);
-        free(layer->value_weights);
+    // one contiguous block: Q, then K, then V, each attention_dim x input_dim row-major
+    size_t matrix_size = (size_t)attention_dim * input_dim;
+    layer->weights = alloc_aligned_doubles(3 * matrix_size);
+    if (!layer->weights) {
         free(layer);
         return NULL;
     }
+    layer->query_weights = layer->weights;
+    layer->key_weights = layer->weights + matrix_size;
+    layer->value_weights = layer->weights + 2 * matrix_size;
     
-    // Initialize weight matrices with small random values
-    srand(42); // Fixed seed for reproducibility
-    for (int i = 0; i < attention_dim; i++) {
-        layer->query_weights[i] = malloc(input_dim * sizeof(double));
-        layer->key_weights[i] = malloc(input_dim * sizeof(double));
-        layer->value_weights[i] = malloc(input_dim * sizeof(double));
-        
-        if (!layer->query_weights[i] || !layer->key_weights[i] || !layer->value_weights[i]) {
-            // Cleanup on failure
-            for (int j = 0; j <= i; j++) {
-                free(layer->query_weights[j]);
-                free(layer->key_weights[j]);
-                free(layer->value_weights[j]);
-            }
-            free(layer->query_weights);
-            free(layer->key_weights);
-            free(layer->value_weights);
-            free(layer);
-            return NULL;
-        }
-        
-        // xavier init
-        double scale = sqrt(2.0 / (input_dim + attention_dim));
-        for (int j = 0; j < input_dim; j++) {
-            layer->query_weights[i][j] = ((double)rand() / RAND_MAX - 0.5) * 2 * scale;
-            layer->key_weights[i][j] = ((double)rand() / RAND_MAX - 0.5) * 2 * scale;
-            layer->value_weights[i][j] = ((double)rand() / RAND_MAX - 0.5) * 2 * scale;
-        }
+    // xavier init, Q, K and V drawn in turn for each element
+    uint64_t state = seed;
+    double scale = sqrt(2.0 / (input_dim + attention_dim));
+    for (size_t i = 0; i < matrix_size; i++) {
+        layer->query_weights[i] = splitmix64_symmetric(&state) * scale;
+        layer->key_weights[i] = splitmix64_symmetric(&state) * scale;
+        layer->value_weights[i] = splitmix64_symmetric(&state) * scale;
     }
     
     return layer;
 }
 
+AttentionLayer* create_attention_layer(int input_dim, int attention_dim, int sequence_length) {
+    return create_attention_layer_seeded(input_dim, attention_dim, sequence_length, ATTENTION_DEFAULT_SEED);
+}
+
 void destroy_attention_layer(AttentionLayer *layer) {
     if (layer) {
-        for (int i = 0; i < layer->attention_dim; i++) {
-            free(layer->query_weights[i]);
-            free(layer->key_weights[i]);
-            free(layer->value_weights[i]);
+        if (layer->model) {
+            attention_model_close(layer->model);
+        } else {
+            free(layer->weights);
         }
-        free(layer->query_weights);
-        free(layer->key_weights);
-        free(layer->value_weights);
         free(layer);
     }
 }
@@ -98,42 +102,39 @@ void destroy_attention_output(AttentionOutput *output) {
     }
 }
 
+// fresh array; the caller frees it. Prefer softmax_into / softmax_inplace, which
+// do not allocate.
 double* softmax(double *scores, int length) {
     double *result = malloc(length * sizeof(double));
     if (!result) return NULL;
     
-    // Find max for numerical stability
-    double max_score = scores[0];
-    for (int i = 1; i < length; i++) {
-        if (scores[i] > max_score) {
-            max_score = scores[i];
-        }
-    }
-    
-    // Calculate exp and sum
-    double sum = 0.0;
-    for (int i = 0; i < length; i++) {
-        result[i] = exp(scores[i] - max_score);
-        sum += result[i];
-    }
+    softmax_into(scores, result, length);
+    return result;
+}
+
+void softmax_inplace(double *scores, int length) {
+    simd_softmax(scores, scores, length);
+}
+
+void softmax_into(const double *scores, double *out, int length) {
+    simd_softmax(scores, out, length);
+}
+
+// each of `rows` rows of `cols` scores, `stride` doubles apart, normalized in place
+void softmax_rows(double *scores, int rows, int cols, int stride) {
+    if (!scores || rows <= 0 || cols <= 0 || stride < cols) return;
     
-    // Normalize
-    for (int i = 0; i < length; i++) {
-        result[i] /= sum;
+    for (int r = 0; r < rows; r++) {
+        simd_softmax(scores + (size_t)r * stride, scores + (size_t)r * stride, cols);
     }
-    
-    return result;
 }
 
-double* matrix_multiply(double **matrix, double *vector, int rows, int cols) {
+// row-major rows x cols matrix times a vector, into a fresh array
+double* matrix_multiply(const double *matrix, const double *vector, int rows, int cols) {
     double *result = calloc(rows, sizeof(double));
     if (!result) return NULL;
     
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            result[i] += matrix[i][j] * vector[j];
-        }
-    }
+    simd_gemm_nt(1, rows, cols, 1.0, vector, cols, matrix, cols, 0.0, result, rows);
     
     return result;
 }
@@ -252,3 +253,276 @@ double calculate_attention_enhanced_zscore(CircularBuffer *spread_buffer, Attent
     destroy_attention_output(att_output);
     return enhanced_zscore;
 }
+
+// Streaming form of calculate_attention_enhanced_zscore. With x_i the window
+// (i = 0 oldest) and s_i = 0.7 * (i + 1) / n + 0.3 * |x_i|, the reference computes
+// weights s_i / T, T = 0.7 * (n + 1) / 2 + 0.3 * sum|x|, then a weighted mean,
+// a weighted variance and a weighted sum of first differences. Each of those is a
+// ratio of the running sums in AttentionStream; the differences telescope except
+// for the |x_i| * x_(i-1) lag term, which slides like the others. Dropping the
+// oldest value lowers every position by one, i.e. subtracts the plain sums from
+// the position-weighted ones. An exact rebuild every `capacity` pushes bounds
+// rounding drift at O(1) amortized cost.
+
+#define ATTENTION_STREAM_MIN_REBUILD 64
+
+void attention_stream_rebuild(AttentionStream *stream, CircularBuffer *buffer) {
+    memset(stream, 0, sizeof(*stream));
+    int n = cb_size(buffer);
+    if (n == 0) return;
+
+    for (int i = 0; i < n; i++) stream->center += cb_get(buffer, i);
+    stream->center /= n;
+
+    double prev_y = 0.0;
+    for (int i = 0; i < n; i++) {
+        double x = cb_get(buffer, i);
+        double y = x - stream->center;
+        double a = fabs(x);
+        stream->sum += y;
+        stream->sumsq += y * y;
+        stream->sum_abs += a;
+        stream->pos_sum += (i + 1) * y;
+        stream->pos_sumsq += (i + 1) * y * y;
+        stream->abs_sum += a * y;
+        stream->abs_sumsq += a * y * y;
+        if (i > 0) stream->lag_abs += a * prev_y;
+        prev_y = y;
+    }
+    stream->count = n;
+}
+
+void attention_stream_push(AttentionStream *stream, CircularBuffer *buffer, double value) {
+    int n = cb_size(buffer);
+    if (stream->count != n) attention_stream_rebuild(stream, buffer); // buffer was filled directly
+    if (n == 0) stream->center = value;
+
+    double c = stream->center;
+    if (n == buffer->capacity && n > 0) {
+        double y0 = cb_get(buffer, 0) - c;
+        double a0 = fabs(y0 + c);
+
+        stream->pos_sum -= stream->sum;
+        stream->pos_sumsq -= stream->sumsq;
+        stream->sum -= y0;
+        stream->sumsq -= y0 * y0;
+        stream->sum_abs -= a0;
+        stream->abs_sum -= a0 * y0;
+        stream->abs_sumsq -= a0 * y0 * y0;
+        if (n > 1) stream->lag_abs -= fabs(cb_get(buffer, 1)) * y0;
+        stream->count--;
+    }
+
+    double y = value - c;
+    double a = fabs(value);
+    int weight = stream->count + 1;
+    stream->sum += y;
+    stream->sumsq += y * y;
+    stream->sum_abs += a;
+    stream->pos_sum += weight * y;
+    stream->pos_sumsq += weight * y * y;
+    stream->abs_sum += a * y;
+    stream->abs_sumsq += a * y * y;
+    if (n > 0) stream->lag_abs += a * (cb_get(buffer, n - 1) - c);
+    stream->count++;
+
+    cb_push(buffer, value);
+
+    int rebuild_every = buffer->capacity > ATTENTION_STREAM_MIN_REBUILD ? buffer->capacity : ATTENTION_STREAM_MIN_REBUILD;
+    if (++stream->pushes >= rebuild_every) attention_stream_rebuild(stream, buffer);
+}
+
+double attention_stream_zscore(AttentionStream *stream, CircularBuffer *buffer, AttentionLayer *attention) {
+    int n = cb_size(buffer);
+    if (!attention || n < 5) return calculate_attention_enhanced_zscore(buffer, attention);
+    if (stream->count != n) attention_stream_rebuild(stream, buffer);
+
+    double c = stream->center;
+    double total = 0.7 * (n + 1) / 2.0 + 0.3 * stream->sum_abs;
+    double recency = 0.7 / n;
+
+    double mean = (recency * stream->pos_sum + 0.3 * stream->abs_sum) / total;
+    double second = (recency * stream->pos_sumsq + 0.3 * stream->abs_sumsq) / total;
+    double variance = second - mean * mean;
+
+    // below rounding noise the window is flat, which the reference also scores as 0
+    if (variance <= 1e-14 * second) return 0.0;
+
+    double current = cb_get(buffer, n - 1) - c;
+    double zscore = (current - mean) / sqrt(variance);
+
+    if (attention->attention_dim > 1) {
+        double y0 = cb_get(buffer, 0) - c;
+        double recency_diff = (n + 1) * current - y0 - stream->sum;
+        double magnitude_diff = stream->abs_sum - fabs(y0 + c) * y0 - stream->lag_abs;
+        double momentum = (recency * recency_diff + 0.3 * magnitude_diff) / total;
+        zscore += momentum * 0.1;
+    }
+
+    return zscore;
+}
+
+// ---- batched multi-feature attention ----------------------------------------
+//
+// Each pair contributes a window of T steps with ATTENTION_N_FEATURES features
+// (standardized spread, standardized spread change, EW volatility of the change).
+// All pairs' windows are stacked into one (pairs * T) x F matrix, so the key and
+// value projections are a single GEMM against the shared weights. The last
+// n_queries steps of each pair attend causally over that pair's window:
+//   scores  = Q K^T / sqrt(D)   (masked so step t sees steps <= t)
+//   weights = softmax(scores)
+//   context = weights V
+
+#define ATTENTION_VOL_DECAY 0.94
+
+AttentionBatch* create_attention_batch(const AttentionLayer *layer, int n_pairs, int n_queries) {
+    if (!layer || n_pairs <= 0 || layer->sequence_length <= 0) return NULL;
+    int t = layer->sequence_length;
+    if (n_queries <= 0 || n_queries > t) n_queries = t;
+
+    AttentionBatch *batch = calloc(1, sizeof(AttentionBatch));
+    if (!batch) return NULL;
+
+    batch->n_pairs = n_pairs;
+    batch->sequence_length = t;
+    batch->n_features = layer->input_dim;
+    batch->attention_dim = layer->attention_dim;
+    batch->n_queries = n_queries;
+
+    size_t rows = (size_t)n_pairs * t;
+    size_t query_rows = (size_t)n_pairs * n_queries;
+    batch->inputs = alloc_aligned_doubles(rows * batch->n_features);
+    batch->queries = alloc_aligned_doubles(query_rows * batch->attention_dim);
+    batch->keys = alloc_aligned_doubles(rows * batch->attention_dim);
+    batch->values = alloc_aligned_doubles(rows * batch->attention_dim);
+    batch->scores = alloc_aligned_doubles(query_rows * t);
+    batch->context = alloc_aligned_doubles(query_rows * batch->attention_dim);
+    batch->ready = calloc(n_pairs, sizeof(bool));
+
+    if (!batch->inputs || !batch->queries || !batch->keys || !batch->values ||
+        !batch->scores || !batch->context || !batch->ready) {
+        destroy_attention_batch(batch);
+        return NULL;
+    }
+    memset(batch->inputs, 0, rows * batch->n_features * sizeof(double));
+
+    return batch;
+}
+
+void destroy_attention_batch(AttentionBatch *batch) {
+    if (batch) {
+        free(batch->inputs);
+        free(batch->queries);
+        free(batch->keys);
+        free(batch->values);
+        free(batch->scores);
+        free(batch->context);
+        free(batch->ready);
+        free(batch);
+    }
+}
+
+bool attention_batch_set_window(AttentionBatch *batch, int pair, CircularBuffer *spread) {
+    if (!batch || pair < 0 || pair >= batch->n_pairs) return false;
+    batch->ready[pair] = false;
+    if (!spread || batch->n_features != ATTENTION_N_FEATURES) return false;
+
+    int t = batch->sequence_length;
+    int n = cb_size(spread);
+    if (n < t) return false;
+    int first = n - t;
+
+    double mean = 0.0;
+    for (int i = first; i < n; i++) mean += cb_get(spread, i);
+    mean /= t;
+    double var = 0.0;
+    for (int i = first; i < n; i++) {
+        double d = cb_get(spread, i) - mean;
+        var += d * d;
+    }
+    double inv_std = var > 0.0 ? 1.0 / sqrt(var / t) : 0.0;
+
+    double *row = batch->inputs + (size_t)pair * t * ATTENTION_N_FEATURES;
+    double prev = first > 0 ? cb_get(spread, first - 1) : cb_get(spread, first);
+    double vol2 = -1.0;
+    for (int i = first; i < n; i++, row += ATTENTION_N_FEATURES) {
+        double x = cb_get(spread, i);
+        double change = (x - prev) * inv_std;
+        vol2 = vol2 < 0.0 ? change * change
+                          : ATTENTION_VOL_DECAY * vol2 + (1.0 - ATTENTION_VOL_DECAY) * change * change;
+        row[0] = (x - mean) * inv_std;
+        row[1] = change;
+        row[2] = sqrt(vol2);
+        prev = x;
+    }
+
+    batch->ready[pair] = true;
+    return true;
+}
+
+static void softmax_row_masked(double *row, int valid, int length) {
+    softmax_inplace(row, valid);
+    for (int s = valid; s < length; s++) row[s] = 0.0;
+}
+
+bool attention_batch_forward(const AttentionLayer *layer, AttentionBatch *batch) {
+    if (!layer || !batch || layer->input_dim != batch->n_features ||
+        layer->attention_dim != batch->attention_dim || layer->sequence_length != batch->sequence_length) {
+        return false;
+    }
+
+    int t = batch->sequence_length;
+    int f = batch->n_features;
+    int d = batch->attention_dim;
+    int nq = batch->n_queries;
+    int rows = batch->n_pairs * t;
+
+    // shared-weight projections over every pair's window at once
+    simd_gemm_nt(rows, d, f, 1.0, batch->inputs, f, layer->key_weights, f, 0.0, batch->keys, d);
+    simd_gemm_nt(rows, d, f, 1.0, batch->inputs, f, layer->value_weights, f, 0.0, batch->values, d);
+    if (nq == t) {
+        simd_gemm_nt(rows, d, f, 1.0, batch->inputs, f, layer->query_weights, f, 0.0, batch->queries, d);
+    } else {
+        for (int p = 0; p < batch->n_pairs; p++) {
+            const double *last = batch->inputs + ((size_t)p * t + (t - nq)) * f;
+            simd_gemm_nt(nq, d, f, 1.0, last, f, layer->query_weights, f, 0.0,
+                         batch->queries + (size_t)p * nq * d, d);
+        }
+    }
+
+    double scale = 1.0 / sqrt((double)d);
+    for (int p = 0; p < batch->n_pairs; p++) {
+        const double *q = batch->queries + (size_t)p * nq * d;
+        const double *k = batch->keys + (size_t)p * t * d;
+        const double *v = batch->values + (size_t)p * t * d;
+        double *scores = batch->scores + (size_t)p * nq * t;
+
+        simd_gemm_nt(nq, t, d, scale, q, d, k, d, 0.0, scores, t);
+        for (int r = 0; r < nq; r++) {
+            softmax_row_masked(scores + (size_t)r * t, t - nq + r + 1, t);
+        }
+        simd_gemm_nn(nq, d, t, 1.0, scores, t, v, d, 0.0, batch->context + (size_t)p * nq * d, d);
+    }
+
+    return true;
+}
+
+// z-score of the latest spread against its attention-weighted mean and dispersion
+double attention_batch_zscore(const AttentionBatch *batch, int pair) {
+    if (!batch || pair < 0 || pair >= batch->n_pairs || batch->n_features < 1) return 0.0;
+
+    int t = batch->sequence_length;
+    int f = batch->n_features;
+    const double *weights = batch->scores + ((size_t)pair * batch->n_queries + batch->n_queries - 1) * t;
+    const double *window = batch->inputs + (size_t)pair * t * f;
+
+    double mean = 0.0;
+    for (int s = 0; s < t; s++) mean += weights[s] * window[(size_t)s * f];
+    double var = 0.0;
+    for (int s = 0; s < t; s++) {
+        double diff = window[(size_t)s * f] - mean;
+        var += weights[s] * diff * diff;
+    }
+
+    return var > 0.0 ? (window[(size_t)(t - 1) * f] - mean) / sqrt(var) : 0.0;
+}
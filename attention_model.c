@@ -0,0 +1,178 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Attention model file, native byte order:
+//
+//   [AttentionModelHeader]     64 bytes
+//   [weights]                  Q, K, V back to back, each attention_dim x input_dim
+//                              row-major doubles, starting at weights_offset
+//
+// The file is mapped read-only and shared: every layer opened on a model points
+// into the same pages, and so does every other process mapping the same file, so
+// a layer costs one small struct however many trackers use the model. Models are
+// reference counted; the mapping goes away with the last layer or handle.
+// attention_model_save writes a temporary file and renames it over the target, so
+// processes still mapping the previous version keep reading consistent weights.
+
+#define ATTENTION_MODEL_MAGIC "SAKATTN1"
+#define ATTENTION_MODEL_VERSION 1
+#define ATTENTION_MODEL_MAX_DIM (1u << 20)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t input_dim;
+    uint32_t attention_dim;
+    uint32_t reserved0;
+    uint64_t n_weights;
+    uint64_t weights_offset;
+    uint8_t reserved[24];
+} AttentionModelHeader;
+
+struct AttentionModel {
+    void *map;
+    size_t map_size;
+    const double *weights;
+    int input_dim;
+    int attention_dim;
+    int refs;
+    uint64_t fingerprint;    // 0 until first asked for
+};
+
+bool attention_model_save(const AttentionLayer *layer, const char *path) {
+    if (!layer || !layer->weights || !path) return false;
+
+    size_t path_len = strlen(path);
+    char *tmp_path = malloc(path_len + 5);
+    if (!tmp_path) return false;
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        free(tmp_path);
+        return false;
+    }
+
+    AttentionModelHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ATTENTION_MODEL_MAGIC, 8);
+    header.version = ATTENTION_MODEL_VERSION;
+    header.input_dim = (uint32_t)layer->input_dim;
+    header.attention_dim = (uint32_t)layer->attention_dim;
+    header.n_weights = 3 * (uint64_t)layer->attention_dim * layer->input_dim;
+    header.weights_offset = sizeof(AttentionModelHeader);
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(layer->weights, sizeof(double), header.n_weights, fp) == header.n_weights;
+    ok = (fclose(fp) == 0) && ok;
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok) remove(tmp_path);
+
+    free(tmp_path);
+    return ok;
+}
+
+AttentionModel* attention_model_open(const char *path) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AttentionModelHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const AttentionModelHeader *header = map;
+    uint64_t expected = 3 * (uint64_t)header->attention_dim * header->input_dim;
+    if (memcmp(header->magic, ATTENTION_MODEL_MAGIC, 8) != 0 || header->version != ATTENTION_MODEL_VERSION ||
+        header->input_dim == 0 || header->attention_dim == 0 ||
+        header->input_dim > ATTENTION_MODEL_MAX_DIM || header->attention_dim > ATTENTION_MODEL_MAX_DIM ||
+        header->n_weights != expected || header->weights_offset % SIMD_ALIGNMENT != 0 ||
+        header->weights_offset > size || (size - header->weights_offset) / sizeof(double) < expected) {
+        munmap(map, size);
+        return NULL;
+    }
+
+    AttentionModel *model = malloc(sizeof(AttentionModel));
+    if (!model) {
+        munmap(map, size);
+        return NULL;
+    }
+    model->map = map;
+    model->map_size = size;
+    model->weights = (const double*)((const uint8_t*)map + header->weights_offset);
+    model->input_dim = (int)header->input_dim;
+    model->attention_dim = (int)header->attention_dim;
+    model->refs = 1;
+    model->fingerprint = 0;
+
+    return model;
+}
+
+// drops one reference; the caller's handle from attention_model_open is one of them
+void attention_model_close(AttentionModel *model) {
+    if (model && __atomic_sub_fetch(&model->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        munmap(model->map, model->map_size);
+        free(model);
+    }
+}
+
+int attention_model_input_dim(const AttentionModel *model) {
+    return model ? model->input_dim : 0;
+}
+
+int attention_model_attention_dim(const AttentionModel *model) {
+    return model ? model->attention_dim : 0;
+}
+
+// FNV-1a over the weight bytes, computed once; snapshots use it to check that a
+// model-backed tracker is re-attached to the weights it was saved with
+uint64_t attention_model_fingerprint(AttentionModel *model) {
+    if (!model) return 0;
+
+    uint64_t h = __atomic_load_n(&model->fingerprint, __ATOMIC_RELAXED);
+    if (h) return h;
+    const uint8_t *bytes = (const uint8_t*)model->weights;
+    size_t n_bytes = 3 * (size_t)model->attention_dim * model->input_dim * sizeof(double);
+    h = 1469598103934665603ULL;
+    for (size_t i = 0; i < n_bytes; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    if (!h) h = 1;
+    __atomic_store_n(&model->fingerprint, h, __ATOMIC_RELAXED);
+    return h;
+}
+
+// the layer's weights are read-only views into the mapping; destroy_attention_layer
+// releases the model instead of freeing them
+AttentionLayer* create_attention_layer_from_model(AttentionModel *model, int sequence_length) {
+    if (!model) return NULL;
+
+    AttentionLayer *layer = malloc(sizeof(AttentionLayer));
+    if (!layer) return NULL;
+
+    size_t matrix_size = (size_t)model->attention_dim * model->input_dim;
+    layer->weights = (double*)model->weights;
+    layer->query_weights = layer->weights;
+    layer->key_weights = layer->weights + matrix_size;
+    layer->value_weights = layer->weights + 2 * matrix_size;
+    layer->input_dim = model->input_dim;
+    layer->attention_dim = model->attention_dim;
+    layer->sequence_length = sequence_length;
+    layer->model = model;
+
+    __atomic_add_fetch(&model->refs, 1, __ATOMIC_RELAXED);
+    return layer;
+}
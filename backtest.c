@@ -0,0 +1,481 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <pthread.h>
+
+// Parameter-sweep backtester. Every configuration replays the same memory-mapped
+// tick file with its own tracker, so the tick data is shared read-only between
+// threads and nothing else is shared except the work counter.
+//
+// Walk-forward mode runs each configuration once over the whole history and keeps
+// a summary per segment. Train windows are scored by combining segment summaries,
+// so overlapping windows reuse one warm tracker instead of replaying from scratch.
+
+#define BACKTEST_ACCOUNT_SIZE 1000000.0 // matches the sizing account in the signal path
+
+// Composable summary of one stretch of the PnL path. Drawdown needs the running
+// peak and trough relative to the stretch start so consecutive stretches combine exactly.
+typedef struct {
+    double pnl;
+    double costs;
+    double peak;            // max cumulative PnL within the stretch (>= 0)
+    double trough;          // min cumulative PnL within the stretch (<= 0)
+    double max_drawdown;
+    double return_sum;
+    double return_sumsq;
+    long n_ticks;
+    int n_trades;
+} BacktestSummary;
+
+typedef struct {
+    PairTracker *tracker;
+    double q1;              // held quantity of asset1
+    double q2;              // held quantity of asset2 (hedge leg)
+    int held_signal;
+    double last1;
+    double last2;
+    long n_ticks;
+    long first_timestamp;
+    long last_timestamp;
+    BacktestSummary *summary;   // stretch being accumulated
+    BacktestSummary *segments;  // walk-forward mode: one summary per segment, else NULL
+    int n_segments;
+    int segment;
+    int64_t segment_start;
+    int64_t segment_micro;
+    const uint8_t *regimes;     // decoded regime per replay step, or NULL
+    long n_regime_steps;
+    double regime_pnl[MAX_REGIMES];
+    long regime_ticks[MAX_REGIMES];
+} BacktestAccount;
+
+typedef struct {
+    const TickFile *file;
+    int symbol1;
+    int symbol2;
+    const BacktestConfig *configs;
+    BacktestResult *results;        // full-run mode
+    BacktestSummary *segments;      // walk-forward mode: n_segments per config
+    int n_segments;
+    int64_t start_micro;
+    int64_t end_micro;
+    int64_t segment_micro;
+    const uint8_t *regimes;
+    long n_regime_steps;
+    int n_configs;
+    int *next_config;
+    bool failed;
+} BacktestWorker;
+
+// A followed by B
+static BacktestSummary combine_summaries(const BacktestSummary *a, const BacktestSummary *b) {
+    BacktestSummary r;
+
+    r.pnl = a->pnl + b->pnl;
+    r.costs = a->costs + b->costs;
+    r.peak = fmax(a->peak, a->pnl + b->peak);
+    r.trough = fmin(a->trough, a->pnl + b->trough);
+    r.max_drawdown = fmax(fmax(a->max_drawdown, b->max_drawdown), a->peak - (a->pnl + b->trough));
+    r.return_sum = a->return_sum + b->return_sum;
+    r.return_sumsq = a->return_sumsq + b->return_sumsq;
+    r.n_ticks = a->n_ticks + b->n_ticks;
+    r.n_trades = a->n_trades + b->n_trades;
+
+    return r;
+}
+
+// annualized by the tick frequency observed over `years`
+static double summary_sharpe(const BacktestSummary *s, double years) {
+    if (s->n_ticks < 2 || years <= 0.0) return 0.0;
+
+    double mean = s->return_sum / s->n_ticks;
+    double var = (s->return_sumsq - s->n_ticks * mean * mean) / (s->n_ticks - 1);
+    if (var <= 0.0) return 0.0;
+
+    return mean / sqrt(var) * sqrt(s->n_ticks / years);
+}
+
+static double micros_to_years(double micros) {
+    return micros / (365.25 * 86400.0 * 1e6);
+}
+
+static void backtest_on_signal(void *ctx, const PairSignalCompact *signal) {
+    BacktestAccount *a = ctx;
+    PairTracker *t = a->tracker;
+    int n = cb_size(t->price_buffer1);
+    double p1 = cb_get(t->price_buffer1, n - 1);
+    double p2 = cb_get(t->price_buffer2, n - 1);
+
+    if (a->segments) {
+        int segment = (int)((signal->timestamp_micro - a->segment_start) / a->segment_micro);
+        if (segment >= a->n_segments) segment = a->n_segments - 1;
+        if (segment != a->segment) {
+            a->segment = segment;
+            a->summary = &a->segments[segment];
+        }
+    }
+    BacktestSummary *s = a->summary;
+
+    // mark to market at the latest trade prices
+    double pnl = a->n_ticks > 0 ? a->q1 * (p1 - a->last1) + a->q2 * (p2 - a->last2) : 0.0;
+
+    // rebalance only when the signal changes; crossing half the quoted spread per leg
+    if (signal->signal != a->held_signal) {
+        double units = signal->signal != 0 ? signal->position_size / p1 : 0.0;
+        double q1 = signal->signal * units;
+        double q2 = -signal->signal * units * t->current_hedge_ratio;
+        double cost = fabs(q1 - a->q1) * 0.5 * t->transaction_costs.bid_ask_spread_asset1 +
+                      fabs(q2 - a->q2) * 0.5 * t->transaction_costs.bid_ask_spread_asset2;
+
+        pnl -= cost;
+        s->costs += cost;
+        s->n_trades++;
+        a->q1 = q1;
+        a->q2 = q2;
+        a->held_signal = signal->signal;
+    }
+
+    // the step index is the tick count: the axis regime_features_from_tick_file decodes on
+    if (a->n_ticks < a->n_regime_steps && a->regimes[a->n_ticks] < MAX_REGIMES) {
+        int regime = a->regimes[a->n_ticks];
+        a->regime_pnl[regime] += pnl;
+        a->regime_ticks[regime]++;
+    }
+
+    a->last1 = p1;
+    a->last2 = p2;
+    s->pnl += pnl;
+    if (s->pnl > s->peak) s->peak = s->pnl;
+    if (s->pnl < s->trough) s->trough = s->pnl;
+    if (s->peak - s->pnl > s->max_drawdown) s->max_drawdown = s->peak - s->pnl;
+
+    double r = pnl / BACKTEST_ACCOUNT_SIZE;
+    s->return_sum += r;
+    s->return_sumsq += r * r;
+    s->n_ticks++;
+
+    if (a->n_ticks == 0) a->first_timestamp = signal->timestamp_micro;
+    a->last_timestamp = signal->timestamp_micro;
+    a->n_ticks++;
+}
+
+static bool run_backtest_config(const BacktestWorker *w, int index) {
+    const BacktestConfig *config = &w->configs[index];
+    PairTracker *tracker = create_enhanced_pair_tracker(config->window_size, true);
+    if (!tracker) return false;
+    pair_tracker_set_params(tracker, &config->params);
+
+    BacktestSummary total;
+    memset(&total, 0, sizeof(total));
+    BacktestAccount account;
+    memset(&account, 0, sizeof(account));
+    account.tracker = tracker;
+    account.summary = &total;
+    account.regimes = w->regimes;
+    account.n_regime_steps = w->regimes ? w->n_regime_steps : 0;
+
+    if (w->segments) {
+        // one continuous pass per configuration: tracker state carries across windows
+        account.segments = &w->segments[(size_t)index * w->n_segments];
+        account.n_segments = w->n_segments;
+        account.segment = 0;
+        account.summary = account.segments;
+        account.segment_start = w->start_micro;
+        account.segment_micro = w->segment_micro;
+    }
+
+    replay_pair_from_tick_file_compact(w->file, tracker, w->symbol1, w->symbol2,
+                                       w->start_micro, w->end_micro, backtest_on_signal, &account);
+
+    if (w->results) {
+        BacktestResult *result = &w->results[index];
+        result->config = *config;
+        result->pnl = total.pnl;
+        result->costs = total.costs;
+        result->sharpe = summary_sharpe(&total, micros_to_years((double)(account.last_timestamp - account.first_timestamp)));
+        result->max_drawdown = total.max_drawdown;
+        result->n_trades = total.n_trades;
+        result->n_ticks = total.n_ticks;
+        memcpy(result->regime_pnl, account.regime_pnl, sizeof(result->regime_pnl));
+        memcpy(result->regime_ticks, account.regime_ticks, sizeof(result->regime_ticks));
+    }
+
+    destroy_pair_tracker(tracker);
+    return true;
+}
+
+static void* backtest_worker_main(void *arg) {
+    BacktestWorker *w = arg;
+
+    for (;;) {
+        int i = __atomic_fetch_add(w->next_config, 1, __ATOMIC_RELAXED);
+        if (i >= w->n_configs) break;
+        if (!run_backtest_config(w, i)) w->failed = true;
+    }
+    return NULL;
+}
+
+static bool run_backtest_pool(BacktestWorker *proto, int n_threads) {
+    if (n_threads < 1) n_threads = 1;
+    if (n_threads > proto->n_configs) n_threads = proto->n_configs;
+
+    BacktestWorker *workers = calloc(n_threads, sizeof(BacktestWorker));
+    pthread_t *threads = malloc(n_threads * sizeof(pthread_t));
+    if (!workers || !threads) {
+        free(workers);
+        free(threads);
+        return false;
+    }
+
+    int next_config = 0;
+    for (int t = 0; t < n_threads; t++) {
+        workers[t] = *proto;
+        workers[t].next_config = &next_config;
+    }
+
+    // the calling thread works too; configs are claimed from a shared counter, so
+    // threads that fail to start just leave more of them to the others
+    int n_started = 1;
+    while (n_started < n_threads &&
+           pthread_create(&threads[n_started], NULL, backtest_worker_main, &workers[n_started]) == 0) {
+        n_started++;
+    }
+    backtest_worker_main(&workers[0]);
+    for (int t = 1; t < n_started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    bool ok = true;
+    for (int t = 0; t < n_threads; t++) {
+        if (workers[t].failed) ok = false;
+    }
+
+    free(workers);
+    free(threads);
+    return ok;
+}
+
+bool backtest_run(const TickFile *file, int symbol1, int symbol2, const BacktestConfig *configs, int n_configs,
+                  int n_threads, BacktestResult *results) {
+    return backtest_run_by_regime(file, symbol1, symbol2, configs, n_configs, n_threads, NULL, 0, results);
+}
+
+// As backtest_run, also splitting PnL and ticks by regime: regimes[t] is the
+// regime of the pair's t-th replay step, e.g. its slice of a RegimePath decoded
+// from regime_features_from_tick_file. Steps past n_regime_steps are not split.
+bool backtest_run_by_regime(const TickFile *file, int symbol1, int symbol2, const BacktestConfig *configs,
+                            int n_configs, int n_threads, const uint8_t *regimes, long n_regime_steps,
+                            BacktestResult *results) {
+    if (!file || !configs || !results || n_configs <= 0) return false;
+    if (symbol1 < 0 || symbol2 < 0 || symbol1 >= file->n_symbols || symbol2 >= file->n_symbols) return false;
+
+    BacktestWorker proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.file = file;
+    proto.symbol1 = symbol1;
+    proto.symbol2 = symbol2;
+    proto.configs = configs;
+    proto.results = results;
+    proto.regimes = regimes;
+    proto.n_regime_steps = n_regime_steps;
+    proto.n_configs = n_configs;
+    proto.start_micro = INT64_MIN;
+    proto.end_micro = INT64_MAX;
+
+    return run_backtest_pool(&proto, n_threads);
+}
+
+WalkForwardResult* walk_forward_run(const TickFile *file, int symbol1, int symbol2, const BacktestConfig *configs,
+                                    int n_configs, const WalkForwardConfig *wf) {
+    if (!file || !configs || !wf || n_configs <= 0 || wf->segment_micro <= 0 || wf->train_segments < 1) return NULL;
+    if (symbol1 < 0 || symbol2 < 0 || symbol1 >= file->n_symbols || symbol2 >= file->n_symbols) return NULL;
+
+    int64_t start = wf->start_micro > file->first_timestamp ? wf->start_micro : file->first_timestamp;
+    int64_t end = wf->end_micro < file->last_timestamp + 1 ? wf->end_micro : file->last_timestamp + 1;
+    if (end <= start) return NULL;
+
+    int64_t n_segments = (end - start + wf->segment_micro - 1) / wf->segment_micro;
+    if (n_segments <= wf->train_segments || n_segments > INT32_MAX / n_configs) return NULL;
+
+    WalkForwardResult *result = calloc(1, sizeof(WalkForwardResult));
+    BacktestSummary *segments = calloc((size_t)n_configs * n_segments, sizeof(BacktestSummary));
+    if (!result || !segments) {
+        free(result);
+        free(segments);
+        return NULL;
+    }
+    result->n_windows = (int)n_segments - wf->train_segments;
+    result->windows = calloc(result->n_windows, sizeof(WalkForwardWindow));
+    if (!result->windows) {
+        free(segments);
+        destroy_walk_forward_result(result);
+        return NULL;
+    }
+
+    BacktestWorker proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.file = file;
+    proto.symbol1 = symbol1;
+    proto.symbol2 = symbol2;
+    proto.configs = configs;
+    proto.segments = segments;
+    proto.n_segments = (int)n_segments;
+    proto.n_configs = n_configs;
+    proto.start_micro = start;
+    proto.end_micro = end;
+    proto.segment_micro = wf->segment_micro;
+
+    if (!run_backtest_pool(&proto, wf->n_threads)) {
+        free(segments);
+        destroy_walk_forward_result(result);
+        return NULL;
+    }
+
+    double train_years = micros_to_years((double)wf->segment_micro * wf->train_segments);
+    double test_years = micros_to_years((double)wf->segment_micro);
+    BacktestSummary out_of_sample;
+    memset(&out_of_sample, 0, sizeof(out_of_sample));
+
+    for (int w = 0; w < result->n_windows; w++) {
+        int test = w + wf->train_segments;
+        int best = 0;
+        double best_sharpe = -INFINITY;
+
+        // in-sample score of each configuration from its per-segment summaries
+        for (int c = 0; c < n_configs; c++) {
+            const BacktestSummary *seg = &segments[(size_t)c * n_segments];
+            BacktestSummary train = seg[w];
+            for (int k = w + 1; k < test; k++) {
+                train = combine_summaries(&train, &seg[k]);
+            }
+            double sharpe = summary_sharpe(&train, train_years);
+            if (sharpe > best_sharpe) {
+                best_sharpe = sharpe;
+                best = c;
+            }
+        }
+
+        const BacktestSummary *oos = &segments[(size_t)best * n_segments + test];
+        WalkForwardWindow *window = &result->windows[w];
+        window->train_start_micro = start + (int64_t)w * wf->segment_micro;
+        window->test_start_micro = start + (int64_t)test * wf->segment_micro;
+        window->test_end_micro = window->test_start_micro + wf->segment_micro;
+        window->best_config = best;
+        window->train_sharpe = best_sharpe;
+        window->test_pnl = oos->pnl;
+        window->test_sharpe = summary_sharpe(oos, test_years);
+        window->test_max_drawdown = oos->max_drawdown;
+
+        out_of_sample = combine_summaries(&out_of_sample, oos);
+    }
+
+    result->pnl = out_of_sample.pnl;
+    result->costs = out_of_sample.costs;
+    result->sharpe = summary_sharpe(&out_of_sample, test_years * result->n_windows);
+    result->max_drawdown = out_of_sample.max_drawdown;
+    result->n_trades = out_of_sample.n_trades;
+
+    free(segments);
+    return result;
+}
+
+void destroy_walk_forward_result(WalkForwardResult *result) {
+    if (result) {
+        free(result->windows);
+        free(result);
+    }
+}
+
+static int axis_count(const BacktestAxis *axis) {
+    return axis->count > 0 ? axis->count : 1;
+}
+
+static double axis_value(const BacktestAxis *axis, int i, double fallback) {
+    return axis->count > 0 ? axis->values[i] : fallback;
+}
+
+bool backtest_expand_grid(const BacktestGrid *grid, BacktestConfig *configs, int max_configs, int *n_configs) {
+    if (!grid || !n_configs) return false;
+
+    const BacktestAxis *axes[8] = {&grid->window_size, &grid->entry_threshold, &grid->exit_threshold,
+                                   &grid->attention_blend, &grid->hedge_lookback, &grid->target_volatility,
+                                   &grid->hedge_mode, &grid->hedge_process_noise};
+    long total = 1;
+    for (int a = 0; a < 8; a++) total *= axis_count(axes[a]);
+
+    *n_configs = (int)total;
+    if (!configs || total > max_configs) return false;
+
+    SignalParams defaults = default_signal_params();
+    int idx[8] = {0};
+    for (long c = 0; c < total; c++) {
+        BacktestConfig *config = &configs[c];
+        config->params = defaults;
+        config->window_size = (int)axis_value(&grid->window_size, idx[0], 50);
+        config->params.entry_threshold = axis_value(&grid->entry_threshold, idx[1], defaults.entry_threshold);
+        config->params.exit_threshold = axis_value(&grid->exit_threshold, idx[2], defaults.exit_threshold);
+        config->params.attention_blend = axis_value(&grid->attention_blend, idx[3], defaults.attention_blend);
+        config->params.hedge_lookback = (int)axis_value(&grid->hedge_lookback, idx[4], defaults.hedge_lookback);
+        config->params.target_volatility = axis_value(&grid->target_volatility, idx[5], defaults.target_volatility);
+        config->params.hedge_mode = (int)axis_value(&grid->hedge_mode, idx[6], defaults.hedge_mode);
+        config->params.hedge_process_noise = axis_value(&grid->hedge_process_noise, idx[7],
+                                                        defaults.hedge_process_noise);
+
+        // odometer over the axes, last axis fastest
+        for (int a = 7; a >= 0; a--) {
+            if (++idx[a] < axis_count(axes[a])) break;
+            idx[a] = 0;
+        }
+    }
+
+    return true;
+}
+
+void print_backtest_results(const BacktestResult *results, int n_results) {
+    if (!results) return;
+
+    printf("%6s %6s %6s %6s %6s %7s %8s %12s %10s %8s %12s %7s\n",
+           "window", "entry", "exit", "blend", "hedge", "tgtvol", "kalman", "pnl", "costs", "sharpe", "max_dd",
+           "trades");
+    for (int i = 0; i < n_results; i++) {
+        const BacktestResult *r = &results[i];
+        const SignalParams *p = &r->config.params;
+        char kalman[16] = "-";
+        if (p->hedge_mode == HEDGE_MODE_KALMAN) snprintf(kalman, sizeof(kalman), "%.0e", p->hedge_process_noise);
+        printf("%6d %6.2f %6.2f %6.2f %6d %7.3f %8s %12.2f %10.2f %8.3f %12.2f %7d\n",
+               r->config.window_size, p->entry_threshold, p->exit_threshold, p->attention_blend,
+               p->hedge_lookback, p->target_volatility, kalman, r->pnl, r->costs, r->sharpe,
+               r->max_drawdown, r->n_trades);
+    }
+}
+
+void print_backtest_regime_results(const BacktestResult *results, int n_results) {
+    if (!results) return;
+
+    printf("%6s %6s %6s %12s %12s %12s %8s %8s %8s\n",
+           "window", "entry", "exit", "pnl_normal", "pnl_stress", "pnl_crisis", "%normal", "%stress", "%crisis");
+    for (int i = 0; i < n_results; i++) {
+        const BacktestResult *r = &results[i];
+        long ticks = r->regime_ticks[0] + r->regime_ticks[1] + r->regime_ticks[2];
+        double scale = ticks > 0 ? 100.0 / ticks : 0.0;
+        printf("%6d %6.2f %6.2f %12.2f %12.2f %12.2f %8.1f %8.1f %8.1f\n",
+               r->config.window_size, r->config.params.entry_threshold, r->config.params.exit_threshold,
+               r->regime_pnl[0], r->regime_pnl[1], r->regime_pnl[2],
+               r->regime_ticks[0] * scale, r->regime_ticks[1] * scale, r->regime_ticks[2] * scale);
+    }
+}
+
+void print_walk_forward_result(const WalkForwardResult *result, const BacktestConfig *configs) {
+    if (!result || !configs) return;
+
+    printf("%6s %6s %6s %6s %7s %10s %12s %10s %12s\n",
+           "window", "cfg", "entry", "exit", "tgtvol", "train_shrp", "test_pnl", "test_shrp", "test_dd");
+    for (int i = 0; i < result->n_windows; i++) {
+        const WalkForwardWindow *w = &result->windows[i];
+        const BacktestConfig *c = &configs[w->best_config];
+        printf("%6d %6d %6.2f %6.2f %7.3f %10.3f %12.2f %10.3f %12.2f\n",
+               c->window_size, w->best_config, c->params.entry_threshold, c->params.exit_threshold,
+               c->params.target_volatility, w->train_sharpe, w->test_pnl, w->test_sharpe, w->test_max_drawdown);
+    }
+    printf("Out of sample: PnL %.2f | Costs %.2f | Sharpe %.3f | Max DD %.2f | Trades %d\n",
+           result->pnl, result->costs, result->sharpe, result->max_drawdown, result->n_trades);
+}
@@ -0,0 +1,219 @@
+#include "sakura_signals.h"
+
+// Basket spread: a target (e.g. an ETF) against k hedging legs (e.g. its
+// constituents). The hedge weights are fitted by recursive least squares with
+// exponential forgetting. Prices are normalized by each asset's first quote so P
+// stays well scaled whatever the price levels. A tick costs one rank-1 update of P,
+// O(k^2), with no inversion and no allocation.
+
+#define BASKET_PRIOR_VARIANCE 1e4 // diffuse prior on the normalized coefficients
+
+BasketTracker* create_basket_tracker(int n_legs, int window_size, double forgetting) {
+    if (n_legs < 1 || n_legs > BASKET_MAX_LEGS || window_size < 10) return NULL;
+    if (!(forgetting > 0.0 && forgetting <= 1.0)) return NULL;
+
+    BasketTracker *basket = calloc(1, sizeof(BasketTracker));
+    if (!basket) return NULL;
+
+    int n_state = n_legs + 1;
+    basket->n_legs = n_legs;
+    basket->coef = calloc(n_state, sizeof(double));
+    basket->covariance = calloc((size_t)n_state * n_state, sizeof(double));
+    basket->gain = calloc(n_state, sizeof(double));
+    basket->scale = calloc(n_state, sizeof(double));
+    basket->weights = calloc(n_legs, sizeof(double));
+    basket->target_buffer = create_circular_buffer(window_size);
+    basket->hedge_buffer = create_circular_buffer(window_size);
+    basket->spread_buffer = create_circular_buffer(window_size);
+    basket->forgetting = forgetting;
+    basket->window_size = window_size;
+    basket->basket_id = -1;
+    basket->params = default_signal_params();
+    basket->dynamic_entry_threshold = basket->params.entry_threshold;
+    basket->dynamic_exit_threshold = basket->params.exit_threshold;
+    basket->half_life = 20.0;
+
+    if (!basket->coef || !basket->covariance || !basket->gain || !basket->scale || !basket->weights ||
+        !basket->target_buffer || !basket->hedge_buffer || !basket->spread_buffer) {
+        destroy_basket_tracker(basket);
+        return NULL;
+    }
+    return basket;
+}
+
+void destroy_basket_tracker(BasketTracker *basket) {
+    if (!basket) return;
+    free(basket->coef);
+    free(basket->covariance);
+    free(basket->gain);
+    free(basket->scale);
+    free(basket->weights);
+    destroy_circular_buffer(basket->target_buffer);
+    destroy_circular_buffer(basket->hedge_buffer);
+    destroy_circular_buffer(basket->spread_buffer);
+    free(basket);
+}
+
+void basket_tracker_set_params(BasketTracker *basket, const SignalParams *params) {
+    if (!basket || !params) return;
+
+    basket->params = *params;
+    if (basket->params.hedge_lookback < 5) basket->params.hedge_lookback = 5;
+    half_life_stream_set_span(&basket->half_life_stream, basket->params.half_life_span);
+    if (basket->position == 0) {
+        basket->dynamic_entry_threshold = basket->params.entry_threshold;
+        basket->dynamic_exit_threshold = basket->params.exit_threshold;
+    }
+}
+
+// first quote: unit-scaled coefficients start at "no hedge, intercept = target"
+static void basket_init_filter(BasketTracker *basket, double target_price, const double *leg_prices) {
+    int k = basket->n_legs;
+    int n_state = k + 1;
+
+    for (int i = 0; i < k; i++) basket->scale[i] = leg_prices[i];
+    basket->scale[k] = target_price;
+
+    memset(basket->coef, 0, n_state * sizeof(double));
+    basket->coef[k] = 1.0;
+    memset(basket->covariance, 0, (size_t)n_state * n_state * sizeof(double));
+    for (int i = 0; i < n_state; i++) basket->covariance[i * n_state + i] = BASKET_PRIOR_VARIANCE;
+    basket->covariance_bound = n_state * BASKET_PRIOR_VARIANCE;
+}
+
+// one RLS step on x = (leg / scale..., 1), y = target / scale
+static void basket_rls_update(BasketTracker *basket, double target_price, const double *leg_prices) {
+    int k = basket->n_legs;
+    int n_state = k + 1;
+    double *P = basket->covariance;
+    double *px = basket->gain;
+    double x[BASKET_MAX_LEGS + 1];
+
+    for (int i = 0; i < k; i++) x[i] = leg_prices[i] / basket->scale[i];
+    x[k] = 1.0;
+    double y = target_price / basket->scale[k];
+
+    // P x, x' P x and the a-priori error
+    double xpx = 0.0, e = y;
+    for (int i = 0; i < n_state; i++) {
+        const double *row = P + (size_t)i * n_state;
+        double acc = 0.0;
+        for (int j = 0; j < n_state; j++) acc += row[j] * x[j];
+        px[i] = acc;
+        xpx += x[i] * acc;
+        e -= basket->coef[i] * x[i];
+    }
+    double s = basket->forgetting + xpx;
+    if (!(s > 0)) return;
+
+    for (int i = 0; i < n_state; i++) basket->coef[i] += px[i] / s * e;
+
+    // P <- (P - P x x' P / s) / lambda; forgetting is skipped while trace(P) is at
+    // the bound, which would otherwise grow without limit along unexcited directions
+    double trace = 0.0;
+    for (int i = 0; i < n_state; i++) trace += P[(size_t)i * n_state + i] - px[i] * px[i] / s;
+    double inv_lambda = trace / basket->forgetting <= basket->covariance_bound ? 1.0 / basket->forgetting : 1.0;
+
+    for (int i = 0; i < n_state; i++) {
+        double *row = P + (size_t)i * n_state;
+        double pi = px[i] / s;
+        for (int j = i; j < n_state; j++) {
+            double v = (row[j] - pi * px[j]) * inv_lambda;
+            row[j] = v;
+            P[(size_t)j * n_state + i] = v;  // kept exactly symmetric
+        }
+    }
+
+    // back to price units
+    for (int i = 0; i < k; i++) basket->weights[i] = basket->coef[i] * basket->scale[k] / basket->scale[i];
+    basket->intercept = basket->coef[k] * basket->scale[k];
+}
+
+PairSignalCompact basket_tracker_update(BasketTracker *basket, double target_price, const double *leg_prices,
+                                        long timestamp_micro) {
+    PairSignalCompact signal;
+    memset(&signal, 0, sizeof(signal));
+    signal.timestamp_micro = timestamp_micro;
+    if (!basket) return signal;
+    signal.pair_id = basket->basket_id;
+
+    // a non-positive or non-finite quote leaves the fit and the position untouched
+    bool valid = target_price > 0 && isfinite(target_price) && leg_prices;
+    for (int i = 0; valid && i < basket->n_legs; i++) {
+        valid = leg_prices[i] > 0 && isfinite(leg_prices[i]);
+    }
+    if (!valid) {
+        signal.signal = (int8_t)basket->last_signal;
+        signal.z_score = basket->last_z_score;
+        signal.position_size = basket->last_position_size;
+        return signal;
+    }
+
+    if (basket->n_updates == 0) basket_init_filter(basket, target_price, leg_prices);
+    basket_rls_update(basket, target_price, leg_prices);
+    basket->n_updates++;
+
+    // spreads of an unconverged fit would sit in the window long after it settles
+    int warmup = basket->params.hedge_lookback;
+    if (warmup < 2 * (basket->n_legs + 1)) warmup = 2 * (basket->n_legs + 1);
+    if (basket->n_updates < warmup) {
+        signal.signal = (int8_t)basket->position;
+        basket->last_signal = basket->position;
+        basket->last_z_score = 0.0;
+        return signal;
+    }
+
+    double hedge_value = basket->intercept;
+    for (int i = 0; i < basket->n_legs; i++) hedge_value += basket->weights[i] * leg_prices[i];
+    double spread = target_price - hedge_value;
+
+    cb_push(basket->target_buffer, target_price);
+    cb_push(basket->hedge_buffer, hedge_value);
+    half_life_stream_advance(&basket->half_life_stream, basket->spread_buffer, spread);
+    cb_push(basket->spread_buffer, spread);
+
+    basket->mean_spread = simd_cb_rolling_mean(basket->spread_buffer);
+    basket->std_spread = simd_cb_rolling_std(basket->spread_buffer);
+
+    // thresholds tighten for faster mean reversion, as in update_dynamic_thresholds
+    basket->dynamic_entry_threshold = basket->params.entry_threshold;
+    basket->dynamic_exit_threshold = basket->params.exit_threshold;
+    if (cb_size(basket->spread_buffer) > 10) {
+        basket->half_life = half_life_stream_half_life(&basket->half_life_stream, basket->spread_buffer);
+        double hl_factor = 20.0 / basket->half_life;
+        basket->dynamic_entry_threshold *= hl_factor;
+        basket->dynamic_exit_threshold *= hl_factor;
+    }
+    if (basket->dynamic_entry_threshold < 0.5) basket->dynamic_entry_threshold = 0.5;
+    if (basket->dynamic_exit_threshold < 0.1) basket->dynamic_exit_threshold = 0.1;
+
+    double z_score = calculate_z_score(spread, basket->mean_spread, basket->std_spread);
+    int trade_signal = mean_reversion_step(&basket->position, z_score,
+                                           basket->dynamic_entry_threshold, basket->dynamic_exit_threshold);
+
+    basket->last_z_score = z_score;
+    basket->last_signal = trade_signal;
+    basket->last_position_size = 10000.0; // notional of the target leg, as the pair tracker's default
+
+    signal.signal = (int8_t)trade_signal;
+    signal.z_score = z_score;
+    signal.position_size = basket->last_position_size;
+    return signal;
+}
+
+// units[0] for the target, units[1 + i] for leg i: the current position's
+// notional in the target and the fitted hedge against it
+void basket_tracker_positions(const BasketTracker *basket, double target_price, double *units) {
+    if (!basket || !units) return;
+
+    double target_units = target_price > 0 ? basket->position * basket->last_position_size / target_price : 0.0;
+    units[0] = target_units;
+    for (int i = 0; i < basket->n_legs; i++) units[1 + i] = -target_units * basket->weights[i];
+}
+
+// Johansen statistic of the target against its fitted hedge value, over the
+// spread window: the basket collapses to a pair with a known hedge
+double basket_cointegration_stat(BasketTracker *basket) {
+    if (!basket) return 0.0;
+    return johansen_test(basket->target_buffer, basket->hedge_buffer);
+}
@@ -0,0 +1,583 @@
+#include "sakura_signals.h"
+
+// Microbenchmarks for the public kernels. Prints one JSON document on stdout,
+// progress on stderr:  ./sakura_signals_bench [max_window] > bench.json
+
+#define BENCH_MIN_WINDOW 16
+#define BENCH_MAX_WINDOW 4096
+#define BENCH_BATCHES 21
+#define BENCH_BATCH_NS 2000000ULL   // target duration of one timed batch
+#define BENCH_WARMUP_NS 300000000ULL
+#define BENCH_TICKS 65536           // length of the cycled synthetic price path
+#define BENCH_MATRIX_SERIES 8
+#define BENCH_BATCH_DIM 8           // attention_dim of the batched QKV layer
+#define BENCH_BATCH_QUERIES 4
+
+typedef struct {
+    int window;
+    CircularBuffer *cb1;
+    CircularBuffer *cb2;
+    CircularBuffer **series;
+    double *contiguous;
+    double *scores;                  // softmax output, window doubles
+    AttentionLayer *attention;
+    CircularBuffer *stream_buffer;   // spread window followed by `stream`
+    AttentionStream stream;
+    RegimeDetector *detector;
+    CorrelationMatrix *matrix;
+    PairUniverse *universe;          // BENCH_MATRIX_SERIES pairs for the batched attention step
+    AttentionLayer *batch_layer;
+    AttentionBatch *batch;
+    double *batch_zscores;
+    PairTracker *tracker;
+    double *prices1;
+    double *prices2;
+    int tick;
+} BenchContext;
+
+typedef void (*BenchKernel)(BenchContext *ctx);
+
+typedef struct {
+    double median_ns;
+    double mean_ns;
+    double min_ns;
+    double max_ns;
+    double mad_ns;
+    int outliers;
+    long iterations;
+} BenchResult;
+
+static volatile double bench_sink = 0.0;
+static bool bench_mismatch = false;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static bool first_result = true;
+
+static double bench_uniform(void) {
+    // xorshift64*, deterministic across runs so builds are comparable
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double)((rng_state * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0;
+}
+
+static void generate_price_path(double *prices1, double *prices2, int n) {
+    double p1 = 100.0, p2 = 95.0;
+    for (int i = 0; i < n; i++) {
+        double r1 = (bench_uniform() - 0.5) * 0.02;
+        double r2 = 0.75 * r1 + sqrt(1 - 0.75 * 0.75) * (bench_uniform() - 0.5) * 0.02;
+        p1 *= (1 + r1);
+        p2 *= (1 + r2);
+        prices1[i] = p1;
+        prices2[i] = p2;
+    }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// spin until the clock governor has settled at full frequency
+static void warm_up_cpu(void) {
+    uint64_t start = latency_now_ns();
+    double x = 1.0;
+    while (latency_now_ns() - start < BENCH_WARMUP_NS) {
+        for (int i = 0; i < 10000; i++) x = x * 1.0000001 + 1e-9;
+    }
+    bench_sink += x;
+}
+
+static BenchResult run_kernel(BenchKernel kernel, BenchContext *ctx) {
+    BenchResult result = {0};
+
+    // calibrate iterations per batch to roughly BENCH_BATCH_NS
+    long iterations = 1;
+    for (;;) {
+        uint64_t t0 = latency_now_ns();
+        for (long i = 0; i < iterations; i++) kernel(ctx);
+        uint64_t elapsed = latency_now_ns() - t0;
+        if (elapsed >= BENCH_BATCH_NS / 4 || iterations >= (1L << 26)) {
+            if (elapsed > 0) iterations = (long)((double)iterations * BENCH_BATCH_NS / elapsed);
+            if (iterations < 1) iterations = 1;
+            break;
+        }
+        iterations *= 4;
+    }
+
+    double samples[BENCH_BATCHES];
+    for (int b = 0; b < BENCH_BATCHES; b++) {
+        uint64_t t0 = latency_now_ns();
+        for (long i = 0; i < iterations; i++) kernel(ctx);
+        samples[b] = (double)(latency_now_ns() - t0) / iterations;
+    }
+
+    qsort(samples, BENCH_BATCHES, sizeof(double), compare_doubles);
+    result.median_ns = samples[BENCH_BATCHES / 2];
+    result.min_ns = samples[0];
+    result.max_ns = samples[BENCH_BATCHES - 1];
+    result.iterations = iterations;
+
+    // median absolute deviation; batches beyond 3 MADs (interrupts, migrations) are dropped
+    double deviations[BENCH_BATCHES];
+    for (int b = 0; b < BENCH_BATCHES; b++) deviations[b] = fabs(samples[b] - result.median_ns);
+    qsort(deviations, BENCH_BATCHES, sizeof(double), compare_doubles);
+    result.mad_ns = deviations[BENCH_BATCHES / 2];
+
+    double limit = 3.0 * 1.4826 * result.mad_ns;
+    double sum = 0.0;
+    int kept = 0;
+    for (int b = 0; b < BENCH_BATCHES; b++) {
+        if (fabs(samples[b] - result.median_ns) <= limit || result.mad_ns == 0.0) {
+            sum += samples[b];
+            kept++;
+        }
+    }
+    result.outliers = BENCH_BATCHES - kept;
+    result.mean_ns = kept > 0 ? sum / kept : result.median_ns;
+
+    return result;
+}
+
+static void emit_result(const char *kernel, int window, const BenchResult *r) {
+    printf("%s    {\"kernel\": \"%s\", \"window\": %d, \"ns_per_op\": %.2f, \"mean_ns\": %.2f, "
+           "\"min_ns\": %.2f, \"max_ns\": %.2f, \"mad_ns\": %.2f, \"outliers\": %d, \"iterations\": %ld}",
+           first_result ? "" : ",\n", kernel, window, r->median_ns, r->mean_ns,
+           r->min_ns, r->max_ns, r->mad_ns, r->outliers, r->iterations);
+    first_result = false;
+    fprintf(stderr, "  %-36s w=%-5d %12.1f ns/op\n", kernel, window, r->median_ns);
+}
+
+// ---- kernels ---------------------------------------------------------------
+
+static double next_price(BenchContext *ctx, double **second) {
+    int t = ctx->tick;
+    ctx->tick = (ctx->tick + 1) % BENCH_TICKS;
+    *second = &ctx->prices2[t];
+    return ctx->prices1[t];
+}
+
+static void kernel_cb_push(BenchContext *ctx) {
+    double *p2;
+    cb_push(ctx->cb1, next_price(ctx, &p2));
+}
+
+static void kernel_rolling_mean(BenchContext *ctx) {
+    bench_sink += rolling_mean(ctx->cb1);
+}
+
+static void kernel_simd_rolling_mean(BenchContext *ctx) {
+    bench_sink += simd_rolling_mean(ctx->contiguous, ctx->window);
+}
+
+static void kernel_simd_cb_rolling_mean(BenchContext *ctx) {
+    bench_sink += simd_cb_rolling_mean(ctx->cb1);
+}
+
+static void kernel_rolling_std(BenchContext *ctx) {
+    bench_sink += rolling_std(ctx->cb1);
+}
+
+static void kernel_simd_rolling_std(BenchContext *ctx) {
+    bench_sink += simd_rolling_std(ctx->contiguous, ctx->window);
+}
+
+static void kernel_calculate_correlation(BenchContext *ctx) {
+    bench_sink += calculate_correlation(ctx->cb1, ctx->cb2);
+}
+
+static void kernel_simd_cb_correlation(BenchContext *ctx) {
+    bench_sink += simd_cb_correlation(ctx->cb1, ctx->cb2);
+}
+
+static void kernel_softmax(BenchContext *ctx) {
+    double *weights = softmax(ctx->contiguous, ctx->window);
+    bench_sink += weights[0];
+    free(weights);
+}
+
+static void kernel_softmax_into(BenchContext *ctx) {
+    softmax_into(ctx->contiguous, ctx->scores, ctx->window);
+    bench_sink += ctx->scores[0];
+}
+
+static void kernel_update_correlation_matrix(BenchContext *ctx) {
+    update_correlation_matrix(ctx->matrix, ctx->series, BENCH_MATRIX_SERIES);
+    bench_sink += ctx->matrix->matrix[0][1];
+}
+
+static void kernel_engle_granger(BenchContext *ctx) {
+    bench_sink += engle_granger_test(ctx->cb1, ctx->cb2);
+}
+
+static void kernel_johansen(BenchContext *ctx) {
+    bench_sink += johansen_test(ctx->cb1, ctx->cb2);
+}
+
+static void kernel_attention_zscore(BenchContext *ctx) {
+    bench_sink += calculate_attention_enhanced_zscore(ctx->cb1, ctx->attention);
+}
+
+static void kernel_attention_stream_zscore(BenchContext *ctx) {
+    double *p2;
+    double p1 = next_price(ctx, &p2);
+    attention_stream_push(&ctx->stream, ctx->stream_buffer, p1 - *p2);
+    bench_sink += attention_stream_zscore(&ctx->stream, ctx->stream_buffer, ctx->attention);
+}
+
+static void kernel_attention_step(BenchContext *ctx) {
+    pair_universe_attention_step(ctx->universe, ctx->batch_layer, ctx->batch, ctx->batch_zscores);
+    bench_sink += ctx->batch_zscores[0];
+}
+
+static void kernel_update_regime(BenchContext *ctx) {
+    double *p2;
+    double p1 = next_price(ctx, &p2);
+    update_regime(ctx->detector, p1, *p2, 0.75);
+    bench_sink += ctx->detector->regime_confidence;
+}
+
+static void kernel_pairs_signal(BenchContext *ctx) {
+    double *p2;
+    double p1 = next_price(ctx, &p2);
+    PairSignal s = generate_pairs_signal(ctx->tracker, p1, *p2);
+    bench_sink += s.z_score;
+}
+
+static void kernel_pairs_signal_attention(BenchContext *ctx) {
+    double *p2;
+    double p1 = next_price(ctx, &p2);
+    PairSignal s = generate_pairs_signal_with_attention(ctx->tracker, p1, *p2);
+    bench_sink += s.z_score;
+}
+
+static void kernel_enhanced_signal(BenchContext *ctx) {
+    double *p2;
+    double p1 = next_price(ctx, &p2);
+    double h1 = p1 * 0.0001, h2 = *p2 * 0.0001;
+    PairSignal s = generate_enhanced_pairs_signal(ctx->tracker, p1, *p2,
+        p1 - h1, p1 + h1, *p2 - h2, *p2 + h2, 1640995200000000L + ctx->tick);
+    bench_sink += s.z_score;
+}
+
+static void kernel_compact_signal(BenchContext *ctx) {
+    double *p2;
+    double p1 = next_price(ctx, &p2);
+    double h1 = p1 * 0.0001, h2 = *p2 * 0.0001;
+    PairSignalCompact s = generate_compact_pairs_signal(ctx->tracker, p1, *p2,
+        p1 - h1, p1 + h1, *p2 - h2, *p2 + h2, 1640995200000000L + ctx->tick);
+    bench_sink += s.z_score;
+}
+
+// ---- fixtures --------------------------------------------------------------
+
+static void fill_buffers(BenchContext *ctx) {
+    for (int i = 0; i < ctx->window; i++) {
+        cb_push(ctx->cb1, ctx->prices1[i]);
+        cb_push(ctx->cb2, ctx->prices2[i]);
+        ctx->contiguous[i] = ctx->prices1[i];
+    }
+    for (int s = 0; s < BENCH_MATRIX_SERIES; s++) {
+        for (int i = 0; i < ctx->window; i++) {
+            cb_push(ctx->series[s], ctx->prices1[(i + 97 * s) % BENCH_TICKS] * (1 + 0.01 * s));
+        }
+    }
+    for (int p = 0; p < ctx->universe->n_pairs; p++) {
+        for (int i = 0; i < ctx->window; i++) {
+            int t = (i + 131 * p) % BENCH_TICKS;
+            tracker_push_spread(ctx->universe->trackers[p], ctx->prices1[t] - ctx->prices2[t]);
+        }
+    }
+}
+
+static double max_relative_error(const double *x, const double *reference, size_t n) {
+    double max_error = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double scale = fabs(reference[i]) > 1.0 ? fabs(reference[i]) : 1.0;
+        double error = fabs(x[i] - reference[i]) / scale;
+        if (error > max_error) max_error = error;
+    }
+    return max_error;
+}
+
+// the blocked GEMMs and masked softmax of the batched pass must match a naive
+// triple-loop forward over the same feature windows
+static void check_attention_batch(BenchContext *ctx) {
+    const AttentionLayer *layer = ctx->batch_layer;
+    AttentionBatch *batch = ctx->batch;
+    kernel_attention_step(ctx);
+
+    int t = batch->sequence_length, f = batch->n_features, d = batch->attention_dim, nq = batch->n_queries;
+    double *q = malloc((size_t)nq * d * sizeof(double));
+    double *k = malloc((size_t)t * d * sizeof(double));
+    double *v = malloc((size_t)t * d * sizeof(double));
+    double *scores = malloc((size_t)nq * t * sizeof(double));
+    double *context = malloc((size_t)nq * d * sizeof(double));
+    if (!q || !k || !v || !scores || !context) {
+        free(q); free(k); free(v); free(scores); free(context);
+        return;
+    }
+
+    double max_error = 0.0;
+    for (int p = 0; p < ctx->universe->n_pairs; p++) {
+        const double *x = batch->inputs + (size_t)p * t * f;
+        for (int s = 0; s < t; s++) {
+            for (int j = 0; j < d; j++) {
+                double kk = 0.0, vv = 0.0;
+                for (int c = 0; c < f; c++) {
+                    kk += x[(size_t)s * f + c] * layer->key_weights[(size_t)j * f + c];
+                    vv += x[(size_t)s * f + c] * layer->value_weights[(size_t)j * f + c];
+                }
+                k[(size_t)s * d + j] = kk;
+                v[(size_t)s * d + j] = vv;
+            }
+        }
+        for (int r = 0; r < nq; r++) {
+            const double *xr = x + (size_t)(t - nq + r) * f;
+            for (int j = 0; j < d; j++) {
+                double qq = 0.0;
+                for (int c = 0; c < f; c++) qq += xr[c] * layer->query_weights[(size_t)j * f + c];
+                q[(size_t)r * d + j] = qq;
+            }
+
+            // causal: query r sits at step t - nq + r
+            int valid = t - nq + r + 1;
+            double *row = scores + (size_t)r * t;
+            double max_score = -INFINITY, sum = 0.0;
+            for (int s = 0; s < valid; s++) {
+                double dot = 0.0;
+                for (int j = 0; j < d; j++) dot += q[(size_t)r * d + j] * k[(size_t)s * d + j];
+                row[s] = dot / sqrt((double)d);
+                if (row[s] > max_score) max_score = row[s];
+            }
+            for (int s = 0; s < valid; s++) sum += (row[s] = exp(row[s] - max_score));
+            for (int s = 0; s < t; s++) row[s] = s < valid ? row[s] / sum : 0.0;
+
+            for (int j = 0; j < d; j++) {
+                double acc = 0.0;
+                for (int s = 0; s < t; s++) acc += row[s] * v[(size_t)s * d + j];
+                context[(size_t)r * d + j] = acc;
+            }
+        }
+
+        double e1 = max_relative_error(batch->scores + (size_t)p * nq * t, scores, (size_t)nq * t);
+        double e2 = max_relative_error(batch->context + (size_t)p * nq * d, context, (size_t)nq * d);
+        if (e1 > max_error) max_error = e1;
+        if (e2 > max_error) max_error = e2;
+    }
+
+    fprintf(stderr, "  attention_batch_forward vs naive GEMM: max error %.2e\n", max_error);
+    if (max_error > 1e-9) {
+        fprintf(stderr, "  MISMATCH at window %d\n", ctx->window);
+        bench_mismatch = true;
+    }
+    free(q); free(k); free(v); free(scores); free(context);
+}
+
+// the streaming z-score must track the reference it replaces
+static void check_attention_stream(BenchContext *ctx) {
+    double max_error = 0.0;
+    ctx->tick = 0;
+    for (int i = 0; i < 4 * ctx->window + 1000; i++) {
+        double *p2;
+        double p1 = next_price(ctx, &p2);
+        attention_stream_push(&ctx->stream, ctx->stream_buffer, p1 - *p2);
+        double reference = calculate_attention_enhanced_zscore(ctx->stream_buffer, ctx->attention);
+        double streamed = attention_stream_zscore(&ctx->stream, ctx->stream_buffer, ctx->attention);
+        double error = fabs(streamed - reference) / (fabs(reference) > 1.0 ? fabs(reference) : 1.0);
+        if (error > max_error) max_error = error;
+    }
+    fprintf(stderr, "  attention_stream_zscore vs reference: max error %.2e\n", max_error);
+    if (max_error > 1e-9) {
+        fprintf(stderr, "  MISMATCH at window %d\n", ctx->window);
+        bench_mismatch = true;
+    }
+}
+
+static void warm_tracker(BenchContext *ctx, BenchKernel kernel) {
+    ctx->tick = 0;
+    for (int i = 0; i < ctx->window + 1; i++) kernel(ctx);
+}
+
+static PairTracker* make_minimal_tracker(int window) {
+    PairTracker *tracker = create_enhanced_pair_tracker(window, false);
+    if (tracker) {
+        tracker->dynamic_entry_threshold = 2.0;
+        tracker->dynamic_exit_threshold = 0.5;
+        tracker->current_hedge_ratio = 1.0;
+        select_signal_variant(tracker);
+    }
+    return tracker;
+}
+
+typedef struct {
+    const char *name;
+    BenchKernel kernel;
+} KernelSpec;
+
+static void bench_window(BenchContext *ctx) {
+    static const KernelSpec buffer_kernels[] = {
+        {"cb_push", kernel_cb_push},
+        {"rolling_mean", kernel_rolling_mean},
+        {"simd_rolling_mean", kernel_simd_rolling_mean},
+        {"simd_cb_rolling_mean", kernel_simd_cb_rolling_mean},
+        {"rolling_std", kernel_rolling_std},
+        {"simd_rolling_std", kernel_simd_rolling_std},
+        {"calculate_correlation", kernel_calculate_correlation},
+        {"simd_cb_correlation", kernel_simd_cb_correlation},
+        {"softmax", kernel_softmax},
+        {"softmax_into", kernel_softmax_into},
+        {"update_correlation_matrix", kernel_update_correlation_matrix},
+        {"engle_granger_test", kernel_engle_granger},
+        {"johansen_test", kernel_johansen},
+        {"calculate_attention_enhanced_zscore", kernel_attention_zscore},
+        {"attention_stream_zscore", kernel_attention_stream_zscore},
+    };
+    int n_buffer_kernels = (int)(sizeof(buffer_kernels) / sizeof(buffer_kernels[0]));
+
+    check_attention_stream(ctx);
+    check_attention_batch(ctx);
+
+    for (int k = 0; k < n_buffer_kernels; k++) {
+        BenchResult r = run_kernel(buffer_kernels[k].kernel, ctx);
+        emit_result(buffer_kernels[k].name, ctx->window, &r);
+    }
+
+    BenchResult r = run_kernel(kernel_update_regime, ctx);
+    emit_result("update_regime", ctx->window, &r);
+
+    r = run_kernel(kernel_attention_step, ctx);
+    emit_result("pair_universe_attention_step/8", ctx->window, &r);
+
+    struct {
+        const char *name;
+        BenchKernel kernel;
+        int mode; // 0: basic, 1: attention, 2: minimal enhanced, 3: full enhanced
+    } signal_kernels[] = {
+        {"generate_pairs_signal", kernel_pairs_signal, 0},
+        {"generate_pairs_signal_with_attention", kernel_pairs_signal_attention, 1},
+        {"generate_enhanced_pairs_signal/minimal", kernel_enhanced_signal, 2},
+        {"generate_enhanced_pairs_signal/full", kernel_enhanced_signal, 3},
+        {"generate_compact_pairs_signal/full", kernel_compact_signal, 3},
+    };
+    int n_signal_kernels = (int)(sizeof(signal_kernels) / sizeof(signal_kernels[0]));
+
+    for (int k = 0; k < n_signal_kernels; k++) {
+        switch (signal_kernels[k].mode) {
+            case 0: ctx->tracker = create_pair_tracker(ctx->window); break;
+            case 1: ctx->tracker = create_pair_tracker_with_attention(ctx->window); break;
+            case 2: ctx->tracker = make_minimal_tracker(ctx->window); break;
+            default: ctx->tracker = create_enhanced_pair_tracker(ctx->window, true); break;
+        }
+        if (!ctx->tracker) continue;
+
+        warm_tracker(ctx, signal_kernels[k].kernel);
+        r = run_kernel(signal_kernels[k].kernel, ctx);
+        emit_result(signal_kernels[k].name, ctx->window, &r);
+
+        destroy_pair_tracker(ctx->tracker);
+        ctx->tracker = NULL;
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_window = BENCH_MAX_WINDOW;
+    if (argc > 1) {
+        max_window = atoi(argv[1]);
+        if (max_window < BENCH_MIN_WINDOW) max_window = BENCH_MIN_WINDOW;
+    }
+
+    double *prices1 = malloc(BENCH_TICKS * sizeof(double));
+    double *prices2 = malloc(BENCH_TICKS * sizeof(double));
+    if (!prices1 || !prices2) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(prices1);
+        free(prices2);
+        return 1;
+    }
+    generate_price_path(prices1, prices2, BENCH_TICKS);
+
+    fprintf(stderr, "Warming up CPU...\n");
+    warm_up_cpu();
+
+    printf("{\n  \"build\": {\"compiler\": \"%s\", \"simd_avx2\": %s, \"batches\": %d},\n",
+#ifdef __VERSION__
+           __VERSION__,
+#else
+           "unknown",
+#endif
+#ifdef __AVX2__
+           "true",
+#else
+           "false",
+#endif
+           BENCH_BATCHES);
+    printf("  \"results\": [\n");
+
+    for (int window = BENCH_MIN_WINDOW; window <= max_window; window *= 2) {
+        BenchContext ctx = {0};
+        ctx.window = window;
+        ctx.prices1 = prices1;
+        ctx.prices2 = prices2;
+        ctx.cb1 = create_circular_buffer(window);
+        ctx.cb2 = create_circular_buffer(window);
+        ctx.contiguous = malloc(window * sizeof(double));
+        ctx.scores = malloc(window * sizeof(double));
+        ctx.series = malloc(BENCH_MATRIX_SERIES * sizeof(CircularBuffer *));
+        ctx.matrix = create_correlation_matrix(BENCH_MATRIX_SERIES);
+        ctx.attention = create_attention_layer(1, 2, window);
+        ctx.stream_buffer = create_circular_buffer(window);
+        ctx.detector = create_regime_detector(window);
+        ctx.universe = create_pair_universe(2 * BENCH_MATRIX_SERIES, BENCH_MATRIX_SERIES);
+        ctx.batch_layer = create_attention_layer(ATTENTION_N_FEATURES, BENCH_BATCH_DIM, window);
+        ctx.batch = create_attention_batch(ctx.batch_layer, BENCH_MATRIX_SERIES, BENCH_BATCH_QUERIES);
+        ctx.batch_zscores = malloc(BENCH_MATRIX_SERIES * sizeof(double));
+
+        bool ok = ctx.cb1 && ctx.cb2 && ctx.contiguous && ctx.scores && ctx.series && ctx.matrix &&
+                  ctx.attention && ctx.stream_buffer && ctx.detector && ctx.universe && ctx.batch_layer &&
+                  ctx.batch && ctx.batch_zscores;
+        for (int p = 0; ok && p < BENCH_MATRIX_SERIES; p++) {
+            PairTracker *tracker = create_pair_tracker(window);
+            if (!tracker || pair_universe_add_pair(ctx.universe, 2 * p, 2 * p + 1, tracker) < 0) {
+                destroy_pair_tracker(tracker);
+                ok = false;
+            }
+        }
+        if (ctx.series) {
+            for (int s = 0; s < BENCH_MATRIX_SERIES; s++) {
+                ctx.series[s] = create_circular_buffer(window);
+                if (!ctx.series[s]) ok = false;
+            }
+        }
+
+        if (ok) {
+            fill_buffers(&ctx);
+            fprintf(stderr, "window %d\n", window);
+            bench_window(&ctx);
+        } else {
+            fprintf(stderr, "Skipping window %d: allocation failed\n", window);
+        }
+
+        destroy_circular_buffer(ctx.cb1);
+        destroy_circular_buffer(ctx.cb2);
+        free(ctx.contiguous);
+        free(ctx.scores);
+        if (ctx.series) {
+            for (int s = 0; s < BENCH_MATRIX_SERIES; s++) destroy_circular_buffer(ctx.series[s]);
+            free(ctx.series);
+        }
+        destroy_correlation_matrix(ctx.matrix);
+        destroy_attention_layer(ctx.attention);
+        destroy_circular_buffer(ctx.stream_buffer);
+        destroy_regime_detector(ctx.detector);
+        destroy_pair_universe(ctx.universe);
+        destroy_attention_layer(ctx.batch_layer);
+        destroy_attention_batch(ctx.batch);
+        free(ctx.batch_zscores);
+    }
+
+    printf("\n  ]\n}\n");
+
+    free(prices1);
+    free(prices2);
+    return bench_mismatch ? 1 : 0;
+}
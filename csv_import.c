@@ -0,0 +1,555 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <pthread.h>
+
+// Streaming CSV tick importer. The file is read in fixed-size chunks; each chunk is
+// cut at line boundaries into one slice per thread and parsed in parallel with a
+// locale-free number parser. Rows are then handed to the sink in file order on the
+// calling thread, so memory stays bounded by the chunk size whatever the file size.
+
+#define CSV_MAX_FIELDS 32
+
+typedef struct {
+    int64_t timestamp_micro;
+    const char *symbol;       // points into the chunk buffer
+    int symbol_len;
+    uint64_t symbol_hash;
+    double bid;
+    double ask;
+    double last;
+    double size;
+} CsvRow;
+
+typedef struct {
+    const CsvImportConfig *config;
+    const char *begin;
+    const char *end;
+    CsvRow *rows;
+    long n_rows;
+    long capacity;
+    long rejected;
+} CsvSlice;
+
+// CSV symbols interned locally, each resolved by the sink once
+typedef struct {
+    SymbolTable *table;
+    int *sink_ids;            // sink id per interned symbol, -1 if the sink skips it
+    int capacity;
+} CsvSymbolMap;
+
+// exact powers of ten; products with mantissas < 2^53 round correctly
+static const double pow10_table[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+CsvImportConfig default_csv_import_config(void) {
+    CsvImportConfig config;
+
+    config.delimiter = ',';
+    config.has_header = true;
+    config.auto_columns = true;  // map columns from the header names
+    config.col_timestamp = 0;
+    config.col_symbol = 1;
+    config.col_bid = 2;
+    config.col_ask = 3;
+    config.col_last = 4;
+    config.col_size = 5;
+    config.n_threads = 4;
+    config.chunk_bytes = 16u << 20;
+
+    return config;
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Parses [+-]digits[.digits][(e|E)[+-]digits]; '.' is always the decimal point.
+bool csv_parse_double(const char *p, const char *end, double *out) {
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+
+    for (; p < end && is_digit(*p); p++, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            exponent++; // beyond 19 significant digits only the scale matters
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && is_digit(*p); p++, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) digits++;
+                exponent--;
+            }
+        }
+    }
+    if (!any) return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_negative = false;
+        if (p < end && (*p == '+' || *p == '-')) exp_negative = (*p++ == '-');
+        if (p >= end || !is_digit(*p)) return false;
+        int e = 0;
+        for (; p < end && is_digit(*p); p++) {
+            if (e < 10000) e = e * 10 + (*p - '0');
+        }
+        exponent += exp_negative ? -e : e;
+    }
+    if (p != end) return false;
+
+    double value;
+    if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        value = exponent < 0 ? (double)mantissa / pow10_table[-exponent]
+                             : (double)mantissa * pow10_table[exponent];
+    } else {
+        value = (double)mantissa * pow(10.0, exponent);
+    }
+
+    *out = negative ? -value : value;
+    return true;
+}
+
+// days since 1970-01-01 for a proleptic Gregorian date
+static int64_t days_from_civil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static bool parse_fixed(const char **p, const char *end, int width, int *out) {
+    int v = 0;
+    for (int i = 0; i < width; i++) {
+        if (*p >= end || !is_digit(**p)) return false;
+        v = v * 10 + (*(*p)++ - '0');
+    }
+    *out = v;
+    return true;
+}
+
+// Accepts integer epochs (s/ms/us/ns, picked by magnitude) or
+// "YYYY-MM-DD[T| ]HH:MM:SS[.fraction][Z]" in UTC.
+bool csv_parse_timestamp(const char *p, const char *end, int64_t *out) {
+    const char *q = p;
+    while (q < end && is_digit(*q)) q++;
+
+    if (q == end && q > p) {
+        int64_t v = 0;
+        for (; p < end; p++) v = v * 10 + (*p - '0');
+        if (v >= 100000000000000000LL) *out = v / 1000;          // nanoseconds
+        else if (v >= 100000000000000LL) *out = v;               // microseconds
+        else if (v >= 100000000000LL) *out = v * 1000;           // milliseconds
+        else *out = v * 1000000;                                 // seconds
+        return true;
+    }
+
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    if (!parse_fixed(&p, end, 4, &year) || p >= end || *p++ != '-' ||
+        !parse_fixed(&p, end, 2, &month) || p >= end || *p++ != '-' ||
+        !parse_fixed(&p, end, 2, &day)) return false;
+
+    int64_t micros = 0;
+    if (p < end && (*p == 'T' || *p == ' ')) {
+        p++;
+        if (!parse_fixed(&p, end, 2, &hour) || p >= end || *p++ != ':' ||
+            !parse_fixed(&p, end, 2, &minute) || p >= end || *p++ != ':' ||
+            !parse_fixed(&p, end, 2, &second)) return false;
+
+        if (p < end && *p == '.') {
+            int scale = 100000;
+            for (p++; p < end && is_digit(*p); p++) {
+                micros += (*p - '0') * scale;
+                scale /= 10;
+            }
+        }
+    }
+    if (p < end && *p == 'Z') p++;
+    if (p != end || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 59) return false;
+
+    int64_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    *out = seconds * 1000000 + micros;
+    return true;
+}
+
+static void trim_field(const char **begin, const char **end) {
+    while (*begin < *end && (**begin == ' ' || **begin == '"')) (*begin)++;
+    while (*end > *begin && ((*end)[-1] == ' ' || (*end)[-1] == '"' || (*end)[-1] == '\r')) (*end)--;
+}
+
+static bool parse_optional_double(const char *const *fields, const char *const *ends, int n_fields,
+                                  int col, double *out) {
+    if (col < 0) {
+        *out = 0.0;
+        return true;
+    }
+    if (col >= n_fields) return false;
+    return csv_parse_double(fields[col], ends[col], out);
+}
+
+static void parse_slice(CsvSlice *slice) {
+    const CsvImportConfig *c = slice->config;
+    const char *p = slice->begin;
+    slice->n_rows = 0;
+    slice->rejected = 0;
+
+    while (p < slice->end) {
+        const char *line_end = memchr(p, '\n', (size_t)(slice->end - p));
+        if (!line_end) line_end = slice->end;
+
+        const char *fields[CSV_MAX_FIELDS], *ends[CSV_MAX_FIELDS];
+        int n_fields = 0;
+        const char *f = p;
+        while (n_fields < CSV_MAX_FIELDS) {
+            const char *d = memchr(f, c->delimiter, (size_t)(line_end - f));
+            const char *field_end = d ? d : line_end;
+            fields[n_fields] = f;
+            ends[n_fields] = field_end;
+            trim_field(&fields[n_fields], &ends[n_fields]);
+            n_fields++;
+            if (!d) break;
+            f = d + 1;
+        }
+
+        bool blank = (n_fields == 1 && fields[0] == ends[0]);
+        if (!blank) {
+            if (slice->n_rows == slice->capacity) {
+                long capacity = slice->capacity ? slice->capacity * 2 : 4096;
+                CsvRow *grown = realloc(slice->rows, capacity * sizeof(CsvRow));
+                if (!grown) {
+                    slice->rejected++;
+                    p = line_end + 1;
+                    continue;
+                }
+                slice->rows = grown;
+                slice->capacity = capacity;
+            }
+
+            CsvRow *row = &slice->rows[slice->n_rows];
+            bool ok = c->col_timestamp >= 0 && c->col_timestamp < n_fields &&
+                      c->col_symbol >= 0 && c->col_symbol < n_fields &&
+                      csv_parse_timestamp(fields[c->col_timestamp], ends[c->col_timestamp], &row->timestamp_micro) &&
+                      parse_optional_double(fields, ends, n_fields, c->col_bid, &row->bid) &&
+                      parse_optional_double(fields, ends, n_fields, c->col_ask, &row->ask) &&
+                      parse_optional_double(fields, ends, n_fields, c->col_last, &row->last) &&
+                      parse_optional_double(fields, ends, n_fields, c->col_size, &row->size);
+
+            if (ok) {
+                row->symbol = fields[c->col_symbol];
+                row->symbol_len = (int)(ends[c->col_symbol] - fields[c->col_symbol]);
+                // a longer symbol would be truncated into another symbol's name
+                ok = row->symbol_len > 0 && row->symbol_len < TICK_SYMBOL_LEN;
+                row->symbol_hash = symbol_hash(row->symbol, row->symbol_len);
+
+                // quote-only feeds: use the mid as the last price
+                if (c->col_last < 0) row->last = 0.5 * (row->bid + row->ask);
+                if (c->col_bid < 0) row->bid = row->last;
+                if (c->col_ask < 0) row->ask = row->last;
+            }
+
+            if (ok) slice->n_rows++;
+            else slice->rejected++;
+        }
+
+        p = line_end + 1;
+    }
+}
+
+static void* parse_slice_thread(void *arg) {
+    parse_slice(arg);
+    return NULL;
+}
+
+static bool header_matches(const char *begin, const char *end, const char *const *names) {
+    size_t len = (size_t)(end - begin);
+    for (int i = 0; names[i]; i++) {
+        if (strlen(names[i]) != len) continue;
+        bool same = true;
+        for (size_t k = 0; k < len && same; k++) {
+            char a = begin[k];
+            if (a >= 'A' && a <= 'Z') a = (char)(a - 'A' + 'a');
+            same = (a == names[i][k]);
+        }
+        if (same) return true;
+    }
+    return false;
+}
+
+// maps columns by header name; columns not found keep their configured index
+static void apply_header(CsvImportConfig *c, const char *line, const char *line_end) {
+    static const char *const ts_names[] = {"timestamp", "time", "ts", "datetime", NULL};
+    static const char *const sym_names[] = {"symbol", "ticker", "sym", NULL};
+    static const char *const bid_names[] = {"bid", "bid_price", NULL};
+    static const char *const ask_names[] = {"ask", "ask_price", "offer", NULL};
+    static const char *const last_names[] = {"last", "price", "trade", "last_price", NULL};
+    static const char *const size_names[] = {"size", "volume", "qty", "quantity", NULL};
+
+    bool seen_bid = false, seen_ask = false, seen_last = false, seen_size = false;
+    int col = 0;
+    const char *f = line;
+    for (;;) {
+        const char *d = memchr(f, c->delimiter, (size_t)(line_end - f));
+        const char *b = f, *e = d ? d : line_end;
+        trim_field(&b, &e);
+
+        if (header_matches(b, e, ts_names)) c->col_timestamp = col;
+        else if (header_matches(b, e, sym_names)) c->col_symbol = col;
+        else if (header_matches(b, e, bid_names)) { c->col_bid = col; seen_bid = true; }
+        else if (header_matches(b, e, ask_names)) { c->col_ask = col; seen_ask = true; }
+        else if (header_matches(b, e, last_names)) { c->col_last = col; seen_last = true; }
+        else if (header_matches(b, e, size_names)) { c->col_size = col; seen_size = true; }
+
+        if (!d) break;
+        f = d + 1;
+        col++;
+    }
+
+    if (!seen_bid) c->col_bid = -1;
+    if (!seen_ask) c->col_ask = -1;
+    if (!seen_last) c->col_last = -1;
+    if (!seen_size) c->col_size = -1;
+}
+
+static int resolve_symbol(CsvSymbolMap *map, const CsvRow *row, const CsvTickSink *sink) {
+    int local = symbol_table_find_n(map->table, row->symbol, row->symbol_len, row->symbol_hash);
+    if (local >= 0) return map->sink_ids[local];
+
+    local = symbol_table_intern_n(map->table, row->symbol, row->symbol_len, row->symbol_hash);
+    if (local < 0) return -1;
+    if (local >= map->capacity) {
+        int capacity = map->capacity * 2;
+        int *grown = realloc(map->sink_ids, capacity * sizeof(int));
+        if (!grown) return -1;
+        map->sink_ids = grown;
+        map->capacity = capacity;
+    }
+
+    map->sink_ids[local] = sink->resolve_symbol(sink->ctx, symbol_table_name(map->table, local));
+    return map->sink_ids[local];
+}
+
+bool csv_import(const char *csv_path, const CsvImportConfig *config, const CsvTickSink *sink, CsvImportStats *stats) {
+    if (!csv_path || !config || !sink || !sink->resolve_symbol || !sink->on_tick) return false;
+
+    CsvImportConfig c = *config;
+    if (c.n_threads < 1) c.n_threads = 1;
+    if (c.chunk_bytes < 4096) c.chunk_bytes = 4096;
+
+    FILE *fp = fopen(csv_path, "rb");
+    if (!fp) return false;
+
+    CsvImportStats local = {0};
+    uint64_t start_ns = latency_now_ns();
+
+    // one spare byte so the final line always ends inside the buffer
+    char *buffer = malloc(c.chunk_bytes + 1);
+    CsvSlice *slices = calloc(c.n_threads, sizeof(CsvSlice));
+    pthread_t *threads = malloc(c.n_threads * sizeof(pthread_t));
+    CsvSymbolMap symbols;
+    symbols.capacity = 256;
+    symbols.table = create_symbol_table(symbols.capacity);
+    symbols.sink_ids = malloc(symbols.capacity * sizeof(int));
+    bool ok = buffer && slices && threads && symbols.table && symbols.sink_ids;
+    bool header_pending = c.has_header;
+    size_t carry = 0;
+    int distinct_symbols = 0;
+
+    while (ok) {
+        size_t got = fread(buffer + carry, 1, c.chunk_bytes - carry, fp);
+        size_t filled = carry + got;
+        bool at_eof = got < c.chunk_bytes - carry;
+        local.bytes += got;
+        if (filled == 0) break;
+
+        // parse up to the last complete line; the tail moves to the next chunk
+        size_t usable = filled;
+        if (!at_eof) {
+            const char *nl = NULL;
+            for (size_t i = filled; i > 0; i--) {
+                if (buffer[i - 1] == '\n') { nl = buffer + i; break; }
+            }
+            if (!nl) { ok = false; break; } // a single line longer than the chunk
+            usable = (size_t)(nl - buffer);
+        }
+
+        const char *begin = buffer;
+        const char *end = buffer + usable;
+        if (header_pending) {
+            const char *nl = memchr(begin, '\n', usable);
+            const char *line_end = nl ? nl : end;
+            if (c.auto_columns) apply_header(&c, begin, line_end);
+            begin = nl ? nl + 1 : end;
+            header_pending = false;
+        }
+
+        // cut into per-thread slices on line boundaries
+        size_t span = (size_t)(end - begin);
+        const char *cut = begin;
+        int n_slices = 0;
+        for (int t = 0; t < c.n_threads && cut < end; t++) {
+            const char *slice_end = (t == c.n_threads - 1) ? end : cut + span / c.n_threads;
+            if (slice_end >= end) {
+                slice_end = end;
+            } else {
+                const char *nl = memchr(slice_end, '\n', (size_t)(end - slice_end));
+                slice_end = nl ? nl + 1 : end;
+            }
+            slices[t].config = &c;
+            slices[t].begin = cut;
+            slices[t].end = slice_end;
+            cut = slice_end;
+            n_slices++;
+        }
+
+        // slices whose thread fails to start are parsed on the calling thread
+        int n_started = 1;
+        while (n_started < n_slices &&
+               pthread_create(&threads[n_started], NULL, parse_slice_thread, &slices[n_started]) == 0) {
+            n_started++;
+        }
+        if (n_slices > 0) parse_slice(&slices[0]);
+        for (int t = n_started; t < n_slices; t++) {
+            parse_slice(&slices[t]);
+        }
+        for (int t = 1; t < n_started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+
+        // deliver in file order
+        for (int t = 0; t < n_slices && ok; t++) {
+            local.rejected_rows += (uint64_t)slices[t].rejected;
+            for (long r = 0; r < slices[t].n_rows; r++) {
+                const CsvRow *row = &slices[t].rows[r];
+                int id = resolve_symbol(&symbols, row, sink);
+                if (id < 0) {
+                    local.skipped_rows++;
+                    continue;
+                }
+
+                TickRecord tick;
+                tick.timestamp_micro = row->timestamp_micro;
+                tick.symbol = id;
+                tick.bid = row->bid;
+                tick.ask = row->ask;
+                tick.last = row->last;
+                tick.size = row->size;
+
+                if (sink->on_tick(sink->ctx, &tick)) local.rows++;
+                else local.rejected_rows++;
+            }
+        }
+
+        carry = filled - usable;
+        memmove(buffer, buffer + usable, carry);
+        if (at_eof) {
+            if (carry > 0) {
+                buffer[carry] = '\n'; // unterminated last line
+                carry++;
+                continue;
+            }
+            break;
+        }
+    }
+
+    for (int i = 0; symbols.table && i < symbols.table->n_symbols; i++) {
+        if (symbols.sink_ids[i] >= 0) distinct_symbols++;
+    }
+    local.symbols = distinct_symbols;
+    local.seconds = (double)(latency_now_ns() - start_ns) / 1e9;
+    local.rows_per_sec = local.seconds > 0 ? local.rows / local.seconds : 0.0;
+    if (stats) *stats = local;
+
+    if (ferror(fp)) ok = false;
+    fclose(fp);
+    if (slices) {
+        for (int t = 0; t < c.n_threads; t++) free(slices[t].rows);
+    }
+    free(slices);
+    free(threads);
+    free(buffer);
+    destroy_symbol_table(symbols.table);
+    free(symbols.sink_ids);
+
+    return ok;
+}
+
+// ---- sinks -----------------------------------------------------------------
+
+static int tick_file_resolve(void *ctx, const char *symbol) {
+    return tick_writer_add_symbol(ctx, symbol);
+}
+
+static bool tick_file_on_tick(void *ctx, const TickRecord *tick) {
+    return tick_writer_append(ctx, tick);
+}
+
+bool csv_import_to_tick_file(const char *csv_path, const char *tick_path, const CsvImportConfig *config,
+                             CsvImportStats *stats) {
+    TickFileWriter *writer = tick_writer_create(tick_path, 0);
+    if (!writer) return false;
+
+    CsvTickSink sink = {tick_file_resolve, tick_file_on_tick, writer};
+    bool ok = csv_import(csv_path, config, &sink, stats);
+
+    if (!ok) {
+        tick_writer_abort(writer);
+        return false;
+    }
+    return tick_writer_close(writer);
+}
+
+typedef struct {
+    PairUniverse *universe;
+    SymbolTable *names;       // the universe's symbol names
+    int *universe_ids;        // universe symbol id per interned name
+} UniverseSinkContext;
+
+static int universe_resolve(void *ctx, const char *symbol) {
+    UniverseSinkContext *u = ctx;
+    int id = symbol_table_find(u->names, symbol);
+    return id >= 0 ? u->universe_ids[id] : -1; // -1: symbol not traded by any pair
+}
+
+static bool universe_on_tick(void *ctx, const TickRecord *tick) {
+    UniverseSinkContext *u = ctx;
+    pair_universe_on_quote(u->universe, tick, NULL, 0);
+    return true;
+}
+
+bool csv_import_to_universe(const char *csv_path, PairUniverse *universe, const char *const *symbol_names,
+                            const CsvImportConfig *config, CsvImportStats *stats) {
+    if (!universe || !symbol_names) return false;
+
+    UniverseSinkContext ctx;
+    ctx.universe = universe;
+    ctx.names = create_symbol_table(universe->n_symbols);
+    ctx.universe_ids = malloc(universe->n_symbols * sizeof(int));
+    bool ok = ctx.names && ctx.universe_ids;
+
+    // first listing wins if a name repeats, as the old linear lookup did
+    for (int i = 0; ok && i < universe->n_symbols; i++) {
+        if (!symbol_names[i] || symbol_table_find(ctx.names, symbol_names[i]) >= 0) continue;
+        int id = symbol_table_intern(ctx.names, symbol_names[i]);
+        if (id >= 0) ctx.universe_ids[id] = i;
+    }
+
+    if (ok) {
+        CsvTickSink sink = {universe_resolve, universe_on_tick, &ctx};
+        ok = csv_import(csv_path, config, &sink, stats);
+    }
+
+    destroy_symbol_table(ctx.names);
+    free(ctx.universe_ids);
+    return ok;
+}
@@ -22,111 +22,6 @@ void generate_sample_data(double *prices1, double *prices2, int n, double correl
     }
 }
 
-PairTracker* create_pair_tracker(int window_size) {
-    PairTracker *tracker = malloc(sizeof(PairTracker));
-    if (!tracker) return NULL;
-    
-    tracker->price_buffer1 = create_circular_buffer(window_size);
-    tracker->price_buffer2 = create_circular_buffer(window_size);
-    tracker->spread_buffer = create_circular_buffer(window_size);
-    tracker->window_size = window_size;
-    tracker->mean_spread = 0.0;
-    tracker->std_spread = 0.0;
-    tracker->correlation = 0.0;
-    tracker->attention_enhanced_zscore = 0.0;
-    tracker->use_attention = false;
-    tracker->temporal_attention = NULL;
-    tracker->attention_cache = NULL;
-    
-    if (!tracker->price_buffer1 || !tracker->price_buffer2 || !tracker->spread_buffer) {
-        destroy_circular_buffer(tracker->price_buffer1);
-        destroy_circular_buffer(tracker->price_buffer2);
-        destroy_circular_buffer(tracker->spread_buffer);
-        free(tracker);
-        return NULL;
-    }
-    
-    return tracker;
-}
-
-PairTracker* create_pair_tracker_with_attention(int window_size) {
-    PairTracker *tracker = create_pair_tracker(window_size);
-    if (!tracker) return NULL;
-    
-    // Initialize attention mechanism
-    tracker->temporal_attention = create_attention_layer(1, 2, window_size); // 1D input, 2D attention
-    tracker->attention_cache = create_attention_output(window_size, 2);
-    tracker->use_attention = true;
-    
-    if (!tracker->temporal_attention || !tracker->attention_cache) {
-        destroy_attention_layer(tracker->temporal_attention);
-        destroy_attention_output(tracker->attention_cache);
-        destroy_pair_tracker(tracker);
-        return NULL;
-    }
-    
-    return tracker;
-}
-
-PairTracker* create_enhanced_pair_tracker(int window_size, bool use_all_features) {
-    PairTracker *tracker = create_pair_tracker(window_size);
-    if (!tracker) return NULL;
-    
-    // init additional buffers
-    tracker->hedge_ratio_buffer = create_circular_buffer(window_size);
-    tracker->volatility1_buffer = create_circular_buffer(window_size);
-    tracker->volatility2_buffer = create_circular_buffer(window_size);
-    
-    if (!tracker->hedge_ratio_buffer || !tracker->volatility1_buffer || !tracker->volatility2_buffer) {
-        destroy_pair_tracker(tracker);
-        return NULL;
-    }
-    
-    if (use_all_features) {
-        // enable attention
-        tracker->temporal_attention = create_attention_layer(1, 2, window_size);
-        tracker->attention_cache = create_attention_output(window_size, 2);
-        tracker->use_attention = true;
-        
-        // enable regime detection
-        tracker->regime_detector = create_regime_detector(window_size / 2);
-        tracker->use_regime_detection = true;
-        
-        // enable risk management with volatility targeting
-        tracker->risk_manager = create_risk_manager(window_size, 0.15); // 15% target vol
-        
-        // enable dynamic hedging
-        tracker->use_dynamic_hedging = true;
-        
-        // enable transaction costs
-        tracker->use_transaction_costs = true;
-        tracker->transaction_costs = create_transaction_costs(0.001, 0.001, 0.0005, 0.0005);
-        
-        // init dynamic thresholds
-        tracker->dynamic_entry_threshold = 2.0;
-        tracker->dynamic_exit_threshold = 0.5;
-        tracker->current_hedge_ratio = 1.0;
-    }
-    
-    return tracker;
-}
-
-void destroy_pair_tracker(PairTracker *tracker) {
-    if (tracker) {
-        destroy_circular_buffer(tracker->price_buffer1);
-        destroy_circular_buffer(tracker->price_buffer2);
-        destroy_circular_buffer(tracker->spread_buffer);
-        destroy_circular_buffer(tracker->hedge_ratio_buffer);
-        destroy_circular_buffer(tracker->volatility1_buffer);
-        destroy_circular_buffer(tracker->volatility2_buffer);
-        destroy_attention_layer(tracker->temporal_attention);
-        destroy_attention_output(tracker->attention_cache);
-        destroy_regime_detector(tracker->regime_detector);
-        destroy_risk_manager(tracker->risk_manager);
-        free(tracker);
-    }
-}
-
 int main(void) {
     printf("=== Sakura Signals: Statistical Arbitrage ===\n\n");
     
@@ -164,6 +59,10 @@ int main(void) {
         return 1;
     }
     
+#ifdef SAKURA_PROFILE
+    pair_tracker_enable_latency_profile(enhanced_tracker);
+#endif
+    
     printf("Analyzing %d price points with rolling window of %d...\n", n_points, window_size);
     printf("Target correlation: %.3f\n\n", correlation);
     
@@ -242,6 +141,13 @@ int main(void) {
                enhanced_tracker->risk_manager->portfolio_heat);
     }
     
+#ifdef SAKURA_PROFILE
+    printf("\n=== Stage Latency (enhanced tracker) ===\n");
+    LatencySnapshot latency;
+    latency_snapshot_profile(enhanced_tracker->latency_profile, &latency, true);
+    print_latency_snapshot(&latency);
+#endif
+    
     // Demo correlation matrix with multiple assets
     printf("\n=== Correlation Matrix Demo ===\n");
     const int n_assets = 3;
@@ -63,6 +63,39 @@ double calculate_dynamic_hedge_ratio(CircularBuffer *price1, CircularBuffer *pri
     return hedge_ratio;
 }
 
+// calculate_dynamic_hedge_ratio from the return ring: the lookback prices give
+// lookback - 1 returns, whose covariance and variance are O(1) suffix queries
+double prefix_dynamic_hedge_ratio(const PrefixBuffer *returns, int lookback) {
+    if (!returns || lookback < 5 || pb_size(returns) < lookback - 1) return 1.0;
+    
+    PrefixWindow w = pb_window(returns, lookback - 1);
+    
+    double hedge_ratio = 1.0;
+    if (w.var_y * (w.n - 1) > 1e-8) {
+        hedge_ratio = w.cov_xy / w.var_y;
+    }
+    
+    // clamp ratio to reasonable bounds
+    if (hedge_ratio < 0.1) hedge_ratio = 0.1;
+    if (hedge_ratio > 5.0) hedge_ratio = 5.0;
+    
+    return hedge_ratio;
+}
+
+// half-life of an AR(1) with slope beta, clamped to [1, 100]; 20 unless 0 < beta < 1
+static double ar1_half_life(double beta) {
+    double half_life = 20.0; // default
+    if (beta > 0 && beta < 1) {
+        half_life = -log(2.0) / log(beta);
+        
+        // clamp to reasonable range
+        if (half_life < 1.0) half_life = 1.0;
+        if (half_life > 100.0) half_life = 100.0;
+    }
+    
+    return half_life;
+}
+
 double calculate_half_life(CircularBuffer *spread_buffer) {
     int size = cb_size(spread_buffer);
     if (size < 10) return 20.0; // default half-life
@@ -85,23 +118,122 @@ double calculate_half_life(CircularBuffer *spread_buffer) {
     double beta = (n * sum_xy - sum_x * sum_y) / (n * sum_x2 - sum_x * sum_x);
     
     // half-life = -log(2) / log(beta)
-    double half_life = 20.0; // default
-    if (beta > 0 && beta < 1) {
-        half_life = -log(2.0) / log(beta);
+    return ar1_half_life(beta);
+}
+
+// Streaming form of calculate_half_life. Sliding the window by one value drops the
+// oldest (spread[0], spread[1]) pair and adds (newest, value); beta is a ratio of
+// the four sums, so it is shift-invariant and the sums are taken around the
+// window mean at the last rebuild to limit cancellation. An exact rebuild every
+// `capacity` pushes bounds rounding drift at O(1) amortized cost.
+
+#define HALF_LIFE_STREAM_MIN_REBUILD 64
+
+void half_life_stream_rebuild(HalfLifeStream *stream, CircularBuffer *buffer) {
+    stream->center = 0.0;
+    stream->sum_x = stream->sum_y = stream->sum_xy = stream->sum_x2 = 0.0;
+    stream->count = 0;
+    stream->pushes = 0;
+    
+    int n = cb_size(buffer);
+    if (n == 0) return;
+    
+    for (int i = 0; i < n; i++) stream->center += cb_get(buffer, i);
+    stream->center /= n;
+    
+    double x = cb_get(buffer, 0) - stream->center;
+    for (int i = 1; i < n; i++) {
+        double y = cb_get(buffer, i) - stream->center;
+        stream->sum_x += x;
+        stream->sum_y += y;
+        stream->sum_xy += x * y;
+        stream->sum_x2 += x * x;
+        x = y;
+    }
+    stream->count = n;
+}
+
+// accounts for `value` about to be pushed onto `buffer`; the caller pushes it
+void half_life_stream_advance(HalfLifeStream *stream, CircularBuffer *buffer, double value) {
+    int n = cb_size(buffer);
+    int rebuild_every = buffer->capacity > HALF_LIFE_STREAM_MIN_REBUILD ? buffer->capacity : HALF_LIFE_STREAM_MIN_REBUILD;
+    if (stream->count != n || stream->pushes >= rebuild_every) half_life_stream_rebuild(stream, buffer);
+    if (n == 0) stream->center = value;
+    
+    double c = stream->center;
+    if (n == buffer->capacity && n > 0) {
+        if (n > 1) {
+            double x0 = cb_get(buffer, 0) - c;
+            double y0 = cb_get(buffer, 1) - c;
+            stream->sum_x -= x0;
+            stream->sum_y -= y0;
+            stream->sum_xy -= x0 * y0;
+            stream->sum_x2 -= x0 * x0;
+        }
+        stream->count--;
+    }
+    
+    if (stream->count > 0) {
+        double prev = cb_get(buffer, n - 1);
+        double x = prev - c;
+        double y = value - c;
+        stream->sum_x += x;
+        stream->sum_y += y;
+        stream->sum_xy += x * y;
+        stream->sum_x2 += x * x;
         
-        // clamp to reasonable range
-        if (half_life < 1.0) half_life = 1.0;
-        if (half_life > 100.0) half_life = 100.0;
+        if (stream->ew_alpha > 0) {
+            double a = stream->ew_alpha;
+            if (stream->ew_pairs == 0) {
+                stream->ew_mean_x = prev;
+                stream->ew_mean_y = value;
+            }
+            double dx = prev - stream->ew_mean_x;
+            double dy = value - stream->ew_mean_y;
+            stream->ew_mean_x += a * dx;
+            stream->ew_mean_y += a * dy;
+            stream->ew_cov_xy = (1.0 - a) * (stream->ew_cov_xy + a * dx * dy);
+            stream->ew_var_x = (1.0 - a) * (stream->ew_var_x + a * dx * dx);
+            stream->ew_pairs++;
+        }
+    }
+    stream->count++;
+    stream->pushes++;
+}
+
+double half_life_stream_half_life(HalfLifeStream *stream, CircularBuffer *buffer) {
+    if (stream->ew_alpha > 0) {
+        if (stream->ew_pairs < 9) return 20.0; // as few pairs as the windowed fit needs
+        return ar1_half_life(stream->ew_cov_xy / stream->ew_var_x);
     }
     
-    return half_life;
+    int size = cb_size(buffer);
+    if (size < 10) return 20.0;
+    if (stream->count != size) half_life_stream_rebuild(stream, buffer);
+    
+    int n = size - 1;
+    double beta = (n * stream->sum_xy - stream->sum_x * stream->sum_y) /
+                  (n * stream->sum_x2 - stream->sum_x * stream->sum_x);
+    return ar1_half_life(beta);
+}
+
+// span 0 fits over the window; changing the span restarts the EW moments
+void half_life_stream_set_span(HalfLifeStream *stream, int span) {
+    double alpha = span > 0 ? 2.0 / (span + 1) : 0.0;
+    if (alpha == stream->ew_alpha) return;
+    
+    stream->ew_alpha = alpha;
+    stream->ew_mean_x = stream->ew_mean_y = 0.0;
+    stream->ew_cov_xy = stream->ew_var_x = 0.0;
+    stream->ew_pairs = 0;
 }
 
 void update_dynamic_thresholds(PairTracker *tracker, double volatility_factor) {
     if (!tracker) return;
     
-    double base_entry = 2.0;
-    double base_exit = 0.5;
+    const SignalParams *p = &tracker->params;
+    double base_entry = p->entry_threshold;
+    double base_exit = p->exit_threshold;
     
     // adjust thresholds based on regime
     if (tracker->regime_detector) {
@@ -111,12 +243,12 @@ void update_dynamic_thresholds(PairTracker *tracker, double volatility_factor) {
                 tracker->dynamic_exit_threshold = base_exit * volatility_factor;
                 break;
             case 1: // stress regime
-                tracker->dynamic_entry_threshold = base_entry * 1.5 * volatility_factor;
-                tracker->dynamic_exit_threshold = base_exit * 1.2 * volatility_factor;
+                tracker->dynamic_entry_threshold = base_entry * p->stress_entry_multiplier * volatility_factor;
+                tracker->dynamic_exit_threshold = base_exit * p->stress_exit_multiplier * volatility_factor;
                 break;
             case 2: // crisis regime
-                tracker->dynamic_entry_threshold = base_entry * 2.5 * volatility_factor;
-                tracker->dynamic_exit_threshold = base_exit * 2.0 * volatility_factor;
+                tracker->dynamic_entry_threshold = base_entry * p->crisis_entry_multiplier * volatility_factor;
+                tracker->dynamic_exit_threshold = base_exit * p->crisis_exit_multiplier * volatility_factor;
                 break;
         }
     } else {
@@ -126,7 +258,7 @@ void update_dynamic_thresholds(PairTracker *tracker, double volatility_factor) {
     
     // adjust based on half-life (faster mean reversion = tighter thresholds)
     if (cb_size(tracker->spread_buffer) > 10) {
-        double half_life = calculate_half_life(tracker->spread_buffer);
+        double half_life = half_life_stream_half_life(&tracker->half_life_stream, tracker->spread_buffer);
         double hl_factor = 20.0 / half_life; // normalize around 20 periods
         
         tracker->dynamic_entry_threshold *= hl_factor;
@@ -136,4 +268,89 @@ void update_dynamic_thresholds(PairTracker *tracker, double volatility_factor) {
     // ensure minimum thresholds
     if (tracker->dynamic_entry_threshold < 0.5) tracker->dynamic_entry_threshold = 0.5;
     if (tracker->dynamic_exit_threshold < 0.1) tracker->dynamic_exit_threshold = 0.1;
-}
\ No newline at end of file
+}
+
+// Kalman hedge: observation price1 = beta * price2 + alpha + e, e ~ N(0, R), and
+// (beta, alpha) drifting as a random walk with covariance delta / (1 - delta) * I.
+// R is not known up front, so it is tracked as an EW average of the part of each
+// squared innovation the state covariance does not explain.
+void kalman_hedge_init(KalmanHedge *filter, double process_noise, int noise_span) {
+    if (!filter) return;
+    
+    memset(filter, 0, sizeof(*filter));
+    filter->beta = 1.0;
+    filter->process_noise = process_noise;
+    filter->noise_alpha = 2.0 / ((noise_span > 1 ? noise_span : 1) + 1);
+}
+
+void kalman_hedge_update(KalmanHedge *filter, double price1, double price2) {
+    if (!filter || !(price1 > 0) || !(price2 > 0)) return;
+    
+    if (filter->n_updates == 0) {
+        // start from a 1:1 hedge through the first quote, beta known to about
+        // +-1 and alpha to about a price level
+        filter->beta = 1.0;
+        filter->alpha = price1 - price2;
+        filter->P[0][0] = 1.0;
+        filter->P[0][1] = filter->P[1][0] = 0.0;
+        filter->P[1][1] = price1 * price1;
+        filter->observation_var = 1e-6 * price1 * price1;
+        filter->innovation = 0.0;
+        filter->innovation_var = filter->observation_var;
+        filter->n_updates = 1;
+        return;
+    }
+    
+    double delta = filter->process_noise;
+    double q = delta > 0 && delta < 1 ? delta / (1.0 - delta) : 0.0;
+    
+    // predict
+    double p00 = filter->P[0][0] + q;
+    double p01 = filter->P[0][1];
+    double p11 = filter->P[1][1] + q;
+    
+    // P x and x' P x for x = (price2, 1)
+    double px0 = p00 * price2 + p01;
+    double px1 = p01 * price2 + p11;
+    double state_var = px0 * price2 + px1;
+    
+    double e = price1 - (filter->beta * price2 + filter->alpha);
+    double s = state_var + filter->observation_var;
+    if (!(s > 0)) return;
+    
+    // update
+    double k0 = px0 / s;
+    double k1 = px1 / s;
+    filter->beta += k0 * e;
+    filter->alpha += k1 * e;
+    filter->P[0][0] = p00 - k0 * px0;
+    filter->P[0][1] = filter->P[1][0] = p01 - k0 * px1;
+    filter->P[1][1] = p11 - k1 * px1;
+    
+    double excess = e * e - state_var;
+    double floor = 1e-12 * price1 * price1;
+    filter->observation_var += filter->noise_alpha * ((excess > 0 ? excess : 0.0) - filter->observation_var);
+    if (filter->observation_var < floor) filter->observation_var = floor;
+    
+    filter->innovation = e;
+    filter->innovation_var = s;
+    filter->n_updates++;
+    
+    // a non-finite state can only come from non-finite input: start over
+    if (!isfinite(filter->beta) || !isfinite(filter->alpha) || !isfinite(filter->P[0][0])) {
+        filter->n_updates = 0;
+    }
+}
+
+// Sizing multiplier for hedge uncertainty: of the spread variance, the share that
+// is not beta estimation error (var(beta) * price2^2), so a poorly pinned-down
+// hedge ratio trades smaller
+double kalman_hedge_size_factor(const KalmanHedge *filter, double price2, double spread_std, double weight) {
+    if (!filter || filter->n_updates == 0) return 1.0;
+    
+    double hedge_var = weight * filter->P[0][0] * price2 * price2;
+    double spread_var = spread_std * spread_std;
+    if (!(hedge_var > 0) || !(spread_var > 0)) return 1.0;
+    
+    return spread_var / (spread_var + hedge_var);
+}
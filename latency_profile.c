@@ -0,0 +1,289 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <pthread.h>
+#include <time.h>
+
+// Log-linear (HDR-style) buckets: values below 2^LATENCY_SUB_BUCKET_BITS get their
+// own bucket, above that every power of two is split into half as many sub-buckets.
+// Relative error stays below 1/16 across the range.
+#define LATENCY_HALF_SUB_BUCKETS (1 << (LATENCY_SUB_BUCKET_BITS - 1))
+#define LATENCY_MAX_THREADS 64
+
+// Live per-thread profiles. A thread claims a slot the first time it records and
+// gives it back when it exits: its counts are folded into retired_profile and the
+// slot is reused, so thread pools that come and go never exhaust the registry.
+// Only the owning thread writes a profile; the lock guards claiming, retiring and
+// readers walking the slots.
+static LatencyProfile *thread_profiles[LATENCY_MAX_THREADS];
+static LatencyProfile retired_profile;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t registry_key;
+static pthread_once_t registry_key_once = PTHREAD_ONCE_INIT;
+static __thread LatencyProfile *current_thread_profile = NULL;
+static __thread bool current_thread_claimed = false;
+
+static const char *stage_names[LATENCY_STAGE_COUNT] = {
+    "push", "hedge", "stats", "regime", "thresholds",
+    "attention", "sizing", "costs", "cointegration", "total"
+};
+
+uint64_t latency_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+const char* latency_stage_name(LatencyStage stage) {
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) return "unknown";
+    return stage_names[stage];
+}
+
+static int bucket_index(uint64_t value) {
+    if (value < (1ULL << LATENCY_SUB_BUCKET_BITS)) return (int)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (LATENCY_SUB_BUCKET_BITS - 1);
+    int index = shift * LATENCY_HALF_SUB_BUCKETS + (int)(value >> shift);
+
+    return index < LATENCY_BUCKET_COUNT ? index : LATENCY_BUCKET_COUNT - 1; // saturate
+}
+
+// highest value that maps into the bucket (HDR "highest equivalent value")
+static uint64_t bucket_upper_value(int index) {
+    if (index < (1 << LATENCY_SUB_BUCKET_BITS)) return (uint64_t)index;
+
+    int shift = index / LATENCY_HALF_SUB_BUCKETS - 1;
+    uint64_t mantissa = (uint64_t)(index - shift * LATENCY_HALF_SUB_BUCKETS);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void latency_histogram_reset(LatencyHistogram *hist) {
+    if (hist) memset(hist, 0, sizeof(LatencyHistogram));
+}
+
+void latency_histogram_record(LatencyHistogram *hist, uint64_t value_ns) {
+    if (!hist) return;
+
+    // single writer per histogram: relaxed load + store is enough for concurrent
+    // readers and avoids locked read-modify-write instructions
+    uint64_t *bucket = &hist->counts[bucket_index(value_ns)];
+    __atomic_store_n(bucket, __atomic_load_n(bucket, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->total_count, __atomic_load_n(&hist->total_count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->sum_ns, __atomic_load_n(&hist->sum_ns, __ATOMIC_RELAXED) + value_ns, __ATOMIC_RELAXED);
+    if (value_ns > __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&hist->max_ns, value_ns, __ATOMIC_RELAXED);
+    }
+}
+
+// dst += src, reading src with relaxed loads so it may be live
+void latency_histogram_merge(LatencyHistogram *dst, const LatencyHistogram *src) {
+    if (!dst || !src) return;
+
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        dst->counts[i] += __atomic_load_n(&src->counts[i], __ATOMIC_RELAXED);
+    }
+    dst->total_count += __atomic_load_n(&src->total_count, __ATOMIC_RELAXED);
+    dst->sum_ns += __atomic_load_n(&src->sum_ns, __ATOMIC_RELAXED);
+
+    uint64_t src_max = __atomic_load_n(&src->max_ns, __ATOMIC_RELAXED);
+    if (src_max > dst->max_ns) dst->max_ns = src_max;
+}
+
+uint64_t latency_histogram_percentile(const LatencyHistogram *hist, double percentile) {
+    if (!hist || hist->total_count == 0) return 0;
+
+    uint64_t total = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        total += hist->counts[i];
+    }
+    if (total == 0) return 0;
+
+    // rank of the requested sample (1-based, rounded up)
+    double target = percentile / 100.0 * (double)total;
+    uint64_t rank = (uint64_t)ceil(target);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            uint64_t value = bucket_upper_value(i);
+            return (hist->max_ns > 0 && value > hist->max_ns) ? hist->max_ns : value;
+        }
+    }
+
+    return hist->max_ns;
+}
+
+LatencyStats latency_histogram_stats(const LatencyHistogram *hist) {
+    LatencyStats stats = {0};
+    if (!hist || hist->total_count == 0) return stats;
+
+    stats.count = hist->total_count;
+    stats.mean_ns = (double)hist->sum_ns / (double)hist->total_count;
+    stats.p50_ns = latency_histogram_percentile(hist, 50.0);
+    stats.p99_ns = latency_histogram_percentile(hist, 99.0);
+    stats.p999_ns = latency_histogram_percentile(hist, 99.9);
+    stats.max_ns = latency_histogram_percentile(hist, 100.0);
+
+    return stats;
+}
+
+LatencyProfile* create_latency_profile(void) {
+    return calloc(1, sizeof(LatencyProfile));
+}
+
+void destroy_latency_profile(LatencyProfile *profile) {
+    free(profile);
+}
+
+// Writers only ever add; a reset moves the reader's baseline forward instead of
+// clearing live counters, so snapshot/reset never races with the recording thread.
+static void snapshot_into(LatencyProfile *profile, LatencyHistogram *accum, bool reset) {
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        LatencyHistogram current = {0};
+        latency_histogram_merge(&current, &profile->stages[s]);
+
+        const LatencyHistogram *base = &profile->baseline[s];
+        for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+            accum[s].counts[i] += current.counts[i] - base->counts[i];
+        }
+        accum[s].total_count += current.total_count - base->total_count;
+        accum[s].sum_ns += current.sum_ns - base->sum_ns;
+
+        // exact max is not resettable; bound it by the highest bucket since the baseline
+        uint64_t window_max = 0;
+        for (int i = LATENCY_BUCKET_COUNT - 1; i >= 0; i--) {
+            if (current.counts[i] != base->counts[i]) {
+                window_max = bucket_upper_value(i);
+                break;
+            }
+        }
+        if (window_max > current.max_ns) window_max = current.max_ns;
+        if (window_max > accum[s].max_ns) accum[s].max_ns = window_max;
+
+        if (reset) {
+            profile->baseline[s] = current;
+        }
+    }
+}
+
+static void fill_snapshot(LatencySnapshot *out, const LatencyHistogram *accum) {
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        out->stages[s] = latency_histogram_stats(&accum[s]);
+    }
+}
+
+void latency_snapshot_profile(LatencyProfile *profile, LatencySnapshot *out, bool reset) {
+    if (!out) return;
+    memset(out, 0, sizeof(LatencySnapshot));
+    if (!profile) return;
+
+    LatencyHistogram *accum = calloc(LATENCY_STAGE_COUNT, sizeof(LatencyHistogram));
+    if (!accum) return;
+
+    snapshot_into(profile, accum, reset);
+    fill_snapshot(out, accum);
+    free(accum);
+}
+
+void latency_snapshot_threads(LatencySnapshot *out, bool reset) {
+    if (!out) return;
+    memset(out, 0, sizeof(LatencySnapshot));
+
+    LatencyHistogram *accum = calloc(LATENCY_STAGE_COUNT, sizeof(LatencyHistogram));
+    if (!accum) return;
+
+    pthread_mutex_lock(&registry_lock);
+    snapshot_into(&retired_profile, accum, reset);
+    for (int t = 0; t < LATENCY_MAX_THREADS; t++) {
+        if (thread_profiles[t]) snapshot_into(thread_profiles[t], accum, reset);
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    fill_snapshot(out, accum);
+    free(accum);
+}
+
+// thread-exit destructor: fold the thread's counts and reset baselines into the
+// retired profile, so snapshots see the same windows, and free its slot
+static void retire_thread_profile(void *arg) {
+    LatencyProfile *profile = arg;
+
+    pthread_mutex_lock(&registry_lock);
+    for (int t = 0; t < LATENCY_MAX_THREADS; t++) {
+        if (thread_profiles[t] == profile) thread_profiles[t] = NULL;
+    }
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        latency_histogram_merge(&retired_profile.stages[s], &profile->stages[s]);
+        latency_histogram_merge(&retired_profile.baseline[s], &profile->baseline[s]);
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    current_thread_profile = NULL;
+    destroy_latency_profile(profile);
+}
+
+static void create_registry_key(void) {
+    pthread_key_create(&registry_key, retire_thread_profile);
+}
+
+LatencyProfile* latency_thread_profile(void) {
+    if (current_thread_claimed) return current_thread_profile;
+    current_thread_claimed = true;
+
+    pthread_once(&registry_key_once, create_registry_key);
+    LatencyProfile *profile = create_latency_profile();
+    if (!profile) return NULL;
+
+    pthread_mutex_lock(&registry_lock);
+    int slot = 0;
+    while (slot < LATENCY_MAX_THREADS && thread_profiles[slot]) slot++;
+    if (slot < LATENCY_MAX_THREADS) thread_profiles[slot] = profile;
+    pthread_mutex_unlock(&registry_lock);
+
+    if (slot == LATENCY_MAX_THREADS || pthread_setspecific(registry_key, profile) != 0) {
+        // registry full or no exit hook: the thread goes unrecorded
+        if (slot < LATENCY_MAX_THREADS) retire_thread_profile(profile);
+        else destroy_latency_profile(profile);
+        return NULL;
+    }
+
+    current_thread_profile = profile;
+    return profile;
+}
+
+uint64_t latency_record_stage(LatencyProfile *pair_profile, LatencyStage stage, uint64_t since_ns) {
+    uint64_t now = latency_now_ns();
+    uint64_t elapsed = now - since_ns;
+
+    LatencyProfile *thread_profile = latency_thread_profile();
+    if (thread_profile) latency_histogram_record(&thread_profile->stages[stage], elapsed);
+    if (pair_profile) latency_histogram_record(&pair_profile->stages[stage], elapsed);
+
+    return now;
+}
+
+bool pair_tracker_enable_latency_profile(PairTracker *tracker) {
+    if (!tracker) return false;
+    if (tracker->latency_profile) return true;
+
+    tracker->latency_profile = create_latency_profile();
+    return tracker->latency_profile != NULL;
+}
+
+void print_latency_snapshot(const LatencySnapshot *snapshot) {
+    if (!snapshot) return;
+
+    printf("%-14s %10s %10s %10s %10s %10s %10s\n",
+           "Stage", "Count", "Mean(ns)", "p50", "p99", "p99.9", "Max");
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        const LatencyStats *st = &snapshot->stages[s];
+        if (st->count == 0) continue;
+        printf("%-14s %10llu %10.1f %10llu %10llu %10llu %10llu\n",
+               stage_names[s], (unsigned long long)st->count, st->mean_ns,
+               (unsigned long long)st->p50_ns, (unsigned long long)st->p99_ns,
+               (unsigned long long)st->p999_ns, (unsigned long long)st->max_ns);
+    }
+}
@@ -0,0 +1,275 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <pthread.h>
+
+// End-to-end multi-pair load test over a synthetic universe. Sweeps thread count,
+// pair count and window size; prints one JSON document on stdout.
+//
+//   ./sakura_signals_loadtest [--symbols N] [--steps K] [--rate TICKS_PER_SEC]
+//                             [--threads 1,2,4] [--pairs 16,64,256] [--windows 32,128]
+//
+// Each thread owns a PairUniverse with its share of the pairs and replays the full
+// tick stream. Latency is tick-to-signal per tick that touched at least one pair;
+// when --rate is set it is measured from the scheduled arrival time, so queueing
+// behind a slow tick is included.
+
+#define LOADTEST_MAX_SWEEP 16
+
+typedef struct {
+    int values[LOADTEST_MAX_SWEEP];
+    int count;
+} SweepList;
+
+typedef struct {
+    PairUniverse *universe;
+    const TickRecord *ticks;
+    long n_ticks;
+    long warmup_ticks;
+    double tick_rate;
+    pthread_barrier_t *barrier;
+    pthread_mutex_t *start_gate;
+    const bool *aborted;
+    PairSignalCompact *signals;
+    LatencyHistogram latency;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    long pair_updates;
+    long trade_signals;
+} LoadWorker;
+
+static bool parse_list(const char *text, SweepList *list) {
+    list->count = 0;
+    while (*text && list->count < LOADTEST_MAX_SWEEP) {
+        char *end;
+        long v = strtol(text, &end, 10);
+        if (end == text || v <= 0) return false;
+        list->values[list->count++] = (int)v;
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return list->count > 0;
+}
+
+static void* worker_main(void *arg) {
+    LoadWorker *w = arg;
+    int max_signals = w->universe->n_pairs;
+
+    // held by run_config until every worker has started; the barrier below is
+    // sized for all of them, so a partial start must not reach it
+    pthread_mutex_lock(w->start_gate);
+    bool aborted = *w->aborted;
+    pthread_mutex_unlock(w->start_gate);
+    if (aborted) return NULL;
+
+    // warm the rolling windows before timing
+    for (long i = 0; i < w->warmup_ticks; i++) {
+        pair_universe_on_quote_compact(w->universe, &w->ticks[i], w->signals, max_signals);
+    }
+
+    pthread_barrier_wait(w->barrier);
+    w->start_ns = latency_now_ns();
+
+    for (long i = w->warmup_ticks; i < w->n_ticks; i++) {
+        uint64_t arrival = latency_now_ns();
+        if (w->tick_rate > 0) {
+            uint64_t scheduled = w->start_ns + (uint64_t)((double)(i - w->warmup_ticks) * 1e9 / w->tick_rate);
+            while (arrival < scheduled) arrival = latency_now_ns();
+            arrival = scheduled;
+        }
+
+        int n = pair_universe_on_quote_compact(w->universe, &w->ticks[i], w->signals, max_signals);
+        if (n > 0) {
+            latency_histogram_record(&w->latency, latency_now_ns() - arrival);
+            w->pair_updates += n;
+            for (int k = 0; k < n && k < max_signals; k++) {
+                if (w->signals[k].signal != 0) w->trade_signals++;
+            }
+        }
+    }
+
+    w->end_ns = latency_now_ns();
+    return NULL;
+}
+
+static bool run_config(const TickRecord *ticks, long n_ticks, int n_symbols, const int *leg1, const int *leg2,
+                       int n_pairs, int n_threads, int window, double tick_rate, bool first) {
+    LoadWorker *workers = calloc(n_threads, sizeof(LoadWorker));
+    pthread_t *threads = malloc(n_threads * sizeof(pthread_t));
+    pthread_barrier_t barrier;
+    pthread_mutex_t start_gate = PTHREAD_MUTEX_INITIALIZER;
+    bool aborted = false;
+    if (!workers || !threads) {
+        free(workers);
+        free(threads);
+        return false;
+    }
+    pthread_barrier_init(&barrier, NULL, (unsigned)n_threads);
+
+    bool ok = true;
+    for (int t = 0; t < n_threads; t++) {
+        LoadWorker *w = &workers[t];
+        int share = n_pairs / n_threads + (t < n_pairs % n_threads ? 1 : 0);
+        w->universe = create_pair_universe(n_symbols, share > 0 ? share : 1);
+        w->signals = malloc((share > 0 ? share : 1) * sizeof(PairSignalCompact));
+        if (!w->universe || !w->signals) {
+            ok = false;
+            continue;
+        }
+
+        // pairs dealt round-robin so each thread sees a mix of cointegrated and random pairs
+        for (int p = t; p < n_pairs; p += n_threads) {
+            PairTracker *tracker = create_enhanced_pair_tracker(window, true);
+            if (!tracker || pair_universe_add_pair(w->universe, leg1[p], leg2[p], tracker) < 0) {
+                destroy_pair_tracker(tracker);
+                ok = false;
+            }
+        }
+
+        w->ticks = ticks;
+        w->n_ticks = n_ticks;
+        w->warmup_ticks = (long)(window + 1) * n_symbols;
+        if (w->warmup_ticks > n_ticks / 2) w->warmup_ticks = n_ticks / 2;
+        w->tick_rate = tick_rate;
+        w->barrier = &barrier;
+        w->start_gate = &start_gate;
+        w->aborted = &aborted;
+    }
+
+    int n_started = 0;
+    if (ok) {
+        pthread_mutex_lock(&start_gate);
+        while (n_started < n_threads &&
+               pthread_create(&threads[n_started], NULL, worker_main, &workers[n_started]) == 0) {
+            n_started++;
+        }
+        aborted = n_started < n_threads;
+        pthread_mutex_unlock(&start_gate);
+        for (int t = 0; t < n_started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        ok = !aborted;
+    }
+
+    if (ok) {
+
+        LatencyHistogram merged = {0};
+        uint64_t start = workers[0].start_ns, end = workers[0].end_ns;
+        long updates = 0, trades = 0;
+        for (int t = 0; t < n_threads; t++) {
+            latency_histogram_merge(&merged, &workers[t].latency);
+            if (workers[t].start_ns < start) start = workers[t].start_ns;
+            if (workers[t].end_ns > end) end = workers[t].end_ns;
+            updates += workers[t].pair_updates;
+            trades += workers[t].trade_signals;
+        }
+
+        double wall_s = (double)(end - start) / 1e9;
+        long timed_ticks = n_ticks - workers[0].warmup_ticks;
+        LatencyStats stats = latency_histogram_stats(&merged);
+
+        printf("%s    {\"threads\": %d, \"pairs\": %d, \"window\": %d, \"ticks\": %ld, \"wall_s\": %.4f, "
+               "\"ticks_per_sec\": %.0f, \"signals_per_sec\": %.0f, \"trade_signals\": %ld, "
+               "\"p50_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu}",
+               first ? "" : ",\n", n_threads, n_pairs, window, timed_ticks, wall_s,
+               wall_s > 0 ? timed_ticks / wall_s : 0.0, wall_s > 0 ? updates / wall_s : 0.0, trades,
+               (unsigned long long)stats.p50_ns, (unsigned long long)stats.p99_ns,
+               (unsigned long long)stats.p999_ns, (unsigned long long)stats.max_ns);
+        fprintf(stderr, "  threads=%-2d pairs=%-5d window=%-5d %10.0f ticks/s %12.0f signals/s  p99=%llu ns\n",
+                n_threads, n_pairs, window, wall_s > 0 ? timed_ticks / wall_s : 0.0,
+                wall_s > 0 ? updates / wall_s : 0.0, (unsigned long long)stats.p99_ns);
+    } else {
+        fprintf(stderr, "Skipping threads=%d pairs=%d window=%d: %s failed\n", n_threads, n_pairs, window,
+                aborted ? "thread start" : "setup");
+    }
+
+    for (int t = 0; t < n_threads; t++) {
+        destroy_pair_universe(workers[t].universe);
+        free(workers[t].signals);
+    }
+    pthread_barrier_destroy(&barrier);
+    pthread_mutex_destroy(&start_gate);
+    free(workers);
+    free(threads);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int n_symbols = 64;
+    int n_steps = 2000;
+    double tick_rate = 0.0;
+    SweepList thread_list = {{1, 2, 4}, 3};
+    SweepList pair_list = {{16, 64, 256}, 3};
+    SweepList window_list = {{32, 128}, 2};
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        bool ok = true;
+        if (strcmp(argv[i], "--symbols") == 0) n_symbols = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--steps") == 0) n_steps = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--rate") == 0) tick_rate = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) ok = parse_list(argv[i + 1], &thread_list);
+        else if (strcmp(argv[i], "--pairs") == 0) ok = parse_list(argv[i + 1], &pair_list);
+        else if (strcmp(argv[i], "--windows") == 0) ok = parse_list(argv[i + 1], &window_list);
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+            return 1;
+        }
+    }
+    if (n_symbols < 2 || n_steps < 2) {
+        fprintf(stderr, "Need at least 2 symbols and 2 steps\n");
+        return 1;
+    }
+
+    SyntheticUniverseConfig config = default_synthetic_universe_config(n_symbols);
+    SyntheticUniverse *universe = create_synthetic_universe(&config);
+    long n_ticks = (long)n_steps * n_symbols;
+    TickRecord *ticks = malloc(n_ticks * sizeof(TickRecord));
+
+    int max_pairs = 0;
+    for (int i = 0; i < pair_list.count; i++) {
+        if (pair_list.values[i] > max_pairs) max_pairs = pair_list.values[i];
+    }
+    int *leg1 = malloc(max_pairs * sizeof(int));
+    int *leg2 = malloc(max_pairs * sizeof(int));
+
+    if (!universe || !ticks || !leg1 || !leg2) {
+        fprintf(stderr, "Memory allocation failed\n");
+        destroy_synthetic_universe(universe);
+        free(ticks);
+        free(leg1);
+        free(leg2);
+        return 1;
+    }
+
+    // pre-generate the stream so the generator is not part of the measurement
+    for (int s = 0; s < n_steps; s++) {
+        synthetic_universe_advance(universe, &ticks[(long)s * n_symbols]);
+    }
+    int available_pairs = synthetic_universe_pairs(universe, max_pairs, leg1, leg2);
+
+    printf("{\n  \"config\": {\"symbols\": %d, \"steps\": %d, \"target_tick_rate\": %.0f, \"cointegrated_groups\": %d},\n",
+           n_symbols, n_steps, tick_rate, universe->n_groups);
+    printf("  \"results\": [\n");
+
+    bool first = true;
+    for (int w = 0; w < window_list.count; w++) {
+        for (int p = 0; p < pair_list.count; p++) {
+            int n_pairs = pair_list.values[p] < available_pairs ? pair_list.values[p] : available_pairs;
+            for (int t = 0; t < thread_list.count; t++) {
+                if (run_config(ticks, n_ticks, n_symbols, leg1, leg2, n_pairs,
+                               thread_list.values[t], window_list.values[w], tick_rate, first)) {
+                    first = false;
+                }
+            }
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    destroy_synthetic_universe(universe);
+    free(ticks);
+    free(leg1);
+    free(leg2);
+    return 0;
+}
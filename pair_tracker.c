@@ -0,0 +1,195 @@
+#include "sakura_signals.h"
+
+SignalParams default_signal_params(void) {
+    SignalParams params;
+    
+    params.entry_threshold = 2.0;
+    params.exit_threshold = 0.5;
+    params.stress_entry_multiplier = 1.5;
+    params.stress_exit_multiplier = 1.2;
+    params.crisis_entry_multiplier = 2.5;
+    params.crisis_exit_multiplier = 2.0;
+    params.attention_blend = 0.7; // 70% attn, 30% trad
+    params.hedge_lookback = 20;
+    params.target_volatility = 0.15; // 15% target vol
+    params.hedge_mode = HEDGE_MODE_ROLLING;
+    params.hedge_process_noise = 1e-9;
+    params.hedge_uncertainty_weight = 1.0;
+    params.half_life_span = 0;
+    
+    return params;
+}
+
+PairTracker* create_pair_tracker(int window_size) {
+    // zeroed so optional components and feature flags start disabled
+    PairTracker *tracker = calloc(1, sizeof(PairTracker));
+    if (!tracker) return NULL;
+    
+    tracker->price_buffer1 = create_circular_buffer(window_size);
+    tracker->price_buffer2 = create_circular_buffer(window_size);
+    tracker->spread_buffer = create_circular_buffer(window_size);
+    tracker->window_size = window_size;
+    tracker->pair_id = -1;
+    tracker->params = default_signal_params();
+    kalman_hedge_init(&tracker->hedge_filter, tracker->params.hedge_process_noise, tracker->params.hedge_lookback);
+    tracker->mean_spread = 0.0;
+    tracker->std_spread = 0.0;
+    tracker->correlation = 0.0;
+    tracker->attention_enhanced_zscore = 0.0;
+    tracker->use_attention = false;
+    tracker->temporal_attention = NULL;
+    tracker->attention_cache = NULL;
+    
+    if (!tracker->price_buffer1 || !tracker->price_buffer2 || !tracker->spread_buffer) {
+        destroy_circular_buffer(tracker->price_buffer1);
+        destroy_circular_buffer(tracker->price_buffer2);
+        destroy_circular_buffer(tracker->spread_buffer);
+        free(tracker);
+        return NULL;
+    }
+    
+    return tracker;
+}
+
+PairTracker* create_pair_tracker_with_attention(int window_size) {
+    PairTracker *tracker = create_pair_tracker(window_size);
+    if (!tracker) return NULL;
+    
+    // Initialize attention mechanism
+    tracker->temporal_attention = create_attention_layer(1, 2, window_size); // 1D input, 2D attention
+    tracker->attention_cache = create_attention_output(window_size, 2);
+    tracker->use_attention = true;
+    
+    if (!tracker->temporal_attention || !tracker->attention_cache) {
+        destroy_attention_layer(tracker->temporal_attention);
+        destroy_attention_output(tracker->attention_cache);
+        destroy_pair_tracker(tracker);
+        return NULL;
+    }
+    
+    return tracker;
+}
+
+PairTracker* create_enhanced_pair_tracker(int window_size, bool use_all_features) {
+    return create_enhanced_pair_tracker_with_model(window_size, use_all_features, NULL);
+}
+
+// with a model, the attention layer is a view of its shared weights from the
+// start, so no private weights are allocated and initialized only to be dropped
+PairTracker* create_enhanced_pair_tracker_with_model(int window_size, bool use_all_features,
+                                                     AttentionModel *model) {
+    PairTracker *tracker = create_pair_tracker(window_size);
+    if (!tracker) return NULL;
+    
+    // init additional buffers
+    tracker->hedge_ratio_buffer = create_circular_buffer(window_size);
+    tracker->return_prefix = create_prefix_buffer(window_size);
+    
+    if (!tracker->hedge_ratio_buffer || !tracker->return_prefix) {
+        destroy_pair_tracker(tracker);
+        return NULL;
+    }
+    
+    if (use_all_features) {
+        // enable attention
+        tracker->temporal_attention = model ? create_attention_layer_from_model(model, window_size)
+                                            : create_attention_layer(1, 2, window_size);
+        tracker->attention_cache = create_attention_output(window_size, 2);
+        tracker->use_attention = true;
+        if (model && !tracker->temporal_attention) {
+            destroy_pair_tracker(tracker);
+            return NULL;
+        }
+        
+        // enable regime detection
+        tracker->regime_detector = create_regime_detector(window_size / 2);
+        tracker->use_regime_detection = true;
+        
+        // enable risk management with volatility targeting
+        tracker->risk_manager = create_risk_manager(window_size, tracker->params.target_volatility);
+        
+        // enable dynamic hedging
+        tracker->use_dynamic_hedging = true;
+        
+        // enable transaction costs
+        tracker->use_transaction_costs = true;
+        tracker->transaction_costs = create_transaction_costs(0.001, 0.001, 0.0005, 0.0005);
+        
+        // init dynamic thresholds
+        tracker->dynamic_entry_threshold = tracker->params.entry_threshold;
+        tracker->dynamic_exit_threshold = tracker->params.exit_threshold;
+        tracker->current_hedge_ratio = 1.0;
+    }
+    
+    // pick the specialized signal function for this feature set once
+    select_signal_variant(tracker);
+    
+    return tracker;
+}
+
+void pair_tracker_set_params(PairTracker *tracker, const SignalParams *params) {
+    if (!tracker || !params) return;
+    
+    tracker->params = *params;
+    if (tracker->params.hedge_lookback < 5) tracker->params.hedge_lookback = 5; // regression minimum
+    if (tracker->params.hedge_lookback > tracker->window_size) {
+        tracker->params.hedge_lookback = tracker->window_size; // the price buffers hold no more
+    }
+    
+    // retune the hedge filter in place; its estimate carries over
+    tracker->hedge_filter.process_noise = tracker->params.hedge_process_noise;
+    tracker->hedge_filter.noise_alpha = 2.0 / (tracker->params.hedge_lookback + 1);
+    half_life_stream_set_span(&tracker->half_life_stream, tracker->params.half_life_span);
+    
+    if (tracker->risk_manager) {
+        tracker->risk_manager->target_volatility = tracker->params.target_volatility;
+    }
+    if (tracker->position == 0) {
+        tracker->dynamic_entry_threshold = tracker->params.entry_threshold;
+        tracker->dynamic_exit_threshold = tracker->params.exit_threshold;
+    }
+    
+    // the hedge mode is part of the variant mask
+    if (tracker->signal_fn) select_signal_variant(tracker);
+}
+
+// swap the tracker's own weights for a view of a shared model; trackers without
+// attention are left alone
+bool pair_tracker_set_attention_model(PairTracker *tracker, AttentionModel *model) {
+    if (!tracker || !model || !tracker->temporal_attention) return false;
+    
+    AttentionLayer *layer = create_attention_layer_from_model(model, tracker->temporal_attention->sequence_length);
+    if (!layer) return false;
+    
+    destroy_attention_layer(tracker->temporal_attention);
+    tracker->temporal_attention = layer;
+    return true;
+}
+
+// trackers without regime detection are left alone
+bool pair_tracker_set_regime_model(PairTracker *tracker, const RegimeModelParams *params) {
+    if (!tracker || !params || !tracker->regime_detector) return false;
+    return regime_detector_set_model(tracker->regime_detector, params);
+}
+
+void destroy_pair_tracker(PairTracker *tracker) {
+    if (tracker) {
+        destroy_circular_buffer(tracker->price_buffer1);
+        destroy_circular_buffer(tracker->price_buffer2);
+        destroy_circular_buffer(tracker->spread_buffer);
+        destroy_circular_buffer(tracker->hedge_ratio_buffer);
+        destroy_prefix_buffer(tracker->return_prefix);
+        destroy_attention_layer(tracker->temporal_attention);
+        destroy_attention_output(tracker->attention_cache);
+        destroy_regime_detector(tracker->regime_detector);
+        destroy_risk_manager(tracker->risk_manager);
+        destroy_latency_profile(tracker->latency_profile);
+        free(tracker);
+    }
+}
+
+// every spread goes through here so the streaming attention and half-life sums stay in step
+void tracker_push_spread(PairTracker *tracker, double spread) {
+    half_life_stream_advance(&tracker->half_life_stream, tracker->spread_buffer, spread);
+    attention_stream_push(&tracker->attention_stream, tracker->spread_buffer, spread);
+}
@@ -0,0 +1,190 @@
+#include "sakura_signals.h"
+
+PairUniverse* create_pair_universe(int n_symbols, int pair_capacity) {
+    if (n_symbols <= 0 || pair_capacity <= 0) return NULL;
+
+    PairUniverse *universe = calloc(1, sizeof(PairUniverse));
+    if (!universe) return NULL;
+
+    universe->trackers = calloc(pair_capacity, sizeof(PairTracker*));
+    universe->leg1 = malloc(pair_capacity * sizeof(int));
+    universe->leg2 = malloc(pair_capacity * sizeof(int));
+    universe->last_price = calloc(n_symbols, sizeof(double));
+    universe->last_bid = calloc(n_symbols, sizeof(double));
+    universe->last_ask = calloc(n_symbols, sizeof(double));
+    universe->symbol_pair_offsets = calloc(n_symbols + 1, sizeof(int));
+    universe->symbol_pairs = malloc(2 * pair_capacity * sizeof(int));
+    universe->n_symbols = n_symbols;
+    universe->pair_capacity = pair_capacity;
+    universe->n_pairs = 0;
+
+    if (!universe->trackers || !universe->leg1 || !universe->leg2 ||
+        !universe->last_price || !universe->last_bid || !universe->last_ask ||
+        !universe->symbol_pair_offsets || !universe->symbol_pairs) {
+        destroy_pair_universe(universe);
+        return NULL;
+    }
+
+    return universe;
+}
+
+void destroy_pair_universe(PairUniverse *universe) {
+    if (universe) {
+        if (universe->trackers) {
+            for (int i = 0; i < universe->n_pairs; i++) {
+                destroy_pair_tracker(universe->trackers[i]);
+            }
+        }
+        free(universe->trackers);
+        free(universe->leg1);
+        free(universe->leg2);
+        free(universe->symbol_pair_offsets);
+        free(universe->symbol_pairs);
+        free(universe->last_price);
+        free(universe->last_bid);
+        free(universe->last_ask);
+        free(universe);
+    }
+}
+
+int pair_universe_add_pair(PairUniverse *universe, int symbol1, int symbol2, PairTracker *tracker) {
+    if (!universe || !tracker || universe->n_pairs >= universe->pair_capacity) return -1;
+    if (symbol1 < 0 || symbol1 >= universe->n_symbols || symbol2 < 0 || symbol2 >= universe->n_symbols) return -1;
+
+    int pair_id = universe->n_pairs++;
+    universe->trackers[pair_id] = tracker; // universe owns the tracker from here on
+    universe->leg1[pair_id] = symbol1;
+    universe->leg2[pair_id] = symbol2;
+    tracker->pair_id = pair_id;
+    universe->routing_dirty = true;
+
+    return pair_id;
+}
+
+// returns how many trackers now read the model's weights
+int pair_universe_set_attention_model(PairUniverse *universe, AttentionModel *model) {
+    if (!universe || !model) return 0;
+    
+    int updated = 0;
+    for (int i = 0; i < universe->n_pairs; i++) {
+        if (pair_tracker_set_attention_model(universe->trackers[i], model)) updated++;
+    }
+    return updated;
+}
+
+// returns how many trackers now filter regimes with the model
+int pair_universe_set_regime_model(PairUniverse *universe, const RegimeModelParams *params) {
+    if (!universe || !params) return 0;
+    
+    int updated = 0;
+    for (int i = 0; i < universe->n_pairs; i++) {
+        if (pair_tracker_set_regime_model(universe->trackers[i], params)) updated++;
+    }
+    return updated;
+}
+
+// One batched QKV pass over every pair's spread window, e.g. once per bar rather
+// than per tick. zscores[p] is the attention z-score of pair p, 0 while its window
+// is shorter than the layer's sequence length. Returns how many pairs were scored.
+int pair_universe_attention_step(PairUniverse *universe, const AttentionLayer *layer,
+                                 AttentionBatch *batch, double *zscores) {
+    if (!universe || !layer || !batch || !zscores || batch->n_pairs < universe->n_pairs) return 0;
+
+    size_t window_doubles = (size_t)batch->sequence_length * batch->n_features;
+    for (int p = 0; p < universe->n_pairs; p++) {
+        if (!attention_batch_set_window(batch, p, universe->trackers[p]->spread_buffer)) {
+            memset(batch->inputs + p * window_doubles, 0, window_doubles * sizeof(double));
+        }
+    }
+
+    int scored = 0;
+    bool ok = attention_batch_forward(layer, batch);
+    for (int p = 0; p < universe->n_pairs; p++) {
+        bool ready = ok && batch->ready[p];
+        zscores[p] = ready ? attention_batch_zscore(batch, p) : 0.0;
+        if (ready) scored++;
+    }
+
+    return scored;
+}
+
+// Counting sort of pair legs by symbol. Pair ids stay ascending within each
+// symbol, so quotes update pairs in the same order a full scan would.
+bool pair_universe_build_routing(PairUniverse *universe) {
+    if (!universe) return false;
+
+    int *offsets = universe->symbol_pair_offsets;
+    memset(offsets, 0, (universe->n_symbols + 1) * sizeof(int));
+    for (int p = 0; p < universe->n_pairs; p++) {
+        offsets[universe->leg1[p] + 1]++;
+        if (universe->leg2[p] != universe->leg1[p]) offsets[universe->leg2[p] + 1]++;
+    }
+    for (int s = 0; s < universe->n_symbols; s++) offsets[s + 1] += offsets[s];
+
+    int *fill = malloc(universe->n_symbols * sizeof(int));
+    if (!fill) return false;
+    memcpy(fill, offsets, universe->n_symbols * sizeof(int));
+
+    for (int p = 0; p < universe->n_pairs; p++) {
+        universe->symbol_pairs[fill[universe->leg1[p]]++] = p;
+        if (universe->leg2[p] != universe->leg1[p]) universe->symbol_pairs[fill[universe->leg2[p]]++] = p;
+    }
+
+    free(fill);
+    universe->routing_dirty = false;
+    return true;
+}
+
+int pair_universe_symbol_pairs(PairUniverse *universe, int symbol, const int **pair_ids) {
+    if (!universe || symbol < 0 || symbol >= universe->n_symbols) return 0;
+    if (universe->routing_dirty && !pair_universe_build_routing(universe)) return 0;
+
+    int begin = universe->symbol_pair_offsets[symbol];
+    if (pair_ids) *pair_ids = universe->symbol_pairs + begin;
+    return universe->symbol_pair_offsets[symbol + 1] - begin;
+}
+
+// Steps every pair with a leg in the quoted symbol. Compact results go to `compact`,
+// fully materialized ones to `full`; either may be NULL.
+static int universe_on_quote(PairUniverse *universe, const TickRecord *tick,
+                             PairSignalCompact *compact, PairSignal *full, int max_signals) {
+    if (!universe || !tick || tick->symbol < 0 || tick->symbol >= universe->n_symbols) return 0;
+
+    int symbol = tick->symbol;
+    universe->last_price[symbol] = tick->last;
+    universe->last_bid[symbol] = tick->bid;
+    universe->last_ask[symbol] = tick->ask;
+
+    // re-evaluate every pair with a leg in this symbol once both legs have quoted
+    const int *pair_ids = NULL;
+    int n_routed = pair_universe_symbol_pairs(universe, symbol, &pair_ids);
+    int updated = 0;
+    for (int k = 0; k < n_routed; k++) {
+        int p = pair_ids[k];
+        int s1 = universe->leg1[p];
+        int s2 = universe->leg2[p];
+        if (universe->last_price[s1] <= 0 || universe->last_price[s2] <= 0) continue;
+
+        PairSignalCompact signal = generate_compact_pairs_signal(universe->trackers[p],
+            universe->last_price[s1], universe->last_price[s2],
+            universe->last_bid[s1], universe->last_ask[s1],
+            universe->last_bid[s2], universe->last_ask[s2], (long)tick->timestamp_micro);
+
+        if (updated < max_signals) {
+            if (compact) compact[updated] = signal;
+            if (full) full[updated] = materialize_pair_signal(universe->trackers[p], true);
+        }
+        updated++;
+    }
+
+    return updated;
+}
+
+int pair_universe_on_quote(PairUniverse *universe, const TickRecord *tick, PairSignal *signals, int max_signals) {
+    return universe_on_quote(universe, tick, NULL, signals, max_signals);
+}
+
+int pair_universe_on_quote_compact(PairUniverse *universe, const TickRecord *tick,
+                                   PairSignalCompact *signals, int max_signals) {
+    return universe_on_quote(universe, tick, signals, NULL, max_signals);
+}
@@ -0,0 +1,139 @@
+#include "sakura_signals.h"
+
+// With P[t] the sum of the first t samples, the latest n samples sum to
+// P[total] - P[total - n]. Only the last capacity + 1 prefixes are ever needed,
+// so they live in a ring one longer than the samples. Squares and cross-products
+// only grow, so the sums are rebased every `capacity` pushes: the origin moves to
+// the window mean and the prefixes are recomputed from the raw samples, which
+// bounds both their magnitude and the rounding carried forward at O(1)
+// amortized cost.
+
+PrefixBuffer* create_prefix_buffer(int capacity) {
+    if (capacity < 1) return NULL;
+
+    PrefixBuffer *pb = calloc(1, sizeof(PrefixBuffer));
+    if (!pb) return NULL;
+
+    pb->capacity = capacity;
+    pb->x = malloc(capacity * sizeof(double));
+    pb->y = malloc(capacity * sizeof(double));
+    pb->sum_x = calloc(capacity + 1, sizeof(double));
+    pb->sum_y = calloc(capacity + 1, sizeof(double));
+    pb->sum_xx = calloc(capacity + 1, sizeof(double));
+    pb->sum_yy = calloc(capacity + 1, sizeof(double));
+    pb->sum_xy = calloc(capacity + 1, sizeof(double));
+
+    if (!pb->x || !pb->y || !pb->sum_x || !pb->sum_y || !pb->sum_xx || !pb->sum_yy || !pb->sum_xy) {
+        destroy_prefix_buffer(pb);
+        return NULL;
+    }
+    return pb;
+}
+
+void destroy_prefix_buffer(PrefixBuffer *pb) {
+    if (pb) {
+        free(pb->x);
+        free(pb->y);
+        free(pb->sum_x);
+        free(pb->sum_y);
+        free(pb->sum_xx);
+        free(pb->sum_yy);
+        free(pb->sum_xy);
+        free(pb);
+    }
+}
+
+static void pb_rebase(PrefixBuffer *pb) {
+    int capacity = pb->capacity;
+    long start = pb->total - pb->count;
+
+    double mean_x = 0.0, mean_y = 0.0;
+    for (int i = 0; i < pb->count; i++) {
+        int slot = (int)((start + i) % capacity);
+        mean_x += pb->x[slot];
+        mean_y += pb->y[slot];
+    }
+    if (pb->count > 0) {
+        pb->origin_x = mean_x / pb->count;
+        pb->origin_y = mean_y / pb->count;
+    }
+
+    int at = (int)(start % (capacity + 1));
+    pb->sum_x[at] = pb->sum_y[at] = pb->sum_xx[at] = pb->sum_yy[at] = pb->sum_xy[at] = 0.0;
+    for (int i = 0; i < pb->count; i++) {
+        int slot = (int)((start + i) % capacity);
+        int next = (int)((start + i + 1) % (capacity + 1));
+        double dx = pb->x[slot] - pb->origin_x;
+        double dy = pb->y[slot] - pb->origin_y;
+        pb->sum_x[next] = pb->sum_x[at] + dx;
+        pb->sum_y[next] = pb->sum_y[at] + dy;
+        pb->sum_xx[next] = pb->sum_xx[at] + dx * dx;
+        pb->sum_yy[next] = pb->sum_yy[at] + dy * dy;
+        pb->sum_xy[next] = pb->sum_xy[at] + dx * dy;
+        at = next;
+    }
+    pb->since_rebase = 0;
+}
+
+void pb_push(PrefixBuffer *pb, double x, double y) {
+    int capacity = pb->capacity;
+    if (pb->count == 0) {
+        pb->origin_x = x;
+        pb->origin_y = y;
+    }
+
+    int slot = (int)(pb->total % capacity);
+    int at = (int)(pb->total % (capacity + 1));
+    int next = (int)((pb->total + 1) % (capacity + 1));
+    double dx = x - pb->origin_x;
+    double dy = y - pb->origin_y;
+
+    pb->x[slot] = x;
+    pb->y[slot] = y;
+    pb->sum_x[next] = pb->sum_x[at] + dx;
+    pb->sum_y[next] = pb->sum_y[at] + dy;
+    pb->sum_xx[next] = pb->sum_xx[at] + dx * dx;
+    pb->sum_yy[next] = pb->sum_yy[at] + dy * dy;
+    pb->sum_xy[next] = pb->sum_xy[at] + dx * dy;
+
+    pb->total++;
+    if (pb->count < capacity) pb->count++;
+    if (++pb->since_rebase >= capacity) pb_rebase(pb);
+}
+
+void pb_clear(PrefixBuffer *pb) {
+    pb->count = 0;
+    pb->total = 0;
+    pb->since_rebase = 0;
+    pb->sum_x[0] = pb->sum_y[0] = pb->sum_xx[0] = pb->sum_yy[0] = pb->sum_xy[0] = 0.0;
+}
+
+int pb_size(const PrefixBuffer *pb) {
+    return pb->count;
+}
+
+// lookback is clipped to the samples held; n == 0 when there are none
+PrefixWindow pb_window(const PrefixBuffer *pb, int lookback) {
+    PrefixWindow w;
+    memset(&w, 0, sizeof(w));
+
+    int n = lookback < pb->count ? lookback : pb->count;
+    if (n < 1) return w;
+
+    int b = (int)(pb->total % (pb->capacity + 1));
+    int a = (int)((pb->total - n) % (pb->capacity + 1));
+    double sx = pb->sum_x[b] - pb->sum_x[a];
+    double sy = pb->sum_y[b] - pb->sum_y[a];
+
+    w.n = n;
+    w.mean_x = pb->origin_x + sx / n;
+    w.mean_y = pb->origin_y + sy / n;
+    if (n > 1) {
+        w.var_x = (pb->sum_xx[b] - pb->sum_xx[a] - sx * sx / n) / (n - 1);
+        w.var_y = (pb->sum_yy[b] - pb->sum_yy[a] - sy * sy / n) / (n - 1);
+        w.cov_xy = (pb->sum_xy[b] - pb->sum_xy[a] - sx * sy / n) / (n - 1);
+        if (w.var_x < 0.0) w.var_x = 0.0;
+        if (w.var_y < 0.0) w.var_y = 0.0;
+    }
+    return w;
+}
@@ -0,0 +1,275 @@
+#include "sakura_signals.h"
+
+// Batched HMM forward filter over many pairs' regime detectors.
+//
+// Each pair contributes two features per update, both estimated with
+// exponentially weighted moments so a step is O(1) per pair:
+//
+//   vol_feature   sqrt(short-span / long-span EW mean of r1^2 + r2^2), r the legs'
+//                 simple returns: about 1 in a steady market, above 1 when
+//                 volatility picks up
+//   corr_feature  EW standard deviation (long span) of the rolling correlation
+//
+// Regime k emits them as independent Gaussians, N(mean[k][f], var[k][f]). The
+// forward step is  p'(k) ∝ N(x | k) * sum_j p(j) A[j][k].  The state is stored
+// column-wise (prob[k][i], short_var[i], ...), so each stage below is a flat
+// loop over pairs with no per-pair branching that the compiler has to keep.
+
+#define REGIME_VAR_FLOOR 1e-12
+#define REGIME_LOG_2PI 1.8378770664093453
+
+// the per-pair loops in regime_batch_filter are written out for three regimes
+#if MAX_REGIMES != 3
+#error "regime_batch.c assumes MAX_REGIMES == 3"
+#endif
+
+void regime_model_default_params(RegimeModelParams *params) {
+    if (!params) return;
+    memset(params, 0, sizeof(*params));
+
+    params->initial[0] = 0.80;
+    params->initial[1] = 0.15;
+    params->initial[2] = 0.05;
+
+    // same chain as create_regime_detector
+    static const double transition[MAX_REGIMES][MAX_REGIMES] = {
+        {0.95, 0.04, 0.01},
+        {0.60, 0.30, 0.10},
+        {0.20, 0.50, 0.30},
+    };
+    memcpy(params->transition, transition, sizeof(transition));
+
+    // normal: volatility near its long-run level, correlation steady; stress and
+    // crisis: short-run volatility a half / two times above it, correlation
+    // wandering by 0.15 / 0.3 (the thresholds update_regime uses)
+    static const double mean[MAX_REGIMES][REGIME_N_FEATURES] = {
+        {1.0, 0.05}, {1.5, 0.15}, {2.5, 0.30},
+    };
+    static const double sd[MAX_REGIMES][REGIME_N_FEATURES] = {
+        {0.25, 0.05}, {0.35, 0.08}, {0.80, 0.12},
+    };
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        for (int f = 0; f < REGIME_N_FEATURES; f++) {
+            params->emission_mean[k][f] = mean[k][f];
+            params->emission_var[k][f] = sd[k][f] * sd[k][f];
+        }
+    }
+
+    params->short_span = 10;
+    params->long_span = 100;
+}
+
+RegimeBatch* create_regime_batch(int n_pairs, const RegimeModelParams *params) {
+    if (n_pairs <= 0) return NULL;
+
+    RegimeBatch *batch = calloc(1, sizeof(RegimeBatch));
+    if (!batch) return NULL;
+
+    batch->n_pairs = n_pairs;
+    if (params) {
+        batch->params = *params;
+    } else {
+        regime_model_default_params(&batch->params);
+    }
+    RegimeModelParams *p = &batch->params;
+    if (p->short_span < 1) p->short_span = 1;
+    if (p->long_span < p->short_span) p->long_span = p->short_span;
+
+    bool ok = true;
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        batch->prob[k] = malloc(n_pairs * sizeof(double));
+        batch->emission[k] = malloc(n_pairs * sizeof(double));
+        ok = ok && batch->prob[k] && batch->emission[k];
+    }
+    batch->regime = malloc(n_pairs * sizeof(int));
+    batch->confidence = malloc(n_pairs * sizeof(double));
+    batch->vol_feature = malloc(n_pairs * sizeof(double));
+    batch->corr_feature = malloc(n_pairs * sizeof(double));
+    batch->short_var = malloc(n_pairs * sizeof(double));
+    batch->long_var = malloc(n_pairs * sizeof(double));
+    batch->corr_mean = malloc(n_pairs * sizeof(double));
+    batch->corr_var = malloc(n_pairs * sizeof(double));
+    batch->last_price1 = malloc(n_pairs * sizeof(double));
+    batch->last_price2 = malloc(n_pairs * sizeof(double));
+    batch->n_updates = malloc(n_pairs * sizeof(int));
+
+    if (!ok || !batch->regime || !batch->confidence || !batch->vol_feature || !batch->corr_feature ||
+        !batch->short_var || !batch->long_var || !batch->corr_mean || !batch->corr_var ||
+        !batch->last_price1 || !batch->last_price2 || !batch->n_updates) {
+        destroy_regime_batch(batch);
+        return NULL;
+    }
+
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        double log_det = 0.0;
+        for (int f = 0; f < REGIME_N_FEATURES; f++) {
+            double var = p->emission_var[k][f] > REGIME_VAR_FLOOR ? p->emission_var[k][f] : REGIME_VAR_FLOOR;
+            batch->inv_var[k][f] = 1.0 / var;
+            log_det += REGIME_LOG_2PI + log(var);
+        }
+        batch->log_norm[k] = -0.5 * log_det;
+    }
+    batch->short_alpha = 2.0 / (p->short_span + 1);
+    batch->long_alpha = 2.0 / (p->long_span + 1);
+
+    regime_batch_reset(batch);
+    return batch;
+}
+
+void destroy_regime_batch(RegimeBatch *batch) {
+    if (batch) {
+        for (int k = 0; k < MAX_REGIMES; k++) {
+            free(batch->prob[k]);
+            free(batch->emission[k]);
+        }
+        free(batch->regime);
+        free(batch->confidence);
+        free(batch->vol_feature);
+        free(batch->corr_feature);
+        free(batch->short_var);
+        free(batch->long_var);
+        free(batch->corr_mean);
+        free(batch->corr_var);
+        free(batch->last_price1);
+        free(batch->last_price2);
+        free(batch->n_updates);
+        free(batch);
+    }
+}
+
+// back to the initial distribution with no price history
+void regime_batch_reset(RegimeBatch *batch) {
+    if (!batch) return;
+
+    int best = 0;
+    for (int k = 1; k < MAX_REGIMES; k++) {
+        if (batch->params.initial[k] > batch->params.initial[best]) best = k;
+    }
+    for (int i = 0; i < batch->n_pairs; i++) {
+        for (int k = 0; k < MAX_REGIMES; k++) batch->prob[k][i] = batch->params.initial[k];
+        batch->regime[i] = best;
+        batch->confidence[i] = batch->params.initial[best];
+        batch->vol_feature[i] = NAN;
+        batch->corr_feature[i] = NAN;
+        batch->short_var[i] = 0.0;
+        batch->long_var[i] = 0.0;
+        batch->corr_mean[i] = 0.0;
+        batch->corr_var[i] = 0.0;
+        batch->last_price1[i] = 0.0;
+        batch->last_price2[i] = 0.0;
+        batch->n_updates[i] = 0;
+    }
+}
+
+// One quote per pair. A pair whose prices are not positive (no quote this step)
+// keeps its estimators and gets NaN features, which the filter treats as a
+// step without evidence. Features stay NaN until short_span returns are in.
+void regime_batch_update_features(RegimeBatch *batch, const double *price1, const double *price2,
+                                  const double *correlation) {
+    if (!batch || !price1 || !price2) return;
+
+    double a_s = batch->short_alpha;
+    double a_l = batch->long_alpha;
+    int warmup = batch->params.short_span;
+
+    for (int i = 0; i < batch->n_pairs; i++) {
+        double p1 = price1[i], p2 = price2[i];
+        double l1 = batch->last_price1[i], l2 = batch->last_price2[i];
+        bool quoted = p1 > 0 && p2 > 0;
+        bool has_return = quoted && l1 > 0 && l2 > 0;
+
+        double r1 = has_return ? p1 / l1 - 1.0 : 0.0;
+        double r2 = has_return ? p2 / l2 - 1.0 : 0.0;
+        double v = r1 * r1 + r2 * r2;
+        int n = batch->n_updates[i];
+
+        // the first return seeds both averages
+        double ws = n == 0 ? 1.0 : a_s;
+        double wl = n == 0 ? 1.0 : a_l;
+        if (has_return) {
+            batch->short_var[i] += ws * (v - batch->short_var[i]);
+            batch->long_var[i] += wl * (v - batch->long_var[i]);
+            batch->n_updates[i] = ++n;
+        }
+
+        if (quoted && correlation) {
+            double c = correlation[i];
+            double d = c - batch->corr_mean[i];
+            bool seeded = l1 > 0 && l2 > 0;
+            batch->corr_mean[i] += (seeded ? a_l : 1.0) * d;
+            batch->corr_var[i] = seeded ? (1.0 - a_l) * (batch->corr_var[i] + a_l * d * d) : 0.0;
+        }
+        if (quoted) {
+            batch->last_price1[i] = p1;
+            batch->last_price2[i] = p2;
+        }
+
+        bool ready = has_return && n >= warmup;
+        double ratio = batch->long_var[i] > 0 ? batch->short_var[i] / batch->long_var[i] : 1.0;
+        batch->vol_feature[i] = ready ? sqrt(ratio) : NAN;
+        batch->corr_feature[i] = ready ? (correlation ? sqrt(batch->corr_var[i]) : 0.0) : NAN;
+    }
+}
+
+// Forward step for every pair on the given features (n_pairs each). NaN
+// features skip the emission: the probabilities only move through the chain.
+void regime_batch_filter(RegimeBatch *batch, const double *vol_feature, const double *corr_feature) {
+    if (!batch || !vol_feature || !corr_feature) return;
+
+    int n = batch->n_pairs;
+    double *e0 = batch->emission[0], *e1 = batch->emission[1], *e2 = batch->emission[2];
+
+    // log emission densities, then shifted so the largest per pair is 0
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        double *e = batch->emission[k];
+        double m0 = batch->params.emission_mean[k][0], iv0 = batch->inv_var[k][0];
+        double m1 = batch->params.emission_mean[k][1], iv1 = batch->inv_var[k][1];
+        double c = batch->log_norm[k];
+        for (int i = 0; i < n; i++) {
+            double d0 = vol_feature[i] - m0;
+            double d1 = corr_feature[i] - m1;
+            e[i] = c - 0.5 * (d0 * d0 * iv0 + d1 * d1 * iv1);
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        double m = e0[i] > e1[i] ? e0[i] : e1[i];
+        m = m > e2[i] ? m : e2[i];
+        // NaN features compare false everywhere: map them to equal likelihoods
+        bool valid = m == m;
+        e0[i] = valid ? e0[i] - m : 0.0;
+        e1[i] = valid ? e1[i] - m : 0.0;
+        e2[i] = valid ? e2[i] - m : 0.0;
+    }
+    for (int k = 0; k < MAX_REGIMES; k++) simd_exp_array(batch->emission[k], batch->emission[k], n);
+
+    double (*a)[MAX_REGIMES] = batch->params.transition;
+    double *p0 = batch->prob[0], *p1 = batch->prob[1], *p2 = batch->prob[2];
+    for (int i = 0; i < n; i++) {
+        double q0 = (p0[i] * a[0][0] + p1[i] * a[1][0] + p2[i] * a[2][0]) * e0[i];
+        double q1 = (p0[i] * a[0][1] + p1[i] * a[1][1] + p2[i] * a[2][1]) * e1[i];
+        double q2 = (p0[i] * a[0][2] + p1[i] * a[1][2] + p2[i] * a[2][2]) * e2[i];
+        double total = q0 + q1 + q2;
+        double inv = total > 0 ? 1.0 / total : 0.0;
+        if (total > 0) {
+            p0[i] = q0 * inv;
+            p1[i] = q1 * inv;
+            p2[i] = q2 * inv;
+        }
+
+        int best = p1[i] > p0[i] ? 1 : 0;
+        double best_p = best ? p1[i] : p0[i];
+        if (p2[i] > best_p) {
+            best = 2;
+            best_p = p2[i];
+        }
+        batch->regime[i] = best;
+        batch->confidence[i] = best_p;
+    }
+}
+
+void regime_batch_step(RegimeBatch *batch, const double *price1, const double *price2,
+                       const double *correlation) {
+    if (!batch) return;
+    regime_batch_update_features(batch, price1, price2, correlation);
+    regime_batch_filter(batch, batch->vol_feature, batch->corr_feature);
+}
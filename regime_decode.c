@@ -0,0 +1,399 @@
+#include "sakura_signals.h"
+#include <pthread.h>
+
+// Batch Viterbi decoding and smoothed posteriors of regime feature histories.
+//
+// Sequences are decoded REGIME_DECODE_LANES at a time. A block's features are
+// transposed chunk by chunk into step-major scratch, [step][lane], so each
+// recursion is a fixed-width loop over lanes the compiler can vectorize, the
+// way RegimeBatch lays pairs out. Blocks are handed to threads from a shared
+// counter. Lanes past the end of their sequence are frozen, so sequences of
+// different lengths share a block.
+//
+// Nothing proportional to the history is allocated beyond the output:
+//  - Viterbi back-pointers (2 bits per regime) are packed into the path bytes
+//    and overwritten with the decoded regime during the backtrack
+//  - the forward pass writes the filtered distribution into the posterior
+//    arrays, and the backward pass turns it into the smoothed marginal
+//
+// The model is the one regime_train fits: initial is the distribution at the
+// first step and NaN features are steps without evidence.
+
+#define REGIME_DECODE_LANES 8
+#define REGIME_DECODE_CHUNK 256
+#define REGIME_DECODE_VAR_FLOOR 1e-12
+#define REGIME_DECODE_LOG_2PI 1.8378770664093453
+
+// back-pointers are packed 2 bits per regime into one byte
+#if MAX_REGIMES != 3
+#error "regime_decode.c assumes MAX_REGIMES == 3"
+#endif
+
+typedef struct {
+    const RegimeSequence *sequences;
+    int n_sequences;
+    RegimePath *path;
+    int n_blocks;
+    int *next_block;
+    const RegimeModelParams *params;
+    double log_initial[MAX_REGIMES];
+    double log_transition[MAX_REGIMES][MAX_REGIMES];
+    double log_norm[MAX_REGIMES];
+    double inv_var[MAX_REGIMES][REGIME_N_FEATURES];
+    // REGIME_DECODE_CHUNK steps of one block
+    double *vol;                 // [step][lane]
+    double *corr;
+    double *shift;               // [step][lane], largest log emission of the step
+    double *log_emission;        // [step][regime][lane], minus shift
+    double *emission;            // exp of log_emission
+} RegimeDecodeWorker;
+
+// emissions of steps t0 .. t0 + n of the block starting at sequence `first`
+static void block_emissions(RegimeDecodeWorker *w, int first, const int *len, int t0, int n) {
+    enum { L = REGIME_DECODE_LANES };
+
+    for (int l = 0; l < L; l++) {
+        const RegimeSequence *seq = &w->sequences[first + l < w->n_sequences ? first + l : first];
+        int end = len[l] > t0 ? len[l] - t0 : 0;
+        if (end > n) end = n;
+        for (int c = 0; c < end; c++) {
+            w->vol[c * L + l] = seq->vol_feature[t0 + c];
+            w->corr[c * L + l] = seq->corr_feature[t0 + c];
+        }
+        for (int c = end; c < n; c++) {
+            w->vol[c * L + l] = NAN;
+            w->corr[c * L + l] = NAN;
+        }
+    }
+
+    const RegimeModelParams *p = w->params;
+    for (int c = 0; c < n; c++) {
+        const double *f0 = w->vol + c * L;
+        const double *f1 = w->corr + c * L;
+        double *le = w->log_emission + (size_t)c * MAX_REGIMES * L;
+        double *sh = w->shift + c * L;
+
+        for (int k = 0; k < MAX_REGIMES; k++) {
+            double m0 = p->emission_mean[k][0], iv0 = w->inv_var[k][0];
+            double m1 = p->emission_mean[k][1], iv1 = w->inv_var[k][1];
+            for (int l = 0; l < L; l++) {
+                double d0 = f0[l] - m0;
+                double d1 = f1[l] - m1;
+                le[k * L + l] = w->log_norm[k] - 0.5 * (d0 * d0 * iv0 + d1 * d1 * iv1);
+            }
+        }
+        for (int l = 0; l < L; l++) {
+            double m = le[l] > le[L + l] ? le[l] : le[L + l];
+            m = m > le[2 * L + l] ? m : le[2 * L + l];
+            // NaN features compare false everywhere: equal likelihoods, no shift
+            bool valid = m == m;
+            sh[l] = valid ? m : 0.0;
+            for (int k = 0; k < MAX_REGIMES; k++) le[k * L + l] = valid ? le[k * L + l] - m : 0.0;
+        }
+    }
+    simd_exp_array(w->log_emission, w->emission, n * MAX_REGIMES * L);
+}
+
+// max of the three candidate scores, and which predecessor gave it
+static inline double best_predecessor(double c0, double c1, double c2, int *from) {
+    double m = c1 > c0 ? c1 : c0;
+    int j = c1 > c0 ? 1 : 0;
+    *from = c2 > m ? 2 : j;
+    return c2 > m ? c2 : m;
+}
+
+static void decode_block(RegimeDecodeWorker *w, int block) {
+    enum { L = REGIME_DECODE_LANES };
+    const double (*a)[MAX_REGIMES] = w->params->transition;
+    double (*la)[MAX_REGIMES] = w->log_transition;
+    RegimePath *path = w->path;
+    int first = block * L;
+
+    int len[L];
+    size_t base[L];
+    int n_steps = 0;
+    for (int l = 0; l < L; l++) {
+        int s = first + l;
+        len[l] = s < w->n_sequences ? w->sequences[s].n_steps : 0;
+        base[l] = s < w->n_sequences ? path->offsets[s] : 0;
+        if (len[l] > n_steps) n_steps = len[l];
+    }
+
+    double delta[MAX_REGIMES][L];    // Viterbi scores, minus delta_offset
+    double alpha[MAX_REGIMES][L];    // filtered distribution
+    double delta_offset[L], shift_sum[L], product[L], log_scale[L];
+    for (int l = 0; l < L; l++) {
+        for (int k = 0; k < MAX_REGIMES; k++) delta[k][l] = alpha[k][l] = 0.0;
+        delta_offset[l] = 0.0;
+        shift_sum[l] = 0.0;
+        product[l] = 1.0;
+        log_scale[l] = 0.0;
+    }
+
+    // forward: Viterbi and filtering share the emissions
+    for (int t0 = 0; t0 < n_steps; t0 += REGIME_DECODE_CHUNK) {
+        int n = n_steps - t0 < REGIME_DECODE_CHUNK ? n_steps - t0 : REGIME_DECODE_CHUNK;
+        block_emissions(w, first, len, t0, n);
+
+        for (int c = 0; c < n; c++) {
+            int t = t0 + c;
+            const double *le = w->log_emission + (size_t)c * MAX_REGIMES * L;
+            const double *e = w->emission + (size_t)c * MAX_REGIMES * L;
+            const double *sh = w->shift + c * L;
+            int packed[L];
+
+            if (t == 0) {
+                for (int l = 0; l < L; l++) {
+                    double q[MAX_REGIMES], total = 0.0;
+                    for (int k = 0; k < MAX_REGIMES; k++) {
+                        delta[k][l] = w->log_initial[k] + le[k * L + l];
+                        q[k] = w->params->initial[k] * e[k * L + l];
+                        total += q[k];
+                    }
+                    if (!(total > 0)) total = 1e-300;
+                    for (int k = 0; k < MAX_REGIMES; k++) alpha[k][l] = q[k] / total;
+                    shift_sum[l] = sh[l];
+                    product[l] = total;
+                    packed[l] = 0;
+                }
+            } else {
+                for (int l = 0; l < L; l++) {
+                    double d0 = delta[0][l], d1 = delta[1][l], d2 = delta[2][l];
+                    double a0 = alpha[0][l], a1 = alpha[1][l], a2 = alpha[2][l];
+                    int j0, j1, j2;
+                    double v0 = best_predecessor(d0 + la[0][0], d1 + la[1][0], d2 + la[2][0], &j0) + le[l];
+                    double v1 = best_predecessor(d0 + la[0][1], d1 + la[1][1], d2 + la[2][1], &j1) + le[L + l];
+                    double v2 = best_predecessor(d0 + la[0][2], d1 + la[1][2], d2 + la[2][2], &j2) + le[2 * L + l];
+                    double q0 = (a0 * a[0][0] + a1 * a[1][0] + a2 * a[2][0]) * e[l];
+                    double q1 = (a0 * a[0][1] + a1 * a[1][1] + a2 * a[2][1]) * e[L + l];
+                    double q2 = (a0 * a[0][2] + a1 * a[1][2] + a2 * a[2][2]) * e[2 * L + l];
+
+                    // keep the scores near 0 so ties compare exactly however long the history
+                    double top = v0 > v1 ? v0 : v1;
+                    top = top > v2 ? top : v2;
+                    double total = q0 + q1 + q2;
+                    total = total > 0 ? total : 1e-300;   // every regime ruled out: keep the chain alive
+                    double inv = 1.0 / total;
+
+                    bool active = t < len[l];
+                    delta[0][l] = active ? v0 - top : d0;
+                    delta[1][l] = active ? v1 - top : d1;
+                    delta[2][l] = active ? v2 - top : d2;
+                    alpha[0][l] = active ? q0 * inv : a0;
+                    alpha[1][l] = active ? q1 * inv : a1;
+                    alpha[2][l] = active ? q2 * inv : a2;
+                    delta_offset[l] += active ? top : 0.0;
+                    shift_sum[l] += active ? sh[l] : 0.0;
+                    product[l] *= active ? total : 1.0;
+                    packed[l] = j0 | j1 << 2 | j2 << 4;
+                }
+            }
+
+            for (int l = 0; l < L; l++) {
+                if (t >= len[l]) continue;
+                size_t i = base[l] + t;
+                path->regime[i] = (uint8_t)packed[l];
+                for (int k = 0; k < MAX_REGIMES; k++) path->posterior[k][i] = (float)alpha[k][l];
+                if (product[l] < 1e-200 || product[l] > 1e200) {
+                    log_scale[l] += log(product[l]);
+                    product[l] = 1.0;
+                }
+            }
+        }
+    }
+
+    // backward: beta_{t-1}(j) = sum_k A[j][k] b_t(k) beta_t(k), rescaled each step;
+    // the posterior is alpha_t * beta_t normalized
+    double beta[MAX_REGIMES][L];
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        for (int l = 0; l < L; l++) beta[k][l] = 1.0;
+    }
+    int last_chunk = n_steps > 0 ? (n_steps - 1) / REGIME_DECODE_CHUNK * REGIME_DECODE_CHUNK : 0;
+    for (int t0 = last_chunk; n_steps > 0 && t0 >= 0; t0 -= REGIME_DECODE_CHUNK) {
+        int n = n_steps - t0 < REGIME_DECODE_CHUNK ? n_steps - t0 : REGIME_DECODE_CHUNK;
+        block_emissions(w, first, len, t0, n);
+
+        for (int c = n - 1; c >= 0; c--) {
+            int t = t0 + c;
+            const double *e = w->emission + (size_t)c * MAX_REGIMES * L;
+
+            for (int l = 0; l < L; l++) {
+                if (t >= len[l]) continue;
+                size_t i = base[l] + t;
+                double g[MAX_REGIMES], total = 0.0;
+                for (int k = 0; k < MAX_REGIMES; k++) {
+                    g[k] = path->posterior[k][i] * beta[k][l];
+                    total += g[k];
+                }
+                double inv = total > 0 ? 1.0 / total : 0.0;
+                for (int k = 0; k < MAX_REGIMES; k++) path->posterior[k][i] = (float)(g[k] * inv);
+            }
+
+            for (int l = 0; l < L; l++) {
+                bool active = t < len[l] && t > 0;
+                double w0 = e[l] * beta[0][l], w1 = e[L + l] * beta[1][l], w2 = e[2 * L + l] * beta[2][l];
+                double next[MAX_REGIMES], total = 0.0;
+                for (int j = 0; j < MAX_REGIMES; j++) {
+                    next[j] = a[j][0] * w0 + a[j][1] * w1 + a[j][2] * w2;
+                    total += next[j];
+                }
+                double inv = total > 0 ? 1.0 / total : 1.0;
+                for (int j = 0; j < MAX_REGIMES; j++) beta[j][l] = active ? next[j] * inv : beta[j][l];
+            }
+        }
+    }
+
+    // backtrack, replacing each step's back-pointers with its regime
+    for (int l = 0; l < L; l++) {
+        int s = first + l;
+        if (s >= w->n_sequences) break;
+        path->log_likelihood[s] = shift_sum[l] + log_scale[l] + log(product[l]);
+        path->path_log_prob[s] = 0.0;
+        if (len[l] == 0) continue;
+
+        int state = 0;
+        for (int k = 1; k < MAX_REGIMES; k++) {
+            if (delta[k][l] > delta[state][l]) state = k;
+        }
+        path->path_log_prob[s] = delta[state][l] + delta_offset[l] + shift_sum[l];
+
+        uint8_t *r = path->regime + base[l];
+        for (int t = len[l] - 1; t > 0; t--) {
+            int packed = r[t];
+            r[t] = (uint8_t)state;
+            state = (packed >> (2 * state)) & 3;
+        }
+        r[0] = (uint8_t)state;
+    }
+}
+
+static void* regime_decode_worker_main(void *arg) {
+    RegimeDecodeWorker *w = arg;
+    for (;;) {
+        int i = __atomic_fetch_add(w->next_block, 1, __ATOMIC_RELAXED);
+        if (i >= w->n_blocks) break;
+        decode_block(w, i);
+    }
+    return NULL;
+}
+
+static RegimePath* create_regime_path(const RegimeSequence *sequences, int n_sequences) {
+    RegimePath *path = calloc(1, sizeof(RegimePath));
+    if (!path) return NULL;
+
+    path->n_sequences = n_sequences;
+    path->offsets = malloc((n_sequences + 1) * sizeof(size_t));
+    path->log_likelihood = calloc(n_sequences, sizeof(double));
+    path->path_log_prob = calloc(n_sequences, sizeof(double));
+    if (!path->offsets || !path->log_likelihood || !path->path_log_prob) {
+        destroy_regime_path(path);
+        return NULL;
+    }
+
+    path->offsets[0] = 0;
+    for (int i = 0; i < n_sequences; i++) {
+        path->offsets[i + 1] = path->offsets[i] + (size_t)sequences[i].n_steps;
+    }
+    size_t total = path->offsets[n_sequences];
+
+    // one spare element so an empty batch still allocates
+    bool ok = (path->regime = malloc(total + 1)) != NULL;
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        ok = ok && (path->posterior[k] = malloc((total + 1) * sizeof(float))) != NULL;
+    }
+    if (!ok) {
+        destroy_regime_path(path);
+        return NULL;
+    }
+    return path;
+}
+
+void destroy_regime_path(RegimePath *path) {
+    if (path) {
+        free(path->offsets);
+        free(path->regime);
+        for (int k = 0; k < MAX_REGIMES; k++) free(path->posterior[k]);
+        free(path->log_likelihood);
+        free(path->path_log_prob);
+        free(path);
+    }
+}
+
+RegimePath* regime_decode(const RegimeModelParams *params, const RegimeSequence *sequences, int n_sequences,
+                          int n_threads) {
+    if (!params || !sequences || n_sequences <= 0) return NULL;
+    for (int i = 0; i < n_sequences; i++) {
+        const RegimeSequence *seq = &sequences[i];
+        if (seq->n_steps < 0 || (seq->n_steps > 0 && (!seq->vol_feature || !seq->corr_feature))) return NULL;
+    }
+
+    RegimePath *path = create_regime_path(sequences, n_sequences);
+    if (!path) return NULL;
+
+    RegimeDecodeWorker proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.sequences = sequences;
+    proto.n_sequences = n_sequences;
+    proto.path = path;
+    proto.n_blocks = (n_sequences + REGIME_DECODE_LANES - 1) / REGIME_DECODE_LANES;
+    proto.params = params;
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        proto.log_initial[k] = log(params->initial[k]);
+        for (int j = 0; j < MAX_REGIMES; j++) proto.log_transition[k][j] = log(params->transition[k][j]);
+
+        double log_det = 0.0;
+        for (int f = 0; f < REGIME_N_FEATURES; f++) {
+            double var = params->emission_var[k][f] > REGIME_DECODE_VAR_FLOOR ? params->emission_var[k][f]
+                                                                               : REGIME_DECODE_VAR_FLOOR;
+            proto.inv_var[k][f] = 1.0 / var;
+            log_det += REGIME_DECODE_LOG_2PI + log(var);
+        }
+        proto.log_norm[k] = -0.5 * log_det;
+    }
+
+    if (n_threads < 1) n_threads = 1;
+    if (n_threads > proto.n_blocks) n_threads = proto.n_blocks;
+
+    RegimeDecodeWorker *workers = calloc(n_threads, sizeof(RegimeDecodeWorker));
+    pthread_t *threads = malloc(n_threads * sizeof(pthread_t));
+    size_t lane_steps = (size_t)REGIME_DECODE_CHUNK * REGIME_DECODE_LANES;
+    size_t scratch = lane_steps * (3 + 2 * MAX_REGIMES);
+    bool ok = workers && threads;
+
+    int next_block = 0;
+    for (int t = 0; ok && t < n_threads; t++) {
+        workers[t] = proto;
+        workers[t].next_block = &next_block;
+        workers[t].vol = malloc(scratch * sizeof(double));
+        ok = workers[t].vol != NULL;
+        if (ok) {
+            workers[t].corr = workers[t].vol + lane_steps;
+            workers[t].shift = workers[t].corr + lane_steps;
+            workers[t].log_emission = workers[t].shift + lane_steps;
+            workers[t].emission = workers[t].log_emission + lane_steps * MAX_REGIMES;
+        }
+    }
+
+    if (ok) {
+        // the calling thread works too; blocks are claimed from a shared counter,
+        // so threads that fail to start just leave more of them to the others
+        int n_started = 1;
+        while (n_started < n_threads &&
+               pthread_create(&threads[n_started], NULL, regime_decode_worker_main, &workers[n_started]) == 0) {
+            n_started++;
+        }
+        regime_decode_worker_main(&workers[0]);
+        for (int t = 1; t < n_started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    for (int t = 0; workers && t < n_threads; t++) free(workers[t].vol);
+    free(workers);
+    free(threads);
+    if (!ok) {
+        destroy_regime_path(path);
+        return NULL;
+    }
+    return path;
+}
@@ -19,6 +19,9 @@ RegimeDetector* create_regime_detector(int volatility_window) {
     detector->current_regime = 0; // normal
     detector->regime_confidence = 1.0;
     detector->last_regime_change = 0;
+    detector->last_price1 = 0.0;
+    detector->last_price2 = 0.0;
+    detector->model = NULL;
     
     // init regime probs
     detector->regime_probabilities[0] = 0.8;  // normal
@@ -44,8 +47,38 @@ RegimeDetector* create_regime_detector(int volatility_window) {
     return detector;
 }
 
+// detector driven by a trained HMM instead of the threshold rules
+RegimeDetector* create_regime_detector_with_model(int volatility_window, const RegimeModelParams *params) {
+    RegimeDetector *detector = create_regime_detector(volatility_window);
+    if (detector && !regime_detector_set_model(detector, params)) {
+        destroy_regime_detector(detector);
+        return NULL;
+    }
+    return detector;
+}
+
+// restarts the filter from the model's initial distribution
+bool regime_detector_set_model(RegimeDetector *detector, const RegimeModelParams *params) {
+    if (!detector || !params) return false;
+    
+    RegimeBatch *model = create_regime_batch(1, params);
+    if (!model) return false;
+    
+    destroy_regime_batch(detector->model);
+    detector->model = model;
+    memcpy(detector->transition_matrix, params->transition, sizeof(detector->transition_matrix));
+    for (int i = 0; i < MAX_REGIMES; i++) {
+        detector->regime_probabilities[i] = model->prob[i][0];
+    }
+    detector->current_regime = model->regime[0];
+    detector->regime_confidence = model->confidence[0];
+    detector->last_regime_change = 0;
+    return true;
+}
+
 void destroy_regime_detector(RegimeDetector *detector) {
     if (detector) {
+        destroy_regime_batch(detector->model);
         destroy_circular_buffer(detector->volatility_buffer);
         destroy_circular_buffer(detector->correlation_buffer);
         free(detector);
@@ -56,18 +89,33 @@ void update_regime(RegimeDetector *detector, double price1, double price2, doubl
     if (!detector) return;
     
     // calc log returns for volatility
-    static double last_price1 = 0, last_price2 = 0;
-    if (last_price1 > 0 && last_price2 > 0) {
-        double ret1 = log(price1 / last_price1);
-        double ret2 = log(price2 / last_price2);
+    if (detector->last_price1 > 0 && detector->last_price2 > 0) {
+        double ret1 = log(price1 / detector->last_price1);
+        double ret2 = log(price2 / detector->last_price2);
         double combined_vol = sqrt(ret1*ret1 + ret2*ret2);
         
         cb_push(detector->volatility_buffer, combined_vol);
     }
     
     cb_push(detector->correlation_buffer, correlation);
-    last_price1 = price1;
-    last_price2 = price2;
+    detector->last_price1 = price1;
+    detector->last_price2 = price2;
+    
+    if (detector->model) {
+        RegimeBatch *model = detector->model;
+        regime_batch_step(model, &price1, &price2, &correlation);
+        for (int i = 0; i < MAX_REGIMES; i++) {
+            detector->regime_probabilities[i] = model->prob[i][0];
+        }
+        if (model->regime[0] != detector->current_regime) {
+            detector->last_regime_change = 0;
+            detector->current_regime = model->regime[0];
+        } else {
+            detector->last_regime_change++;
+        }
+        detector->regime_confidence = model->confidence[0];
+        return;
+    }
     
     if (cb_size(detector->volatility_buffer) < 10) return;
     
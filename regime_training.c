@@ -0,0 +1,553 @@
+#include "sakura_signals.h"
+#include <pthread.h>
+
+// Offline Baum-Welch fit of RegimeModelParams to feature histories.
+//
+// Every sequence is cut into chunks of chunk_steps, and each (sequence, chunk)
+// is an independent E-step work unit: a scaled forward-backward pass that sums
+// the expected state occupancies, transitions and feature moments. Units are
+// handed to threads from a shared counter, so long histories spread over all
+// cores through their chunks and many pairs through their sequences. A chunk
+// starts from the filtered distribution the previous iteration reached at its
+// boundary, so only the one transition across each boundary is left out of the
+// statistics. Per-unit statistics are reduced in unit order, which makes the
+// fit independent of the thread count.
+//
+// Regimes are relabelled by ascending mean volatility feature at the end, so
+// 0/1/2 keep meaning normal/stress/crisis.
+
+#define REGIME_TRAIN_VAR_FLOOR 1e-8
+#define REGIME_TRAIN_LOG_2PI 1.8378770664093453
+
+// the forward and backward recursions are written out for three regimes
+#if MAX_REGIMES != 3
+#error "regime_training.c assumes MAX_REGIMES == 3"
+#endif
+
+#define REGIME_MODEL_MAGIC "SAKRGM01"
+#define REGIME_MODEL_VERSION 1
+
+typedef struct {
+    int sequence;
+    int start;
+    int length;
+    double prior[MAX_REGIMES];   // predicted distribution at the first step
+} RegimeUnit;
+
+typedef struct {
+    double occupancy[MAX_REGIMES];                        // sum of gamma
+    double transitions[MAX_REGIMES][MAX_REGIMES];         // sum of xi
+    double weight[MAX_REGIMES][REGIME_N_FEATURES];        // sum of gamma where the feature is present
+    double sum[MAX_REGIMES][REGIME_N_FEATURES];
+    double sumsq[MAX_REGIMES][REGIME_N_FEATURES];
+    double first[MAX_REGIMES];                            // gamma at the sequence's first step
+    double last_filtered[MAX_REGIMES];                    // alpha at the chunk's last step
+    double log_likelihood;
+} RegimeUnitStats;
+
+typedef struct {
+    const RegimeSequence *sequences;
+    const RegimeUnit *units;
+    RegimeUnitStats *stats;
+    int n_units;
+    int *next_unit;
+    const RegimeModelParams *params;
+    double log_norm[MAX_REGIMES];
+    double inv_var[MAX_REGIMES][REGIME_N_FEATURES];
+    double *alpha;               // chunk_steps x MAX_REGIMES scratch
+    double *emission;
+    double *scale;
+} RegimeTrainWorker;
+
+void regime_training_default_config(RegimeTrainingConfig *config) {
+    if (!config) return;
+    config->max_iterations = 50;
+    config->tolerance = 1e-6;
+    config->n_threads = 4;
+    config->chunk_steps = 16384;
+}
+
+// features as a detector with these params would see them, one step per quote
+bool regime_extract_features(const RegimeModelParams *params, const double *price1, const double *price2,
+                             const double *correlation, int n_steps, double *vol_feature, double *corr_feature) {
+    if (!price1 || !price2 || !vol_feature || !corr_feature || n_steps < 0) return false;
+
+    RegimeBatch *batch = create_regime_batch(1, params);
+    if (!batch) return false;
+
+    for (int t = 0; t < n_steps; t++) {
+        regime_batch_update_features(batch, price1 + t, price2 + t, correlation ? correlation + t : NULL);
+        vol_feature[t] = batch->vol_feature[0];
+        corr_feature[t] = batch->corr_feature[0];
+    }
+
+    destroy_regime_batch(batch);
+    return true;
+}
+
+typedef struct {
+    PairTracker *tracker;
+    RegimeBatch *batch;
+    double *vol_feature;
+    double *corr_feature;
+    int n_steps;
+    int capacity;
+    bool failed;
+} RegimeFeatureReplay;
+
+static void regime_feature_step(void *ctx, const PairSignalCompact *signal) {
+    (void)signal;
+    RegimeFeatureReplay *r = ctx;
+    PairTracker *t = r->tracker;
+    if (r->failed) return;
+
+    double p1 = cb_get(t->price_buffer1, cb_size(t->price_buffer1) - 1);
+    double p2 = cb_get(t->price_buffer2, cb_size(t->price_buffer2) - 1);
+    regime_batch_update_features(r->batch, &p1, &p2, &t->correlation);
+
+    if (r->n_steps == r->capacity) {
+        if (r->capacity > INT32_MAX / 2) {
+            r->failed = true;
+            return;
+        }
+        int capacity = r->capacity ? r->capacity * 2 : 65536;
+        double *vol = realloc(r->vol_feature, capacity * sizeof(double));
+        if (vol) r->vol_feature = vol;
+        double *corr = realloc(r->corr_feature, capacity * sizeof(double));
+        if (corr) r->corr_feature = corr;
+        if (!vol || !corr) {
+            r->failed = true;
+            return;
+        }
+        r->capacity = capacity;
+    }
+    r->vol_feature[r->n_steps] = r->batch->vol_feature[0];
+    r->corr_feature[r->n_steps] = r->batch->corr_feature[0];
+    r->n_steps++;
+}
+
+// Features of one pair of a tick file, one step per replayed quote: the step axis
+// of replay_pair_from_tick_file and the backtester. `window` sizes the rolling
+// correlation. Returns the step count and hands the arrays to the caller, or -1.
+int regime_features_from_tick_file(const TickFile *file, int symbol1, int symbol2, int window,
+                                   const RegimeModelParams *params, double **vol_feature, double **corr_feature) {
+    if (!file || !vol_feature || !corr_feature) return -1;
+    if (symbol1 < 0 || symbol2 < 0 || symbol1 >= file->n_symbols || symbol2 >= file->n_symbols) return -1;
+
+    RegimeFeatureReplay r;
+    memset(&r, 0, sizeof(r));
+    r.tracker = create_enhanced_pair_tracker(window, false);
+    r.batch = create_regime_batch(1, params);
+    r.failed = !r.tracker || !r.batch;
+
+    if (!r.failed) {
+        // minimal variant: the rolling correlation is all the features need
+        r.tracker->dynamic_entry_threshold = 2.0;
+        r.tracker->dynamic_exit_threshold = 0.5;
+        r.tracker->current_hedge_ratio = 1.0;
+        select_signal_variant(r.tracker);
+        replay_pair_from_tick_file_compact(file, r.tracker, symbol1, symbol2, INT64_MIN, INT64_MAX,
+                                           regime_feature_step, &r);
+    }
+    destroy_pair_tracker(r.tracker);
+    destroy_regime_batch(r.batch);
+
+    if (r.failed) {
+        free(r.vol_feature);
+        free(r.corr_feature);
+        return -1;
+    }
+    *vol_feature = r.vol_feature;
+    *corr_feature = r.corr_feature;
+    return r.n_steps;
+}
+
+// scaled forward-backward over one chunk, accumulating into *stats
+static void run_unit(RegimeTrainWorker *w, const RegimeUnit *unit, RegimeUnitStats *stats) {
+    const RegimeSequence *seq = &w->sequences[unit->sequence];
+    const double (*a)[MAX_REGIMES] = w->params->transition;
+    const double *f0 = seq->vol_feature + unit->start;
+    const double *f1 = seq->corr_feature + unit->start;
+    int n = unit->length;
+    double *alpha = w->alpha, *b = w->emission, *c = w->scale;
+
+    memset(stats, 0, sizeof(*stats));
+
+    // shifted log emissions for the whole chunk, then one vectorized exp
+    double log_shift = 0.0;
+    for (int t = 0; t < n; t++) {
+        double *bt = b + (size_t)t * MAX_REGIMES;
+        if (f0[t] != f0[t] || f1[t] != f1[t]) {
+            for (int k = 0; k < MAX_REGIMES; k++) bt[k] = 0.0;
+            continue;
+        }
+        double m = -INFINITY;
+        for (int k = 0; k < MAX_REGIMES; k++) {
+            double d0 = f0[t] - w->params->emission_mean[k][0];
+            double d1 = f1[t] - w->params->emission_mean[k][1];
+            bt[k] = w->log_norm[k] - 0.5 * (d0 * d0 * w->inv_var[k][0] + d1 * d1 * w->inv_var[k][1]);
+            if (bt[k] > m) m = bt[k];
+        }
+        for (int k = 0; k < MAX_REGIMES; k++) bt[k] -= m;
+        log_shift += m;
+    }
+    simd_exp_array(b, b, n * MAX_REGIMES);
+
+    // forward; log c_t is accumulated through a product renormalized only when
+    // it drifts far from 1
+    double product = 1.0, log_likelihood = log_shift;
+    for (int t = 0; t < n; t++) {
+        const double *bt = b + (size_t)t * MAX_REGIMES;
+        double *at = alpha + (size_t)t * MAX_REGIMES;
+        double total = 0.0;
+        for (int k = 0; k < MAX_REGIMES; k++) {
+            double pred;
+            if (t == 0) {
+                pred = unit->prior[k];
+            } else {
+                const double *ap = at - MAX_REGIMES;
+                pred = ap[0] * a[0][k] + ap[1] * a[1][k] + ap[2] * a[2][k];
+            }
+            at[k] = pred * bt[k];
+            total += at[k];
+        }
+        if (!(total > 0)) total = 1e-300;   // every regime ruled out: keep the chain alive
+        c[t] = total;
+        double inv = 1.0 / total;
+        for (int k = 0; k < MAX_REGIMES; k++) at[k] *= inv;
+
+        product *= total;
+        if (product < 1e-200 || product > 1e200) {
+            log_likelihood += log(product);
+            product = 1.0;
+        }
+    }
+    log_likelihood += log(product);
+    stats->log_likelihood = log_likelihood;
+    memcpy(stats->last_filtered, alpha + (size_t)(n - 1) * MAX_REGIMES, sizeof(stats->last_filtered));
+
+    // backward, folding gamma and xi into the sums as it goes
+    double beta[MAX_REGIMES] = {1.0, 1.0, 1.0};
+    for (int t = n - 1; t >= 0; t--) {
+        const double *at = alpha + (size_t)t * MAX_REGIMES;
+        bool present0 = f0[t] == f0[t] && f1[t] == f1[t];
+
+        for (int k = 0; k < MAX_REGIMES; k++) {
+            double gamma = at[k] * beta[k];
+            stats->occupancy[k] += gamma;
+            if (present0) {
+                stats->weight[k][0] += gamma;
+                stats->weight[k][1] += gamma;
+                stats->sum[k][0] += gamma * f0[t];
+                stats->sum[k][1] += gamma * f1[t];
+                stats->sumsq[k][0] += gamma * f0[t] * f0[t];
+                stats->sumsq[k][1] += gamma * f1[t] * f1[t];
+            }
+            if (t == 0 && unit->start == 0) stats->first[k] = gamma;
+        }
+        if (t == 0) break;
+
+        // beta_{t-1}(j) = sum_k A[j][k] b_t(k) beta_t(k) / c_t, and
+        // xi_{t-1}(j, k) = alpha_{t-1}(j) A[j][k] b_t(k) beta_t(k) / c_t
+        const double *bt = b + (size_t)t * MAX_REGIMES;
+        const double *ap = at - MAX_REGIMES;
+        double inv_c = 1.0 / c[t];
+        double weighted[MAX_REGIMES];
+        for (int k = 0; k < MAX_REGIMES; k++) weighted[k] = bt[k] * beta[k] * inv_c;
+        for (int j = 0; j < MAX_REGIMES; j++) {
+            double next = 0.0;
+            for (int k = 0; k < MAX_REGIMES; k++) {
+                double term = a[j][k] * weighted[k];
+                stats->transitions[j][k] += ap[j] * term;
+                next += term;
+            }
+            beta[j] = next;
+        }
+    }
+}
+
+static void* regime_train_worker_main(void *arg) {
+    RegimeTrainWorker *w = arg;
+    for (;;) {
+        int i = __atomic_fetch_add(w->next_unit, 1, __ATOMIC_RELAXED);
+        if (i >= w->n_units) break;
+        run_unit(w, &w->units[i], &w->stats[i]);
+    }
+    return NULL;
+}
+
+// sorts regimes by mean volatility feature, permuting every parameter with them
+static void relabel_by_volatility(RegimeModelParams *params) {
+    int order[MAX_REGIMES] = {0, 1, 2};
+    for (int i = 1; i < MAX_REGIMES; i++) {
+        for (int j = i; j > 0 && params->emission_mean[order[j]][0] < params->emission_mean[order[j - 1]][0]; j--) {
+            int tmp = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+
+    RegimeModelParams sorted = *params;
+    for (int i = 0; i < MAX_REGIMES; i++) {
+        sorted.initial[i] = params->initial[order[i]];
+        for (int j = 0; j < MAX_REGIMES; j++) sorted.transition[i][j] = params->transition[order[i]][order[j]];
+        for (int f = 0; f < REGIME_N_FEATURES; f++) {
+            sorted.emission_mean[i][f] = params->emission_mean[order[i]][f];
+            sorted.emission_var[i][f] = params->emission_var[order[i]][f];
+        }
+    }
+    *params = sorted;
+}
+
+// params holds the starting point on entry and the fit on return
+bool regime_train(const RegimeSequence *sequences, int n_sequences, const RegimeTrainingConfig *config,
+                  RegimeModelParams *params, RegimeTrainingResult *result) {
+    if (!sequences || n_sequences <= 0 || !params) return false;
+
+    RegimeTrainingConfig cfg;
+    if (config) {
+        cfg = *config;
+    } else {
+        regime_training_default_config(&cfg);
+    }
+    if (cfg.chunk_steps < 2) cfg.chunk_steps = 2;
+    if (cfg.n_threads < 1) cfg.n_threads = 1;
+    if (cfg.max_iterations < 1) cfg.max_iterations = 1;
+
+    int n_units = 0;
+    for (int s = 0; s < n_sequences; s++) {
+        if (sequences[s].n_steps > 0 && (!sequences[s].vol_feature || !sequences[s].corr_feature)) return false;
+        if (sequences[s].n_steps > 0) n_units += (sequences[s].n_steps + cfg.chunk_steps - 1) / cfg.chunk_steps;
+    }
+    if (n_units == 0) return false;
+    if (cfg.n_threads > n_units) cfg.n_threads = n_units;
+
+    RegimeUnit *units = malloc(n_units * sizeof(RegimeUnit));
+    RegimeUnitStats *stats = malloc(n_units * sizeof(RegimeUnitStats));
+    RegimeTrainWorker *workers = calloc(cfg.n_threads, sizeof(RegimeTrainWorker));
+    pthread_t *threads = malloc(cfg.n_threads * sizeof(pthread_t));
+    bool ok = units && stats && workers && threads;
+
+    for (int t = 0; ok && t < cfg.n_threads; t++) {
+        size_t cells = (size_t)cfg.chunk_steps * MAX_REGIMES;
+        workers[t].alpha = malloc(cells * sizeof(double));
+        workers[t].emission = malloc(cells * sizeof(double));
+        workers[t].scale = malloc(cfg.chunk_steps * sizeof(double));
+        ok = workers[t].alpha && workers[t].emission && workers[t].scale;
+    }
+
+    if (ok) {
+        int u = 0;
+        for (int s = 0; s < n_sequences; s++) {
+            for (int start = 0; start < sequences[s].n_steps; start += cfg.chunk_steps) {
+                units[u].sequence = s;
+                units[u].start = start;
+                units[u].length = sequences[s].n_steps - start < cfg.chunk_steps ? sequences[s].n_steps - start
+                                                                                 : cfg.chunk_steps;
+                memcpy(units[u].prior, params->initial, sizeof(units[u].prior));
+                u++;
+            }
+        }
+    }
+
+    double previous = -INFINITY, log_likelihood = -INFINITY;
+    int iteration = 0;
+    bool converged = false;
+
+    while (ok && iteration < cfg.max_iterations) {
+        iteration++;
+
+        // ---- E-step
+        int next_unit = 0;
+        for (int t = 0; t < cfg.n_threads; t++) {
+            RegimeTrainWorker *w = &workers[t];
+            w->sequences = sequences;
+            w->units = units;
+            w->stats = stats;
+            w->n_units = n_units;
+            w->next_unit = &next_unit;
+            w->params = params;
+            for (int k = 0; k < MAX_REGIMES; k++) {
+                double log_det = 0.0;
+                for (int f = 0; f < REGIME_N_FEATURES; f++) {
+                    double var = params->emission_var[k][f] > REGIME_TRAIN_VAR_FLOOR ? params->emission_var[k][f]
+                                                                                      : REGIME_TRAIN_VAR_FLOOR;
+                    w->inv_var[k][f] = 1.0 / var;
+                    log_det += REGIME_TRAIN_LOG_2PI + log(var);
+                }
+                w->log_norm[k] = -0.5 * log_det;
+            }
+        }
+        // units are claimed from a shared counter, so threads that fail to start
+        // just leave more of them to the others
+        int n_started = 1;
+        while (n_started < cfg.n_threads &&
+               pthread_create(&threads[n_started], NULL, regime_train_worker_main, &workers[n_started]) == 0) {
+            n_started++;
+        }
+        regime_train_worker_main(&workers[0]);
+        for (int t = 1; t < n_started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+
+        RegimeUnitStats total;
+        memset(&total, 0, sizeof(total));
+        int n_first = 0;
+        for (int i = 0; i < n_units; i++) {
+            const RegimeUnitStats *st = &stats[i];
+            total.log_likelihood += st->log_likelihood;
+            for (int k = 0; k < MAX_REGIMES; k++) {
+                total.occupancy[k] += st->occupancy[k];
+                total.first[k] += st->first[k];
+                for (int j = 0; j < MAX_REGIMES; j++) total.transitions[k][j] += st->transitions[k][j];
+                for (int f = 0; f < REGIME_N_FEATURES; f++) {
+                    total.weight[k][f] += st->weight[k][f];
+                    total.sum[k][f] += st->sum[k][f];
+                    total.sumsq[k][f] += st->sumsq[k][f];
+                }
+            }
+            if (units[i].start == 0) n_first++;
+        }
+        log_likelihood = total.log_likelihood;
+
+        // ---- M-step
+        for (int k = 0; k < MAX_REGIMES; k++) {
+            params->initial[k] = total.first[k] / n_first;
+
+            double row = 0.0;
+            for (int j = 0; j < MAX_REGIMES; j++) row += total.transitions[k][j];
+            if (row > 0) {
+                for (int j = 0; j < MAX_REGIMES; j++) params->transition[k][j] = total.transitions[k][j] / row;
+            }
+
+            for (int f = 0; f < REGIME_N_FEATURES; f++) {
+                double weight = total.weight[k][f];
+                if (weight <= 0) continue;   // regime never visited: keep its emission
+                double mean = total.sum[k][f] / weight;
+                double var = total.sumsq[k][f] / weight - mean * mean;
+                params->emission_mean[k][f] = mean;
+                params->emission_var[k][f] = var > REGIME_TRAIN_VAR_FLOOR ? var : REGIME_TRAIN_VAR_FLOOR;
+            }
+        }
+
+        // each chunk restarts from where the previous one's filter ended
+        for (int i = 1; i < n_units; i++) {
+            if (units[i].start == 0) continue;
+            const double *end = stats[i - 1].last_filtered;
+            for (int k = 0; k < MAX_REGIMES; k++) {
+                units[i].prior[k] = end[0] * params->transition[0][k] + end[1] * params->transition[1][k] +
+                                    end[2] * params->transition[2][k];
+            }
+        }
+        for (int i = 0; i < n_units; i++) {
+            if (units[i].start == 0) memcpy(units[i].prior, params->initial, sizeof(units[i].prior));
+        }
+
+        if (fabs(log_likelihood - previous) <= cfg.tolerance * fabs(log_likelihood)) {
+            converged = true;
+            break;
+        }
+        previous = log_likelihood;
+    }
+
+    if (ok) {
+        relabel_by_volatility(params);
+        if (result) {
+            result->log_likelihood = log_likelihood;
+            result->iterations = iteration;
+            result->converged = converged;
+        }
+    }
+
+    if (workers) {
+        for (int t = 0; t < cfg.n_threads; t++) {
+            free(workers[t].alpha);
+            free(workers[t].emission);
+            free(workers[t].scale);
+        }
+    }
+    free(units);
+    free(stats);
+    free(workers);
+    free(threads);
+    return ok;
+}
+
+// ---- parameter files ---------------------------------------------------------
+//
+//   [RegimeModelFileHeader]  then initial[K], transition[K][K], emission_mean[K][F],
+//                            emission_var[K][F] as native doubles
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t n_regimes;
+    uint32_t n_features;
+    int32_t short_span;
+    int32_t long_span;
+    uint32_t reserved;
+} RegimeModelFileHeader;
+
+bool regime_model_save(const RegimeModelParams *params, const char *path) {
+    if (!params || !path) return false;
+
+    // written beside the target and renamed over it, so a reader never sees a partial model
+    size_t path_len = strlen(path);
+    char *tmp_path = malloc(path_len + 5);
+    if (!tmp_path) return false;
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        free(tmp_path);
+        return false;
+    }
+
+    RegimeModelFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, REGIME_MODEL_MAGIC, 8);
+    header.version = REGIME_MODEL_VERSION;
+    header.n_regimes = MAX_REGIMES;
+    header.n_features = REGIME_N_FEATURES;
+    header.short_span = params->short_span;
+    header.long_span = params->long_span;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(params->initial, sizeof(params->initial), 1, fp) == 1 &&
+              fwrite(params->transition, sizeof(params->transition), 1, fp) == 1 &&
+              fwrite(params->emission_mean, sizeof(params->emission_mean), 1, fp) == 1 &&
+              fwrite(params->emission_var, sizeof(params->emission_var), 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok) remove(tmp_path);
+
+    free(tmp_path);
+    return ok;
+}
+
+bool regime_model_load(const char *path, RegimeModelParams *params) {
+    if (!path || !params) return false;
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+
+    RegimeModelFileHeader header;
+    RegimeModelParams loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+              memcmp(header.magic, REGIME_MODEL_MAGIC, 8) == 0 && header.version == REGIME_MODEL_VERSION &&
+              header.n_regimes == MAX_REGIMES && header.n_features == REGIME_N_FEATURES &&
+              header.short_span > 0 && header.long_span >= header.short_span &&
+              fread(loaded.initial, sizeof(loaded.initial), 1, fp) == 1 &&
+              fread(loaded.transition, sizeof(loaded.transition), 1, fp) == 1 &&
+              fread(loaded.emission_mean, sizeof(loaded.emission_mean), 1, fp) == 1 &&
+              fread(loaded.emission_var, sizeof(loaded.emission_var), 1, fp) == 1;
+    fclose(fp);
+    if (!ok) return false;
+
+    loaded.short_span = header.short_span;
+    loaded.long_span = header.long_span;
+    *params = loaded;
+    return true;
+}
@@ -6,10 +6,12 @@ RiskManager* create_risk_manager(int returns_window, double target_vol) {
     
     manager->returns_buffer = create_circular_buffer(returns_window);
     manager->volatility_buffer = create_circular_buffer(returns_window);
+    manager->drawdown = create_drawdown_window(returns_window);
     
-    if (!manager->returns_buffer || !manager->volatility_buffer) {
+    if (!manager->returns_buffer || !manager->volatility_buffer || !manager->drawdown) {
         destroy_circular_buffer(manager->returns_buffer);
         destroy_circular_buffer(manager->volatility_buffer);
+        destroy_drawdown_window(manager->drawdown);
         free(manager);
         return NULL;
     }
@@ -25,6 +27,11 @@ RiskManager* create_risk_manager(int returns_window, double target_vol) {
     manager->sharpe_ratio = 0.0;
     manager->max_drawdown = 0.0;
     manager->volatility_window = returns_window;
+    manager->smoothed_volatility = 0.0;
+    manager->returns_sum = 0.0;
+    manager->returns_sumsq = 0.0;
+    manager->volatility_sum = 0.0;
+    manager->pushes = 0;
     
     return manager;
 }
@@ -33,10 +40,55 @@ void destroy_risk_manager(RiskManager *manager) {
     if (manager) {
         destroy_circular_buffer(manager->returns_buffer);
         destroy_circular_buffer(manager->volatility_buffer);
+        destroy_drawdown_window(manager->drawdown);
         free(manager);
     }
 }
 
+// Window state behind the O(1) updates: sums over returns_buffer and
+// volatility_buffer, and the drawdown queue over returns_buffer. Sliding sums
+// carry rounding forward, so they are recomputed exactly every window's worth of
+// pushes; the drawdown queue is exact by construction.
+
+#define RISK_MIN_REBUILD 64
+
+void risk_manager_rebuild(RiskManager *manager) {
+    if (!manager) return;
+    
+    manager->returns_sum = 0.0;
+    manager->returns_sumsq = 0.0;
+    drawdown_window_clear(manager->drawdown);
+    for (int i = 0; i < cb_size(manager->returns_buffer); i++) {
+        double r = cb_get(manager->returns_buffer, i);
+        manager->returns_sum += r;
+        manager->returns_sumsq += r * r;
+        drawdown_window_push(manager->drawdown, r);
+    }
+    
+    manager->volatility_sum = 0.0;
+    for (int i = 0; i < cb_size(manager->volatility_buffer); i++) {
+        manager->volatility_sum += cb_get(manager->volatility_buffer, i);
+    }
+    manager->pushes = 0;
+}
+
+// every return goes through here so the window sums stay in step
+static void push_return(RiskManager *manager, double trade_return) {
+    CircularBuffer *cb = manager->returns_buffer;
+    if (cb_size(cb) == cb->capacity) {
+        double oldest = cb_get(cb, 0);
+        manager->returns_sum -= oldest;
+        manager->returns_sumsq -= oldest * oldest;
+    }
+    cb_push(cb, trade_return);
+    manager->returns_sum += trade_return;
+    manager->returns_sumsq += trade_return * trade_return;
+    drawdown_window_push(manager->drawdown, trade_return);
+    
+    int rebuild_every = cb->capacity > RISK_MIN_REBUILD ? cb->capacity : RISK_MIN_REBUILD;
+    if (++manager->pushes >= rebuild_every) risk_manager_rebuild(manager);
+}
+
 double calculate_volatility_target_size(RiskManager *manager, double signal_strength, double account_size) {
     if (!manager || account_size <= 0) return 0.0;
     
@@ -84,26 +136,29 @@ double calculate_volatility_target_size(RiskManager *manager, double signal_stre
 void update_volatility_estimate(RiskManager *manager, double trade_return) {
     if (!manager) return;
     
-    cb_push(manager->returns_buffer, trade_return);
-    
     // calc squared return for volatility estimation
     double squared_return = trade_return * trade_return;
+    if (cb_size(manager->volatility_buffer) == manager->volatility_buffer->capacity) {
+        manager->volatility_sum -= cb_get(manager->volatility_buffer, 0);
+    }
     cb_push(manager->volatility_buffer, squared_return);
+    manager->volatility_sum += squared_return;
+    push_return(manager, trade_return); // also rebuilds volatility_sum on schedule
     
     int size = cb_size(manager->volatility_buffer);
     if (size < 5) return;
     
     // calc realized volatility using squared returns
-    double variance = rolling_mean(manager->volatility_buffer);
+    double variance = manager->volatility_sum / size;
+    if (variance < 0.0) variance = 0.0;
     manager->current_volatility = sqrt(variance * 252); // annualized vol
     
     // apply exponential decay for more responsive estimates
-    static double prev_vol = 0.0;
-    if (prev_vol > 0) {
+    if (manager->smoothed_volatility > 0) {
         double decay_factor = 0.94; // daily decay
-        manager->current_volatility = decay_factor * prev_vol + (1 - decay_factor) * manager->current_volatility;
+        manager->current_volatility = decay_factor * manager->smoothed_volatility + (1 - decay_factor) * manager->current_volatility;
     }
-    prev_vol = manager->current_volatility;
+    manager->smoothed_volatility = manager->current_volatility;
 }
 
 double calculate_regime_adjusted_target_vol(RiskManager *manager, int regime) {
@@ -126,42 +181,111 @@ double calculate_regime_adjusted_target_vol(RiskManager *manager, int regime) {
 void update_portfolio_risk(RiskManager *manager, double trade_return) {
     if (!manager) return;
     
-    cb_push(manager->returns_buffer, trade_return);
+    push_return(manager, trade_return);
     
     int size = cb_size(manager->returns_buffer);
     if (size < 10) return;
     
-    // calc sharpe ratio
-    double mean_return = rolling_mean(manager->returns_buffer);
-    double std_return = rolling_std(manager->returns_buffer);
+    // calc sharpe ratio from the window sums
+    double mean_return = manager->returns_sum / size;
+    double variance = (manager->returns_sumsq - manager->returns_sum * mean_return) / (size - 1);
+    double std_return = variance > 0.0 ? sqrt(variance) : 0.0;
     
     if (std_return > 0) {
         manager->sharpe_ratio = mean_return / std_return * sqrt(252); // annualized
     }
     
-    // calc max drawdown
-    double peak = -99999.0;
-    double max_dd = 0.0;
-    double cumulative = 0.0;
-    
-    for (int i = 0; i < size; i++) {
-        cumulative += cb_get(manager->returns_buffer, i);
-        if (cumulative > peak) {
-            peak = cumulative;
-        }
-        double drawdown = peak - cumulative;
-        if (drawdown > max_dd) {
-            max_dd = drawdown;
-        }
-    }
-    manager->max_drawdown = max_dd;
+    // max drawdown of cumulative return over the window
+    manager->max_drawdown = drawdown_window_max(manager->drawdown);
     
     // calc portfolio heat (current risk exposure)
-    double recent_vol = rolling_std(manager->returns_buffer);
-    manager->portfolio_heat = recent_vol * 10.0; // scale factor
+    manager->portfolio_heat = std_return * 10.0; // scale factor
     if (manager->portfolio_heat > 1.0) manager->portfolio_heat = 1.0;
 }
 
+DrawdownWindow* create_drawdown_window(int capacity) {
+    if (capacity < 1) return NULL;
+    
+    DrawdownWindow *window = calloc(1, sizeof(DrawdownWindow));
+    if (!window) return NULL;
+    
+    window->cumulative = malloc(capacity * sizeof(double));
+    window->front = malloc(capacity * sizeof(DrawdownAggregate));
+    if (!window->cumulative || !window->front) {
+        destroy_drawdown_window(window);
+        return NULL;
+    }
+    window->capacity = capacity;
+    return window;
+}
+
+void destroy_drawdown_window(DrawdownWindow *window) {
+    if (window) {
+        free(window->cumulative);
+        free(window->front);
+        free(window);
+    }
+}
+
+void drawdown_window_clear(DrawdownWindow *window) {
+    window->head = 0;
+    window->count = 0;
+    window->n_front = 0;
+    window->last = 0.0;
+}
+
+// older run a followed by newer run b
+static DrawdownAggregate combine_drawdown(DrawdownAggregate a, DrawdownAggregate b) {
+    DrawdownAggregate c;
+    c.max = a.max > b.max ? a.max : b.max;
+    c.min = a.min < b.min ? a.min : b.min;
+    c.drawdown = a.drawdown > b.drawdown ? a.drawdown : b.drawdown;
+    if (a.max - b.min > c.drawdown) c.drawdown = a.max - b.min;
+    return c;
+}
+
+// turns every held value into the older stack, rebased so the oldest is 0
+static void flip_drawdown(DrawdownWindow *window) {
+    double origin = window->cumulative[window->head];
+    window->last -= origin;
+    
+    DrawdownAggregate agg = {0.0, 0.0, 0.0};
+    for (int k = 0; k < window->count; k++) {
+        int slot = (window->head + window->count - 1 - k) % window->capacity;
+        double v = window->cumulative[slot] - origin;
+        window->cumulative[slot] = v;
+        DrawdownAggregate one = {v, v, 0.0};
+        agg = k == 0 ? one : combine_drawdown(one, agg);
+        window->front[k] = agg;
+    }
+    window->n_front = window->count;
+}
+
+// `trade_return` extends the cumulative return; the oldest value leaves once the window is full
+void drawdown_window_push(DrawdownWindow *window, double trade_return) {
+    if (window->count == window->capacity) {
+        if (window->n_front == 0) flip_drawdown(window);
+        window->n_front--;
+        window->head = (window->head + 1) % window->capacity;
+        window->count--;
+    }
+    
+    window->last += trade_return;
+    window->cumulative[(window->head + window->count) % window->capacity] = window->last;
+    DrawdownAggregate one = {window->last, window->last, 0.0};
+    window->back = window->count == window->n_front ? one : combine_drawdown(window->back, one);
+    window->count++;
+}
+
+double drawdown_window_max(const DrawdownWindow *window) {
+    if (window->count == 0) return 0.0;
+    if (window->n_front == 0) return window->back.drawdown;
+    
+    DrawdownAggregate older = window->front[window->n_front - 1];
+    if (window->count == window->n_front) return older.drawdown;
+    return combine_drawdown(older, window->back).drawdown;
+}
+
 // volatility-based position scaling
 double calculate_volatility_adjusted_size(RiskManager *manager, double base_size, double current_vol, double target_vol) {
     if (current_vol <= 0 || target_vol <= 0) return base_size;
@@ -6,6 +6,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define MAX_SYMBOLS 1000
 #define MAX_WINDOW_SIZE 252
@@ -26,6 +27,36 @@ typedef struct {
     bool is_full;
 } CircularBuffer;
 
+// Ring of paired samples (x, y) with prefix sums of x, y, x^2, y^2 and x*y, so the
+// moments of any suffix of up to `capacity` samples take O(1). Sums run relative
+// to an origin that is moved to the window mean, and recomputed exactly from the
+// samples, every `capacity` pushes.
+typedef struct {
+    double *x;               // samples, ring of capacity
+    double *y;
+    double *sum_x;           // prefix sums of (x - origin_x), ring of capacity + 1
+    double *sum_y;
+    double *sum_xx;
+    double *sum_yy;
+    double *sum_xy;
+    double origin_x;
+    double origin_y;
+    int capacity;
+    int count;
+    long total;              // samples ever pushed
+    int since_rebase;
+} PrefixBuffer;
+
+// Moments over the latest n samples of a PrefixBuffer (sample variances, n - 1)
+typedef struct {
+    int n;
+    double mean_x;
+    double mean_y;
+    double var_x;
+    double var_y;
+    double cov_xy;
+} PrefixWindow;
+
 typedef struct {
     double **matrix;
     int size;
@@ -39,8 +70,78 @@ typedef struct {
     CircularBuffer *volatility_buffer;
     CircularBuffer *correlation_buffer;
     int last_regime_change;
+    double last_price1;
+    double last_price2;
+    struct RegimeBatch *model;   // trained HMM filter for this pair, NULL: threshold rules
 } RegimeDetector;
 
+// Gaussian-emission HMM over two regime features (see regime_batch.c)
+#define REGIME_N_FEATURES 2      // 0: short/long volatility ratio, 1: correlation dispersion
+
+typedef struct {
+    double initial[MAX_REGIMES];
+    double transition[MAX_REGIMES][MAX_REGIMES];               // rows: from, columns: to
+    double emission_mean[MAX_REGIMES][REGIME_N_FEATURES];
+    double emission_var[MAX_REGIMES][REGIME_N_FEATURES];       // diagonal covariance
+    int short_span;              // EW spans of the feature estimators, in updates
+    int long_span;
+} RegimeModelParams;
+
+// Many detectors filtered together, structure-of-arrays: prob[k][i] is regime k
+// of pair i, so one time step is a handful of unit-stride passes over all pairs
+typedef struct RegimeBatch {
+    int n_pairs;
+    RegimeModelParams params;
+    double *prob[MAX_REGIMES];   // filtered P(regime | features so far)
+    double *emission[MAX_REGIMES]; // scratch, emission likelihoods of the last step
+    int *regime;                 // most likely regime per pair
+    double *confidence;          // its probability
+    double *vol_feature;         // features of the last step
+    double *corr_feature;
+    double *short_var;           // EW mean squared combined return
+    double *long_var;
+    double *corr_mean;           // EW correlation mean and variance
+    double *corr_var;
+    double *last_price1;
+    double *last_price2;
+    int *n_updates;              // returns seen per pair
+    double log_norm[MAX_REGIMES];  // derived from params at creation
+    double inv_var[MAX_REGIMES][REGIME_N_FEATURES];
+    double short_alpha;
+    double long_alpha;
+} RegimeBatch;
+
+// One pair's feature history for training; NaN entries are steps without evidence
+typedef struct {
+    const double *vol_feature;
+    const double *corr_feature;
+    int n_steps;
+} RegimeSequence;
+
+typedef struct {
+    int max_iterations;
+    double tolerance;            // stop when the log-likelihood gains less than this, relatively
+    int n_threads;
+    int chunk_steps;             // E-step work unit: this many steps of one sequence
+} RegimeTrainingConfig;
+
+typedef struct {
+    double log_likelihood;
+    int iterations;
+    bool converged;
+} RegimeTrainingResult;
+
+// Decoded regimes of a batch of sequences: sequence i is steps offsets[i] ..
+// offsets[i + 1] of the flat arrays, on the same step axis as its features
+typedef struct {
+    int n_sequences;
+    size_t *offsets;             // n_sequences + 1
+    uint8_t *regime;             // most likely (Viterbi) path
+    float *posterior[MAX_REGIMES]; // P(regime k at the step | whole sequence)
+    double *log_likelihood;      // per sequence, log p(features)
+    double *path_log_prob;       // per sequence, log p(features, Viterbi path)
+} RegimePath;
+
 typedef struct {
     double bid_ask_spread_asset1;
     double bid_ask_spread_asset2;
@@ -52,6 +153,20 @@ typedef struct {
     double slippage_factor;
 } TransactionCosts;
 
+// Kalman filter on price1 = alpha + beta * price2 + e, with (beta, alpha) a
+// random walk. O(1) per tick, no allocation; P[0][0] is the variance of beta.
+typedef struct {
+    double beta;
+    double alpha;
+    double P[2][2];              // state covariance, (beta, alpha)
+    double process_noise;        // delta: per-tick state noise delta / (1 - delta) * I
+    double noise_alpha;          // EW weight of the observation-noise estimate
+    double observation_var;      // R, estimated online from the innovations
+    double innovation;           // last forecast error of price1
+    double innovation_var;       // its predicted variance
+    long n_updates;
+} KalmanHedge;
+
 typedef struct {
     double theoretical_pnl;
     double net_pnl_after_costs;
@@ -62,6 +177,28 @@ typedef struct {
     bool is_profitable;
 } PnLAnalysis;
 
+// Running max, min and largest peak-to-trough fall of a run of cumulative returns
+typedef struct {
+    double max;
+    double min;
+    double drawdown;
+} DrawdownAggregate;
+
+// Max drawdown over the latest `capacity` cumulative returns, as a two-stack queue:
+// older values sit in a stack of suffix aggregates that pops in O(1), newer ones
+// in one running aggregate; when the older stack runs dry the newer part is
+// turned into it. Amortized O(1) per push.
+typedef struct {
+    double *cumulative;         // ring of cumulative returns, relative to the window start at the last flip
+    DrawdownAggregate *front;   // front[i]: values i + 1 from the end of the older part through its end
+    DrawdownAggregate back;     // aggregate of the newer part
+    double last;                // newest cumulative return
+    int capacity;
+    int head;                   // ring slot of the oldest value
+    int count;
+    int n_front;
+} DrawdownWindow;
+
 typedef struct {
     double target_volatility;
     double current_volatility;
@@ -75,6 +212,12 @@ typedef struct {
     CircularBuffer *returns_buffer;
     CircularBuffer *volatility_buffer;
     int volatility_window;
+    double smoothed_volatility; // previous EWMA volatility, 0 until first estimate
+    double returns_sum;         // window sums behind the O(1) updates, see risk_manager_rebuild
+    double returns_sumsq;
+    double volatility_sum;      // sum of volatility_buffer
+    int pushes;                 // returns pushed since the last exact rebuild
+    DrawdownWindow *drawdown;   // follows returns_buffer
 } RiskManager;
 
 typedef struct {
@@ -94,13 +237,37 @@ typedef struct {
     long timestamp_micro;
 } PairSignal;
 
+// Hot-path signal: what most consumers read on every tick. The diagnostics of a
+// full PairSignal are rebuilt on request by materialize_pair_signal.
+#define PAIR_SIGNAL_FLAG_PROFITABLE 0x01  // expected P&L clears transaction costs
+#define PAIR_SIGNAL_FLAG_COST_VETO  0x02  // a trade signal was zeroed by the cost check
+
 typedef struct {
-    double **query_weights;
-    double **key_weights;
-    double **value_weights;
+    int64_t timestamp_micro;
+    int32_t pair_id;         // tracker's universe index, -1 if standalone
+    int8_t signal;           // -1: short, 0: neutral, 1: long
+    int8_t regime;
+    uint8_t flags;           // PAIR_SIGNAL_FLAG_*
+    uint8_t reserved;
+    double z_score;
+    double position_size;
+} PairSignalCompact;
+
+#define ATTENTION_DEFAULT_SEED 42
+
+// Read-only attention weights mapped from a model file and shared by every layer
+// opened on it (see attention_model.c)
+typedef struct AttentionModel AttentionModel;
+
+typedef struct {
+    double *weights;         // one SIMD_ALIGNMENT-aligned block: Q, K, V
+    double *query_weights;   // attention_dim x input_dim, row-major views into weights
+    double *key_weights;
+    double *value_weights;
     int input_dim;
     int attention_dim;
     int sequence_length;
+    AttentionModel *model;   // non-NULL when the weights are a read-only view of a mapped model file
 } AttentionLayer;
 
 typedef struct {
@@ -111,18 +278,151 @@ typedef struct {
     int feature_dim;
 } AttentionOutput;
 
+// Windows of many pairs pushed through one attention layer together. Row-major,
+// pair-major: inputs are n_pairs x sequence_length x n_features.
+#define ATTENTION_N_FEATURES 3   // standardized spread, its change, EW volatility of the change
+
+typedef struct {
+    int n_pairs;
+    int sequence_length;
+    int n_features;
+    int attention_dim;
+    int n_queries;           // latest steps of each window that attend (1..sequence_length)
+    double *inputs;
+    double *queries;         // n_pairs x n_queries x attention_dim
+    double *keys;            // n_pairs x sequence_length x attention_dim
+    double *values;
+    double *scores;          // n_pairs x n_queries x sequence_length, softmax-normalized
+    double *context;         // n_pairs x n_queries x attention_dim
+    bool *ready;             // per pair: the last attention_batch_set_window filled its window
+} AttentionBatch;
+
+// Running sums behind the attention-weighted z-score, kept as the spread window
+// slides. Values are taken around `center` (reset on rebuild) to limit cancellation.
+typedef struct {
+    double center;
+    double sum;              // sum of y = x - center
+    double sumsq;            // sum of y^2
+    double sum_abs;          // sum of |x|
+    double pos_sum;          // sum of (i + 1) * y, i = position in the window
+    double pos_sumsq;        // sum of (i + 1) * y^2
+    double abs_sum;          // sum of |x| * y
+    double abs_sumsq;        // sum of |x| * y^2
+    double lag_abs;          // sum over i >= 1 of |x_i| * y_(i-1)
+    int count;
+    int pushes;              // pushes since the last exact rebuild
+} AttentionStream;
+
+// Lagged-pair sums behind the AR(1) half-life fit, kept as the spread window slides:
+// x = spread[t-1] - center, y = spread[t] - center over consecutive window values.
+// The exponentially weighted moments are used instead when ew_alpha > 0.
 typedef struct {
+    double center;
+    double sum_x;
+    double sum_y;
+    double sum_xy;
+    double sum_x2;
+    int count;               // window values covered, count - 1 pairs
+    int pushes;              // pushes since the last exact rebuild
+    double ew_alpha;         // 0: fit over the window
+    double ew_mean_x;
+    double ew_mean_y;
+    double ew_cov_xy;
+    double ew_var_x;
+    long ew_pairs;
+} HalfLifeStream;
+
+// Pipeline stages of generate_enhanced_pairs_signal timed under SAKURA_PROFILE
+typedef enum {
+    LATENCY_STAGE_PUSH = 0,
+    LATENCY_STAGE_HEDGE,
+    LATENCY_STAGE_STATS,
+    LATENCY_STAGE_REGIME,
+    LATENCY_STAGE_THRESHOLDS,
+    LATENCY_STAGE_ATTENTION,
+    LATENCY_STAGE_SIZING,
+    LATENCY_STAGE_COSTS,
+    LATENCY_STAGE_COINTEGRATION,
+    LATENCY_STAGE_TOTAL,
+    LATENCY_STAGE_COUNT
+} LatencyStage;
+
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_BUCKET_COUNT 544  // log-linear buckets covering 0 .. ~2^37 ns
+
+// HDR-style histogram with a single writer; readers may snapshot it concurrently
+typedef struct {
+    uint64_t counts[LATENCY_BUCKET_COUNT];
+    uint64_t total_count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} LatencyHistogram;
+
+typedef struct {
+    LatencyHistogram stages[LATENCY_STAGE_COUNT];
+    LatencyHistogram baseline[LATENCY_STAGE_COUNT]; // reader-side reset point
+} LatencyProfile;
+
+typedef struct {
+    uint64_t count;
+    double mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} LatencyStats;
+
+typedef struct {
+    LatencyStats stages[LATENCY_STAGE_COUNT];
+} LatencySnapshot;
+
+// Feature bits selecting a specialized generate_enhanced_pairs_signal variant
+#define SIGNAL_FEATURE_ATTENTION 0x01
+#define SIGNAL_FEATURE_REGIME    0x02
+#define SIGNAL_FEATURE_HEDGING   0x04
+#define SIGNAL_FEATURE_COSTS     0x08
+#define SIGNAL_FEATURE_RISK      0x10
+#define SIGNAL_FEATURE_KALMAN_HEDGE 0x20 // with HEDGING: hedge_filter instead of the rolling regression
+#define SIGNAL_FEATURE_COUNT     64
+
+#define HEDGE_MODE_ROLLING 0
+#define HEDGE_MODE_KALMAN  1
+
+// Tunable signal parameters; the defaults reproduce the original hard-coded values
+typedef struct {
+    double entry_threshold;          // base |z| to open a position
+    double exit_threshold;           // base |z| to close it
+    double stress_entry_multiplier;  // threshold scaling in regime 1
+    double stress_exit_multiplier;
+    double crisis_entry_multiplier;  // threshold scaling in regime 2
+    double crisis_exit_multiplier;
+    double attention_blend;          // weight of the attention z-score vs the plain one
+    int hedge_lookback;              // samples in the rolling hedge regression; Kalman: warm-up and noise span
+    double target_volatility;        // annual volatility target for sizing
+    int hedge_mode;                  // HEDGE_MODE_ROLLING or HEDGE_MODE_KALMAN
+    double hedge_process_noise;      // Kalman: delta, how fast beta and alpha may drift per tick
+    double hedge_uncertainty_weight; // Kalman: how much beta variance shrinks position size, 0 = not at all
+    int half_life_span;              // 0: AR(1) half-life over the spread window; > 0: EW fit with this span
+} SignalParams;
+
+struct PairTracker;
+typedef PairSignalCompact (*PairSignalFn)(struct PairTracker *tracker, double price1, double price2,
+                                   double bid1, double ask1, double bid2, double ask2, long timestamp_micro);
+
+typedef struct PairTracker {
     CircularBuffer *price_buffer1;
     CircularBuffer *price_buffer2;
     CircularBuffer *spread_buffer;
     CircularBuffer *hedge_ratio_buffer;
-    CircularBuffer *volatility1_buffer;
-    CircularBuffer *volatility2_buffer;
+    PrefixBuffer *return_prefix;     // (ret1, ret2) log returns: hedge regression and volatility
     AttentionLayer *temporal_attention;
     AttentionOutput *attention_cache;
+    AttentionStream attention_stream; // follows spread_buffer via tracker_push_spread
     RegimeDetector *regime_detector;
     TransactionCosts transaction_costs;
     RiskManager *risk_manager;
+    KalmanHedge hedge_filter;  // HEDGE_MODE_KALMAN state
+    HalfLifeStream half_life_stream; // follows spread_buffer via tracker_push_spread
     double mean_spread;
     double std_spread;
     double correlation;
@@ -130,14 +430,336 @@ typedef struct {
     double current_hedge_ratio;
     double dynamic_entry_threshold;
     double dynamic_exit_threshold;
+    double last_z_score;     // outputs of the latest step, for materialize_pair_signal
+    double last_position_size;
+    int last_signal;
+    SignalParams params;
+    int position;            // 0: flat, 1: long spread, -1: short spread
+    int pair_id;             // index within its PairUniverse, -1 if standalone
     int window_size;
     bool use_attention;
     bool use_regime_detection;
     bool use_dynamic_hedging;
     bool use_transaction_costs;
+    int signal_features;     // SIGNAL_FEATURE_* mask the variant was built for
+    PairSignalFn signal_fn;  // chosen once by select_signal_variant
+    LatencyProfile *latency_profile; // per-pair stage timings, NULL unless enabled
     long last_update_micro;
 } PairTracker;
 
+#define BASKET_MAX_LEGS 32
+
+// One target asset hedged against up to BASKET_MAX_LEGS others:
+// spread = target - (weights . legs + intercept), the weights refitted every tick
+// by recursive least squares with exponential forgetting
+typedef struct {
+    int n_legs;
+    double *coef;            // n_legs + 1 RLS state on first-quote-normalized prices, intercept last
+    double *covariance;      // (n_legs + 1)^2 RLS P matrix, row-major
+    double *gain;            // n_legs + 1 scratch for P x
+    double *scale;           // first quote of each leg, then of the target
+    double *weights;         // hedge units of each leg per unit of target
+    double intercept;
+    double forgetting;       // RLS lambda; memory of about 1 / (1 - lambda) ticks
+    double covariance_bound; // trace(P) cap so quiet legs do not wind P up
+    CircularBuffer *target_buffer;
+    CircularBuffer *hedge_buffer; // fitted hedge value, target - spread
+    CircularBuffer *spread_buffer;
+    HalfLifeStream half_life_stream;
+    double mean_spread;
+    double std_spread;
+    double half_life;
+    double dynamic_entry_threshold;
+    double dynamic_exit_threshold;
+    double last_z_score;
+    double last_position_size;
+    int last_signal;
+    SignalParams params;     // entry/exit thresholds; hedge_lookback is the warm-up
+    int position;            // 0: flat, 1: long basket spread, -1: short
+    int basket_id;           // reported as pair_id, -1 by default
+    int window_size;
+    long n_updates;
+} BasketTracker;
+
+// One quote/trade update for a symbol
+typedef struct {
+    int64_t timestamp_micro;
+    int32_t symbol;
+    double bid;
+    double ask;
+    double last;
+    double size;
+} TickRecord;
+
+#define TICK_SYMBOL_LEN 16
+#define TICK_DEFAULT_BLOCK_CAPACITY 65536
+
+// Interned ticker names: dense ids in first-seen order, open-addressing lookup
+typedef struct {
+    char (*names)[TICK_SYMBOL_LEN];  // zero-padded, indexed by id
+    uint64_t *hashes;                // FNV-1a of each name
+    int32_t *slots;                  // hash slots holding ids, -1 if empty
+    uint32_t slot_mask;
+    int n_symbols;
+    int capacity;
+} SymbolTable;
+
+// Directory entry for one columnar block of a tick file
+typedef struct {
+    uint64_t offset;
+    uint32_t count;
+    uint32_t reserved;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+} TickBlockEntry;
+
+// Symbol index entry: a block holding `count` records of the symbol
+typedef struct {
+    uint32_t block;
+    uint32_t count;
+} TickSymbolBlock;
+
+// Read-only, memory-mapped tick file
+typedef struct {
+    void *map;
+    size_t map_size;
+    int n_symbols;
+    int n_blocks;
+    uint64_t n_records;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    const char (*symbols)[TICK_SYMBOL_LEN];
+    SymbolTable *symbol_table;            // name -> id, built at open
+    const TickBlockEntry *blocks;
+    const uint64_t *symbol_offsets;       // CSR offsets into symbol_blocks, n_symbols + 1
+    const TickSymbolBlock *symbol_blocks;
+} TickFile;
+
+// Zero-copy column pointers into one block of the mapping
+typedef struct {
+    const int64_t *timestamp_micro;
+    const int32_t *symbol;
+    const double *bid;
+    const double *ask;
+    const double *last;
+    const double *size;
+    int count;
+} TickBlockView;
+
+typedef struct {
+    int block;
+    int index;
+} TickCursor;
+
+typedef struct TickFileWriter TickFileWriter;
+
+typedef void (*PairSignalCallback)(void *ctx, const PairSignal *signal);
+typedef void (*PairSignalCompactCallback)(void *ctx, const PairSignalCompact *signal);
+
+// Set of pair trackers fed from per-symbol quotes
+typedef struct {
+    PairTracker **trackers;
+    int *leg1;              // symbol id of asset1 per pair
+    int *leg2;              // symbol id of asset2 per pair
+    int n_pairs;
+    int pair_capacity;
+    int n_symbols;
+    int *symbol_pair_offsets; // CSR routing: pairs of symbol s are
+    int *symbol_pairs;        // symbol_pairs[offsets[s] .. offsets[s + 1])
+    bool routing_dirty;       // pairs added since the index was built
+    double *last_price;     // latest quote per symbol (0 until first quote)
+    double *last_bid;
+    double *last_ask;
+} PairUniverse;
+
+// One point of a parameter sweep
+typedef struct {
+    int window_size;
+    SignalParams params;
+} BacktestConfig;
+
+#define BACKTEST_MAX_AXIS_VALUES 16
+
+typedef struct {
+    double values[BACKTEST_MAX_AXIS_VALUES];
+    int count;               // 0 keeps the default for this axis
+} BacktestAxis;
+
+// Cartesian grid; regime multipliers are swept by passing explicit configs
+typedef struct {
+    BacktestAxis window_size;
+    BacktestAxis entry_threshold;
+    BacktestAxis exit_threshold;
+    BacktestAxis attention_blend;
+    BacktestAxis hedge_lookback;
+    BacktestAxis target_volatility;
+    BacktestAxis hedge_mode;
+    BacktestAxis hedge_process_noise;
+} BacktestGrid;
+
+typedef struct {
+    BacktestConfig config;
+    double pnl;              // net of half-spread costs, account currency
+    double costs;
+    double sharpe;           // annualized from the tick-level return series
+    double max_drawdown;     // peak-to-trough of cumulative PnL
+    int n_trades;            // position changes
+    long n_ticks;
+    double regime_pnl[MAX_REGIMES];  // backtest_run_by_regime: PnL over steps decoded as each regime
+    long regime_ticks[MAX_REGIMES];
+} BacktestResult;
+
+// Walk-forward optimization: train on `train_segments` segments, trade the next one
+typedef struct {
+    int64_t start_micro;     // clamped to the file's time range
+    int64_t end_micro;
+    int64_t segment_micro;   // test window length (train windows are whole segments)
+    int train_segments;
+    int n_threads;
+} WalkForwardConfig;
+
+typedef struct {
+    int64_t train_start_micro;
+    int64_t test_start_micro;
+    int64_t test_end_micro;
+    int best_config;         // index into the config list, chosen by train Sharpe
+    double train_sharpe;
+    double test_pnl;
+    double test_sharpe;
+    double test_max_drawdown;
+} WalkForwardWindow;
+
+typedef struct {
+    WalkForwardWindow *windows;
+    int n_windows;
+    double pnl;              // concatenated out-of-sample results
+    double costs;
+    double sharpe;
+    double max_drawdown;
+    int n_trades;
+} WalkForwardResult;
+
+// Asynchronous columnar signal log
+#define SIGNAL_LOG_DEFAULT_CHUNK 16384
+#define SIGNAL_LOG_FLAG_PROFITABLE PAIR_SIGNAL_FLAG_PROFITABLE
+
+typedef struct SignalLog SignalLog;
+
+typedef struct {
+    uint64_t signals_appended;
+    uint64_t signals_written;
+    uint64_t chunks_written;
+    uint64_t bytes_written;
+    uint64_t stalls;         // appends that waited for the flusher to free a chunk
+} SignalLogStats;
+
+// One decoded log entry
+typedef struct {
+    int64_t timestamp_micro;
+    int32_t pair_id;
+    int8_t signal;
+    int8_t regime;
+    uint8_t flags;           // PAIR_SIGNAL_FLAG_*
+    double z_score;
+    double spread;
+    double correlation;
+    double hedge_ratio;
+    double position_size;
+    double net_pnl;
+} SignalLogRecord;
+
+typedef void (*SignalLogCallback)(void *ctx, const SignalLogRecord *record);
+
+// Shared-memory signal bus: one cache line per record
+#define SIGNAL_BUS_DEFAULT_CAPACITY 65536
+
+typedef struct {
+    uint64_t sequence;       // seqlock: 2n once message n is complete, odd while being written
+    int64_t timestamp_micro;
+    int32_t pair_id;
+    int8_t signal;
+    int8_t regime;
+    uint8_t flags;           // PAIR_SIGNAL_FLAG_*
+    uint8_t reserved;
+    double z_score;
+    double spread;
+    double hedge_ratio;
+    double position_size;
+    double net_pnl;
+} SignalBusRecord;
+
+typedef enum {
+    SIGNAL_BUS_OK = 0,
+    SIGNAL_BUS_EMPTY,        // nothing new yet
+    SIGNAL_BUS_OVERRUN       // the writer lapped this reader; it has skipped ahead
+} SignalBusStatus;
+
+typedef struct SignalBus SignalBus;
+typedef struct SignalBusReader SignalBusReader;
+
+// CSV tick import
+typedef struct {
+    char delimiter;
+    bool has_header;
+    bool auto_columns;      // map columns from header names (timestamp, symbol, bid, ask, last, size)
+    int col_timestamp;      // epoch s/ms/us/ns or ISO-8601 UTC
+    int col_symbol;
+    int col_bid;            // optional columns: -1 if absent
+    int col_ask;
+    int col_last;
+    int col_size;
+    int n_threads;          // parser threads per chunk
+    size_t chunk_bytes;     // read size; bounds memory use
+} CsvImportConfig;
+
+typedef struct {
+    uint64_t rows;          // ticks delivered to the sink
+    uint64_t rejected_rows; // malformed rows or rows the sink refused
+    uint64_t skipped_rows;  // rows for symbols the sink does not track
+    uint64_t bytes;
+    int symbols;
+    double seconds;
+    double rows_per_sec;
+} CsvImportStats;
+
+// Destination for imported ticks; resolve_symbol is called once per distinct symbol
+typedef struct {
+    int (*resolve_symbol)(void *ctx, const char *symbol);  // id, or -1 to skip the symbol
+    bool (*on_tick)(void *ctx, const TickRecord *tick);
+    void *ctx;
+} CsvTickSink;
+
+typedef struct {
+    int n_symbols;
+    int n_sectors;
+    double market_loading;        // factor loadings, calm regime
+    double sector_loading;
+    int cointegrated_group_size;  // symbols per cointegrated subset (< 2 disables)
+    double cointegrated_fraction; // share of symbols placed in cointegrated groups
+    double mean_reversion_speed;  // OU speed of group residuals per tick
+    double base_volatility;       // per-tick return vol, calm regime
+    double regime_switch_prob;    // per-tick probability of switching regime
+    double stress_vol_multiplier;
+    double base_spread_bps;
+    int tick_interval_micro;
+    uint64_t seed;
+} SyntheticUniverseConfig;
+
+typedef struct {
+    SyntheticUniverseConfig config;
+    double *log_price;
+    double *residual;       // OU residual of cointegrated members
+    double *group_offset;   // equilibrium offset of each member from its group trend
+    int *sector;
+    int *group;             // cointegrated group per symbol, -1 if none
+    double *group_trend;
+    double *sector_return;
+    int n_groups;
+    int regime;             // 0: calm, 1: stressed
+    uint64_t rng;
+    long timestamp_micro;
+} SyntheticUniverse;
+
 // Circular buffer functions
 CircularBuffer* create_circular_buffer(int capacity);
 void destroy_circular_buffer(CircularBuffer *cb);
@@ -145,6 +767,14 @@ void cb_push(CircularBuffer *cb, double value);
 double cb_get(CircularBuffer *cb, int index);
 int cb_size(CircularBuffer *cb);
 
+// Prefix-sum buffer functions
+PrefixBuffer* create_prefix_buffer(int capacity);
+void destroy_prefix_buffer(PrefixBuffer *pb);
+void pb_push(PrefixBuffer *pb, double x, double y);
+void pb_clear(PrefixBuffer *pb);
+int pb_size(const PrefixBuffer *pb);
+PrefixWindow pb_window(const PrefixBuffer *pb, int lookback);
+
 // Statistical functions
 double rolling_mean(CircularBuffer *cb);
 double rolling_std(CircularBuffer *cb);
@@ -162,18 +792,41 @@ bool test_cointegration(double test_stat, double critical_value);
 
 // Attention mechanism functions
 AttentionLayer* create_attention_layer(int input_dim, int attention_dim, int sequence_length);
+AttentionLayer* create_attention_layer_seeded(int input_dim, int attention_dim, int sequence_length,
+                                              uint64_t seed);
 void destroy_attention_layer(AttentionLayer *layer);
 AttentionOutput* create_attention_output(int sequence_length, int feature_dim);
 void destroy_attention_output(AttentionOutput *output);
 double* softmax(double *scores, int length);
-double* matrix_multiply(double **matrix, double *vector, int rows, int cols);
+void softmax_inplace(double *scores, int length);
+void softmax_into(const double *scores, double *out, int length);
+void softmax_rows(double *scores, int rows, int cols, int stride);
+double* matrix_multiply(const double *matrix, const double *vector, int rows, int cols);
 AttentionOutput* apply_temporal_attention(AttentionLayer *layer, CircularBuffer *sequence);
 double calculate_attention_enhanced_zscore(CircularBuffer *spread_buffer, AttentionLayer *attention);
+AttentionBatch* create_attention_batch(const AttentionLayer *layer, int n_pairs, int n_queries);
+void destroy_attention_batch(AttentionBatch *batch);
+bool attention_batch_set_window(AttentionBatch *batch, int pair, CircularBuffer *spread);
+bool attention_batch_forward(const AttentionLayer *layer, AttentionBatch *batch);
+double attention_batch_zscore(const AttentionBatch *batch, int pair);
+void attention_stream_rebuild(AttentionStream *stream, CircularBuffer *buffer);
+void attention_stream_push(AttentionStream *stream, CircularBuffer *buffer, double value);
+double attention_stream_zscore(AttentionStream *stream, CircularBuffer *buffer, AttentionLayer *attention);
+
+// Attention model file functions
+bool attention_model_save(const AttentionLayer *layer, const char *path);
+AttentionModel* attention_model_open(const char *path);
+void attention_model_close(AttentionModel *model);
+int attention_model_input_dim(const AttentionModel *model);
+int attention_model_attention_dim(const AttentionModel *model);
+uint64_t attention_model_fingerprint(AttentionModel *model);
+AttentionLayer* create_attention_layer_from_model(AttentionModel *model, int sequence_length);
 
 // Signal generation functions
 PairSignal generate_pairs_signal(PairTracker *tracker, double current_price1, double current_price2);
 PairSignal generate_pairs_signal_with_attention(PairTracker *tracker, double current_price1, double current_price2);
 int mean_reversion_signal(double z_score, double entry_threshold, double exit_threshold);
+int mean_reversion_step(int *position, double z_score, double entry_threshold, double exit_threshold);
 
 // Utility functions
 void print_pair_signal(PairSignal *signal);
@@ -185,10 +838,56 @@ void destroy_regime_detector(RegimeDetector *detector);
 void update_regime(RegimeDetector *detector, double price1, double price2, double correlation);
 int detect_regime_change(RegimeDetector *detector, double threshold);
 
+// Batched regime filter functions
+void regime_model_default_params(RegimeModelParams *params);
+RegimeBatch* create_regime_batch(int n_pairs, const RegimeModelParams *params);
+void destroy_regime_batch(RegimeBatch *batch);
+void regime_batch_reset(RegimeBatch *batch);
+void regime_batch_update_features(RegimeBatch *batch, const double *price1, const double *price2,
+                                  const double *correlation);
+void regime_batch_filter(RegimeBatch *batch, const double *vol_feature, const double *corr_feature);
+void regime_batch_step(RegimeBatch *batch, const double *price1, const double *price2,
+                       const double *correlation);
+RegimeDetector* create_regime_detector_with_model(int volatility_window, const RegimeModelParams *params);
+bool regime_detector_set_model(RegimeDetector *detector, const RegimeModelParams *params);
+
+// Regime training functions
+void regime_training_default_config(RegimeTrainingConfig *config);
+bool regime_extract_features(const RegimeModelParams *params, const double *price1, const double *price2,
+                             const double *correlation, int n_steps, double *vol_feature, double *corr_feature);
+int regime_features_from_tick_file(const TickFile *file, int symbol1, int symbol2, int window,
+                                   const RegimeModelParams *params, double **vol_feature, double **corr_feature);
+bool regime_train(const RegimeSequence *sequences, int n_sequences, const RegimeTrainingConfig *config,
+                  RegimeModelParams *params, RegimeTrainingResult *result);
+bool regime_model_save(const RegimeModelParams *params, const char *path);
+bool regime_model_load(const char *path, RegimeModelParams *params);
+
+// Regime decoding functions
+RegimePath* regime_decode(const RegimeModelParams *params, const RegimeSequence *sequences, int n_sequences,
+                          int n_threads);
+void destroy_regime_path(RegimePath *path);
+
 // Dynamic hedging functions
 double calculate_dynamic_hedge_ratio(CircularBuffer *price1, CircularBuffer *price2, int lookback);
+double prefix_dynamic_hedge_ratio(const PrefixBuffer *returns, int lookback);
 double calculate_half_life(CircularBuffer *spread_buffer);
+void half_life_stream_rebuild(HalfLifeStream *stream, CircularBuffer *buffer);
+void half_life_stream_advance(HalfLifeStream *stream, CircularBuffer *buffer, double value);
+double half_life_stream_half_life(HalfLifeStream *stream, CircularBuffer *buffer);
+void half_life_stream_set_span(HalfLifeStream *stream, int span);
 void update_dynamic_thresholds(PairTracker *tracker, double volatility_factor);
+void kalman_hedge_init(KalmanHedge *filter, double process_noise, int noise_span);
+void kalman_hedge_update(KalmanHedge *filter, double price1, double price2);
+double kalman_hedge_size_factor(const KalmanHedge *filter, double price2, double spread_std, double weight);
+
+// Basket hedging functions
+BasketTracker* create_basket_tracker(int n_legs, int window_size, double forgetting);
+void destroy_basket_tracker(BasketTracker *basket);
+void basket_tracker_set_params(BasketTracker *basket, const SignalParams *params);
+PairSignalCompact basket_tracker_update(BasketTracker *basket, double target_price, const double *leg_prices,
+                                        long timestamp_micro);
+void basket_tracker_positions(const BasketTracker *basket, double target_price, double *units);
+double basket_cointegration_stat(BasketTracker *basket);
 
 // Transaction cost functions
 TransactionCosts create_transaction_costs(double ba_spread1, double ba_spread2, double impact1, double impact2);
@@ -202,6 +901,12 @@ double calculate_volatility_target_size(RiskManager *manager, double signal_stre
 void update_volatility_estimate(RiskManager *manager, double trade_return);
 double calculate_regime_adjusted_target_vol(RiskManager *manager, int regime);
 void update_portfolio_risk(RiskManager *manager, double trade_return);
+void risk_manager_rebuild(RiskManager *manager);
+DrawdownWindow* create_drawdown_window(int capacity);
+void destroy_drawdown_window(DrawdownWindow *window);
+void drawdown_window_clear(DrawdownWindow *window);
+void drawdown_window_push(DrawdownWindow *window, double value);
+double drawdown_window_max(const DrawdownWindow *window);
 
 // SIMD optimized functions
 double simd_rolling_mean(double *data, int size);
@@ -210,6 +915,12 @@ double simd_correlation(double *data1, double *data2, int size);
 double simd_cb_rolling_mean(CircularBuffer *cb);
 double simd_cb_rolling_std(CircularBuffer *cb);
 double simd_cb_correlation(CircularBuffer *cb1, CircularBuffer *cb2);
+void simd_gemm_nt(int m, int n, int k, double alpha, const double *a, int lda,
+                  const double *b, int ldb, double beta, double *c, int ldc);
+void simd_gemm_nn(int m, int n, int k, double alpha, const double *a, int lda,
+                  const double *b, int ldb, double beta, double *c, int ldc);
+void simd_softmax(const double *scores, double *out, int length);
+void simd_exp_array(const double *x, double *out, int length);
 
 // Alternative cointegration tests
 double johansen_test(CircularBuffer *price1, CircularBuffer *price2);
@@ -218,10 +929,165 @@ double threshold_cointegration_test(CircularBuffer *spread, double threshold);
 // Enhanced signal generation
 PairSignal generate_enhanced_pairs_signal(PairTracker *tracker, double price1, double price2, 
                                         double bid1, double ask1, double bid2, double ask2, long timestamp_micro);
+PairSignalCompact generate_compact_pairs_signal(PairTracker *tracker, double price1, double price2,
+                                                double bid1, double ask1, double bid2, double ask2,
+                                                long timestamp_micro);
+PairSignal materialize_pair_signal(PairTracker *tracker, bool include_cointegration);
+
+// Specialized signal variants (re-select after toggling use_* flags or attaching components)
+int pair_tracker_feature_mask(const PairTracker *tracker);
+PairSignalFn get_signal_variant(int features);
+void select_signal_variant(PairTracker *tracker);
+
+// Latency profiling (stage timestamps are compiled in only with -DSAKURA_PROFILE)
+uint64_t latency_now_ns(void);
+const char* latency_stage_name(LatencyStage stage);
+void latency_histogram_reset(LatencyHistogram *hist);
+void latency_histogram_record(LatencyHistogram *hist, uint64_t value_ns);
+void latency_histogram_merge(LatencyHistogram *dst, const LatencyHistogram *src);
+uint64_t latency_histogram_percentile(const LatencyHistogram *hist, double percentile);
+LatencyStats latency_histogram_stats(const LatencyHistogram *hist);
+LatencyProfile* create_latency_profile(void);
+void destroy_latency_profile(LatencyProfile *profile);
+LatencyProfile* latency_thread_profile(void);
+uint64_t latency_record_stage(LatencyProfile *pair_profile, LatencyStage stage, uint64_t since_ns);
+void latency_snapshot_profile(LatencyProfile *profile, LatencySnapshot *out, bool reset);
+void latency_snapshot_threads(LatencySnapshot *out, bool reset);
+bool pair_tracker_enable_latency_profile(PairTracker *tracker);
+void print_latency_snapshot(const LatencySnapshot *snapshot);
+
+#ifdef SAKURA_PROFILE
+#define PROFILE_BEGIN(tracker) \
+    uint64_t profile_start_ns = latency_now_ns(); \
+    uint64_t profile_mark_ns = profile_start_ns
+#define PROFILE_STAGE(tracker, stage) \
+    (profile_mark_ns = latency_record_stage((tracker)->latency_profile, (stage), profile_mark_ns))
+#define PROFILE_END(tracker) \
+    ((void)latency_record_stage((tracker)->latency_profile, LATENCY_STAGE_TOTAL, profile_start_ns))
+#else
+#define PROFILE_BEGIN(tracker) ((void)0)
+#define PROFILE_STAGE(tracker, stage) ((void)0)
+#define PROFILE_END(tracker) ((void)0)
+#endif
+
+// Symbol table functions
+uint64_t symbol_hash(const char *name, int len);
+SymbolTable* create_symbol_table(int capacity);
+void destroy_symbol_table(SymbolTable *table);
+int symbol_table_intern(SymbolTable *table, const char *name);
+int symbol_table_intern_n(SymbolTable *table, const char *name, int len, uint64_t hash);
+int symbol_table_find(const SymbolTable *table, const char *name);
+int symbol_table_find_n(const SymbolTable *table, const char *name, int len, uint64_t hash);
+const char* symbol_table_name(const SymbolTable *table, int id);
+
+// Pair universe functions
+PairUniverse* create_pair_universe(int n_symbols, int pair_capacity);
+void destroy_pair_universe(PairUniverse *universe);
+int pair_universe_add_pair(PairUniverse *universe, int symbol1, int symbol2, PairTracker *tracker);
+bool pair_universe_build_routing(PairUniverse *universe);
+int pair_universe_set_attention_model(PairUniverse *universe, AttentionModel *model);
+int pair_universe_set_regime_model(PairUniverse *universe, const RegimeModelParams *params);
+int pair_universe_attention_step(PairUniverse *universe, const AttentionLayer *layer,
+                                 AttentionBatch *batch, double *zscores);
+int pair_universe_symbol_pairs(PairUniverse *universe, int symbol, const int **pair_ids);
+int pair_universe_on_quote(PairUniverse *universe, const TickRecord *tick, PairSignal *signals, int max_signals);
+int pair_universe_on_quote_compact(PairUniverse *universe, const TickRecord *tick,
+                                   PairSignalCompact *signals, int max_signals);
+
+// Binary tick files (memory-mapped, columnar)
+TickFileWriter* tick_writer_create(const char *path, int block_capacity);
+int tick_writer_add_symbol(TickFileWriter *writer, const char *symbol);
+bool tick_writer_append(TickFileWriter *writer, const TickRecord *tick);
+bool tick_writer_close(TickFileWriter *writer);
+void tick_writer_abort(TickFileWriter *writer);
+TickFile* tick_file_open(const char *path);
+void tick_file_close(TickFile *file);
+int tick_file_symbol_id(const TickFile *file, const char *symbol);
+TickBlockView tick_file_block(const TickFile *file, int block);
+int tick_file_symbol_blocks(const TickFile *file, int symbol, const TickSymbolBlock **blocks);
+TickCursor tick_file_seek(const TickFile *file, int64_t timestamp_micro);
+long replay_pair_from_tick_file(const TickFile *file, PairTracker *tracker, int symbol1, int symbol2,
+                                int64_t start_micro, int64_t end_micro,
+                                PairSignalCallback callback, void *callback_ctx);
+long replay_pair_from_tick_file_compact(const TickFile *file, PairTracker *tracker, int symbol1, int symbol2,
+                                        int64_t start_micro, int64_t end_micro,
+                                        PairSignalCompactCallback callback, void *callback_ctx);
+long replay_universe_from_tick_file(const TickFile *file, PairUniverse *universe,
+                                    int64_t start_micro, int64_t end_micro,
+                                    PairSignalCallback callback, void *callback_ctx);
+long replay_basket_from_tick_file(const TickFile *file, BasketTracker *basket, const int *symbols,
+                                  int64_t start_micro, int64_t end_micro,
+                                  PairSignalCompactCallback callback, void *callback_ctx);
+
+// Signal log functions (one appending thread per log)
+SignalLog* signal_log_open(const char *path, int chunk_capacity);
+void signal_log_append(SignalLog *log, int pair_id, const PairSignal *signal);
+void signal_log_append_compact(SignalLog *log, const PairSignalCompact *signal);
+bool signal_log_close(SignalLog *log, SignalLogStats *stats);
+long signal_log_replay(const char *path, SignalLogCallback callback, void *ctx);
+
+// Shared-memory signal bus functions (name is a POSIX shm name, e.g. "/sakura_signals")
+SignalBus* signal_bus_create(const char *name, int capacity, bool replace);
+void signal_bus_destroy(SignalBus *bus, bool unlink_segment);
+uint64_t signal_bus_publish(SignalBus *bus, int pair_id, const PairSignal *signal);
+uint64_t signal_bus_publish_compact(SignalBus *bus, const PairSignalCompact *signal);
+SignalBusReader* signal_bus_attach(const char *name, bool from_oldest);
+void signal_bus_detach(SignalBusReader *reader);
+const SignalBusRecord* signal_bus_peek(SignalBusReader *reader, SignalBusStatus *status);
+SignalBusStatus signal_bus_advance(SignalBusReader *reader);
+SignalBusStatus signal_bus_read(SignalBusReader *reader, SignalBusRecord *record);
+uint64_t signal_bus_lost(const SignalBusReader *reader);
+
+// Tracker state snapshots (warm restarts)
+bool save_pair_tracker_snapshot(const PairTracker *tracker, const char *path);
+PairTracker* load_pair_tracker_snapshot(const char *path);
+PairTracker* load_pair_tracker_snapshot_with_model(const char *path, AttentionModel *model);
+bool save_universe_snapshot(const PairUniverse *universe, const char *path);
+PairUniverse* load_universe_snapshot(const char *path);
+PairUniverse* load_universe_snapshot_with_model(const char *path, AttentionModel *model);
+
+// CSV tick import functions
+CsvImportConfig default_csv_import_config(void);
+bool csv_parse_double(const char *begin, const char *end, double *value);
+bool csv_parse_timestamp(const char *begin, const char *end, int64_t *timestamp_micro);
+bool csv_import(const char *csv_path, const CsvImportConfig *config, const CsvTickSink *sink, CsvImportStats *stats);
+bool csv_import_to_tick_file(const char *csv_path, const char *tick_path, const CsvImportConfig *config,
+                             CsvImportStats *stats);
+bool csv_import_to_universe(const char *csv_path, PairUniverse *universe, const char *const *symbol_names,
+                            const CsvImportConfig *config, CsvImportStats *stats);
+
+// Parameter-sweep backtesting
+bool backtest_expand_grid(const BacktestGrid *grid, BacktestConfig *configs, int max_configs, int *n_configs);
+bool backtest_run(const TickFile *file, int symbol1, int symbol2, const BacktestConfig *configs, int n_configs,
+                  int n_threads, BacktestResult *results);
+bool backtest_run_by_regime(const TickFile *file, int symbol1, int symbol2, const BacktestConfig *configs,
+                            int n_configs, int n_threads, const uint8_t *regimes, long n_regime_steps,
+                            BacktestResult *results);
+void print_backtest_results(const BacktestResult *results, int n_results);
+void print_backtest_regime_results(const BacktestResult *results, int n_results);
+WalkForwardResult* walk_forward_run(const TickFile *file, int symbol1, int symbol2, const BacktestConfig *configs,
+                                    int n_configs, const WalkForwardConfig *config);
+void destroy_walk_forward_result(WalkForwardResult *result);
+void print_walk_forward_result(const WalkForwardResult *result, const BacktestConfig *configs);
+
+// Synthetic market generator (load testing)
+SyntheticUniverseConfig default_synthetic_universe_config(int n_symbols);
+SyntheticUniverse* create_synthetic_universe(const SyntheticUniverseConfig *config);
+void destroy_synthetic_universe(SyntheticUniverse *universe);
+void synthetic_universe_advance(SyntheticUniverse *universe, TickRecord *ticks);
+int synthetic_universe_pairs(const SyntheticUniverse *universe, int n_pairs, int *leg1, int *leg2);
 
 // Pair tracker management functions  
+PairTracker* create_pair_tracker(int window_size);
 PairTracker* create_pair_tracker_with_attention(int window_size);
 PairTracker* create_enhanced_pair_tracker(int window_size, bool use_all_features);
+PairTracker* create_enhanced_pair_tracker_with_model(int window_size, bool use_all_features,
+                                                     AttentionModel *model);
 void destroy_pair_tracker(PairTracker *tracker);
+SignalParams default_signal_params(void);
+void pair_tracker_set_params(PairTracker *tracker, const SignalParams *params);
+bool pair_tracker_set_attention_model(PairTracker *tracker, AttentionModel *model);
+bool pair_tracker_set_regime_model(PairTracker *tracker, const RegimeModelParams *params);
+void tracker_push_spread(PairTracker *tracker, double spread);
 
 #endif
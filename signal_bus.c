@@ -0,0 +1,287 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Single-writer, multi-reader signal ring in POSIX shared memory.
+//
+//   [SignalBusHeader]            one cache line of layout info, one for the cursor
+//   [SignalBusRecord x capacity] 64 bytes each, capacity a power of two
+//
+// Message n (n >= 1) goes to slot (n - 1) & (capacity - 1). The slot's sequence word
+// is a seqlock: 2n - 1 while the writer fills it, 2n once it is complete. Readers
+// map the segment read-only, follow their own cursor and validate the sequence
+// before and after reading, so a slot recycled under them is reported as an
+// overrun instead of being returned torn. The writer never waits for readers;
+// nothing is lost unless a reader falls a full ring behind, and then the reader
+// knows exactly how many messages it missed.
+
+#define SIGNAL_BUS_MAGIC "SAKBUS01"
+#define SIGNAL_BUS_VERSION 1
+#define SIGNAL_BUS_CACHE_LINE 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint8_t pad0[SIGNAL_BUS_CACHE_LINE - 24];
+    uint64_t write_sequence;    // last published message, 0 before the first
+    uint8_t pad1[SIGNAL_BUS_CACHE_LINE - 8];
+} SignalBusHeader;
+
+struct SignalBus {
+    SignalBusHeader *header;
+    SignalBusRecord *records;
+    size_t map_size;
+    uint64_t mask;
+    uint64_t next_sequence;
+    char *name;
+};
+
+struct SignalBusReader {
+    const SignalBusHeader *header;
+    const SignalBusRecord *records;
+    size_t map_size;
+    uint64_t mask;
+    uint64_t capacity;
+    uint64_t next_sequence;     // next message this reader expects
+    uint64_t lost;              // messages skipped after overruns
+};
+
+static size_t bus_map_size(uint64_t capacity) {
+    return sizeof(SignalBusHeader) + capacity * sizeof(SignalBusRecord);
+}
+
+// An existing segment of the same name is only replaced when `replace` is set;
+// otherwise creation fails with errno EEXIST, so a second writer cannot silently
+// orphan the readers of a live bus.
+SignalBus* signal_bus_create(const char *name, int capacity, bool replace) {
+    if (!name || name[0] != '/') return NULL;
+    if (capacity <= 0) capacity = SIGNAL_BUS_DEFAULT_CAPACITY;
+
+    uint64_t slots = 1;
+    while (slots < (uint64_t)capacity) slots <<= 1;
+
+    SignalBus *bus = calloc(1, sizeof(SignalBus));
+    if (!bus) return NULL;
+    bus->name = malloc(strlen(name) + 1);
+    if (!bus->name) {
+        free(bus);
+        return NULL;
+    }
+    strcpy(bus->name, name);
+
+    // always a fresh segment, so stale sequence numbers never confuse readers
+    if (replace) shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        free(bus->name);
+        free(bus);
+        return NULL;
+    }
+
+    bus->map_size = bus_map_size(slots);
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bus->map_size) == 0) {
+        map = mmap(NULL, bus->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        free(bus->name);
+        free(bus);
+        return NULL;
+    }
+
+    // ftruncate zero-fills, so every slot starts with sequence 0 (empty)
+    bus->header = map;
+    bus->records = (SignalBusRecord*)((uint8_t*)map + sizeof(SignalBusHeader));
+    bus->mask = slots - 1;
+    bus->next_sequence = 1;
+
+    memcpy(bus->header->magic, SIGNAL_BUS_MAGIC, 8);
+    bus->header->version = SIGNAL_BUS_VERSION;
+    bus->header->record_size = sizeof(SignalBusRecord);
+    __atomic_store_n(&bus->header->capacity, slots, __ATOMIC_RELEASE);
+
+    return bus;
+}
+
+void signal_bus_destroy(SignalBus *bus, bool unlink_segment) {
+    if (bus) {
+        munmap(bus->header, bus->map_size);
+        if (unlink_segment) shm_unlink(bus->name);
+        free(bus->name);
+        free(bus);
+    }
+}
+
+uint64_t signal_bus_publish(SignalBus *bus, int pair_id, const PairSignal *signal) {
+    if (!bus || !signal) return 0;
+
+    uint64_t n = bus->next_sequence++;
+    SignalBusRecord *slot = &bus->records[(n - 1) & bus->mask];
+
+    // odd sequence marks the slot as being rewritten before any payload store lands
+    __atomic_store_n(&slot->sequence, 2 * n - 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->timestamp_micro = signal->timestamp_micro;
+    slot->pair_id = pair_id;
+    slot->signal = (int8_t)signal->signal;
+    slot->regime = (int8_t)signal->regime;
+    slot->flags = signal->pnl_analysis.is_profitable ? SIGNAL_LOG_FLAG_PROFITABLE : 0;
+    slot->reserved = 0;
+    slot->z_score = signal->z_score;
+    slot->spread = signal->spread;
+    slot->hedge_ratio = signal->hedge_ratio;
+    slot->position_size = signal->position_size;
+    slot->net_pnl = signal->pnl_analysis.net_pnl_after_costs;
+
+    __atomic_store_n(&slot->sequence, 2 * n, __ATOMIC_RELEASE);
+    __atomic_store_n(&bus->header->write_sequence, n, __ATOMIC_RELEASE);
+    return n;
+}
+
+// diagnostics a compact signal does not carry are published as NaN
+uint64_t signal_bus_publish_compact(SignalBus *bus, const PairSignalCompact *signal) {
+    if (!bus || !signal) return 0;
+
+    uint64_t n = bus->next_sequence++;
+    SignalBusRecord *slot = &bus->records[(n - 1) & bus->mask];
+
+    __atomic_store_n(&slot->sequence, 2 * n - 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->timestamp_micro = signal->timestamp_micro;
+    slot->pair_id = signal->pair_id;
+    slot->signal = signal->signal;
+    slot->regime = signal->regime;
+    slot->flags = signal->flags;
+    slot->reserved = 0;
+    slot->z_score = signal->z_score;
+    slot->spread = NAN;
+    slot->hedge_ratio = NAN;
+    slot->position_size = signal->position_size;
+    slot->net_pnl = NAN;
+
+    __atomic_store_n(&slot->sequence, 2 * n, __ATOMIC_RELEASE);
+    __atomic_store_n(&bus->header->write_sequence, n, __ATOMIC_RELEASE);
+    return n;
+}
+
+SignalBusReader* signal_bus_attach(const char *name, bool from_oldest) {
+    if (!name) return NULL;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SignalBusHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const SignalBusHeader *header = map;
+    uint64_t capacity = __atomic_load_n(&header->capacity, __ATOMIC_ACQUIRE);
+    if (memcmp(header->magic, SIGNAL_BUS_MAGIC, 8) != 0 || header->version != SIGNAL_BUS_VERSION ||
+        header->record_size != sizeof(SignalBusRecord) || capacity == 0 ||
+        (capacity & (capacity - 1)) != 0 || bus_map_size(capacity) > size) {
+        munmap(map, size);
+        return NULL;
+    }
+
+    SignalBusReader *reader = calloc(1, sizeof(SignalBusReader));
+    if (!reader) {
+        munmap(map, size);
+        return NULL;
+    }
+    reader->header = header;
+    reader->records = (const SignalBusRecord*)((const uint8_t*)map + sizeof(SignalBusHeader));
+    reader->map_size = size;
+    reader->capacity = capacity;
+    reader->mask = capacity - 1;
+
+    uint64_t head = __atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE);
+    if (from_oldest) {
+        reader->next_sequence = head > capacity ? head - capacity + 1 : 1;
+    } else {
+        reader->next_sequence = head + 1; // only messages published from now on
+    }
+
+    return reader;
+}
+
+void signal_bus_detach(SignalBusReader *reader) {
+    if (reader) {
+        munmap((void*)reader->header, reader->map_size);
+        free(reader);
+    }
+}
+
+// skip to the oldest message the writer can not yet have overwritten
+static void resync_reader(SignalBusReader *reader) {
+    uint64_t head = __atomic_load_n(&reader->header->write_sequence, __ATOMIC_ACQUIRE);
+    uint64_t oldest = head > reader->capacity ? head - reader->capacity + 1 : 1;
+    if (oldest > reader->next_sequence) {
+        reader->lost += oldest - reader->next_sequence;
+        reader->next_sequence = oldest;
+    }
+}
+
+const SignalBusRecord* signal_bus_peek(SignalBusReader *reader, SignalBusStatus *status) {
+    if (!reader) return NULL;
+
+    const SignalBusRecord *slot = &reader->records[(reader->next_sequence - 1) & reader->mask];
+    uint64_t expected = 2 * reader->next_sequence;
+    uint64_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+    if (seq == expected) {
+        if (status) *status = SIGNAL_BUS_OK;
+        return slot;
+    }
+    if (seq > expected) {
+        if (status) *status = SIGNAL_BUS_OVERRUN;
+        resync_reader(reader);
+        return NULL;
+    }
+    if (status) *status = SIGNAL_BUS_EMPTY;
+    return NULL;
+}
+
+SignalBusStatus signal_bus_advance(SignalBusReader *reader) {
+    if (!reader) return SIGNAL_BUS_EMPTY;
+
+    const SignalBusRecord *slot = &reader->records[(reader->next_sequence - 1) & reader->mask];
+
+    // payload reads must complete before the sequence is re-checked
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    if (seq != 2 * reader->next_sequence) {
+        resync_reader(reader);
+        return SIGNAL_BUS_OVERRUN;
+    }
+
+    reader->next_sequence++;
+    return SIGNAL_BUS_OK;
+}
+
+SignalBusStatus signal_bus_read(SignalBusReader *reader, SignalBusRecord *record) {
+    SignalBusStatus status;
+    const SignalBusRecord *slot = signal_bus_peek(reader, &status);
+    if (!slot) return status;
+
+    memcpy(record, slot, sizeof(SignalBusRecord));
+    return signal_bus_advance(reader);
+}
+
+uint64_t signal_bus_lost(const SignalBusReader *reader) {
+    return reader ? reader->lost : 0;
+}
@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Asynchronous columnar signal log, native byte order:
+//
+//   [SignalLogHeader]
+//   [chunk]...     SignalLogChunkHeader, then columns, each 8-byte aligned:
+//                    timestamps   zigzag varint deltas (first one against first_timestamp)
+//                    pair_id      int32[count]
+//                    signal       int8[count]
+//                    regime       int8[count]
+//                    flags        uint8[count]
+//                    z_score, spread, correlation, hedge_ratio, position_size, net_pnl
+//                                 double[count] each
+//
+// The signal thread only copies fields into raw column arrays of the active chunk.
+// Full chunks are queued to a background thread, which delta-encodes timestamps and
+// writes them out. The hot path takes a lock once per chunk, not per signal.
+
+#define SIGNAL_LOG_MAGIC "SAKSLOG1"
+#define SIGNAL_LOG_VERSION 1
+#define SIGNAL_LOG_BUFFERS 4
+#define SIGNAL_LOG_DOUBLE_COLUMNS 6
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t chunk_capacity;
+} SignalLogHeader;
+
+typedef struct {
+    uint32_t count;
+    uint32_t timestamp_bytes;   // encoded size of the timestamp column
+    int64_t first_timestamp;
+    uint64_t chunk_bytes;       // header included, so readers can skip chunks
+} SignalLogChunkHeader;
+
+typedef struct {
+    int64_t *timestamp;
+    int32_t *pair_id;
+    int8_t *signal;
+    int8_t *regime;
+    uint8_t *flags;
+    double *columns[SIGNAL_LOG_DOUBLE_COLUMNS];
+    int count;
+} SignalLogChunk;
+
+struct SignalLog {
+    FILE *fp;
+    int chunk_capacity;
+    SignalLogChunk chunks[SIGNAL_LOG_BUFFERS];
+    SignalLogChunk *active;             // owned by the appending thread
+    int free_list[SIGNAL_LOG_BUFFERS];  // guarded by lock
+    int n_free;
+    int queue[SIGNAL_LOG_BUFFERS];      // full chunks in append order
+    int queue_head;
+    int queue_count;
+    bool closing;
+    bool failed;
+    pthread_mutex_t lock;
+    pthread_cond_t has_work;
+    pthread_cond_t has_free;
+    pthread_t flusher;
+    uint8_t *encode_buffer;             // flusher-only scratch
+    SignalLogStats stats;
+};
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static size_t encode_varint(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static size_t decode_varint(const uint8_t *in, const uint8_t *end, uint64_t *v) {
+    uint64_t result = 0;
+    int shift = 0;
+    size_t n = 0;
+    while (in + n < end && shift < 64) {
+        uint8_t byte = in[n++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *v = result;
+            return n;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+static void log_write(SignalLog *log, const void *data, size_t bytes) {
+    static const uint8_t zeros[8] = {0};
+    if (log->failed) return;
+    if (fwrite(data, 1, bytes, log->fp) != bytes ||
+        fwrite(zeros, 1, align8(bytes) - bytes, log->fp) != align8(bytes) - bytes) {
+        log->failed = true;
+        return;
+    }
+    log->stats.bytes_written += align8(bytes);
+}
+
+static void write_chunk(SignalLog *log, const SignalLogChunk *c) {
+    size_t n = (size_t)c->count;
+
+    // zigzag deltas make small steps (either direction) one or two bytes
+    size_t ts_bytes = 0;
+    int64_t prev = c->timestamp[0];
+    for (size_t i = 0; i < n; i++) {
+        int64_t delta = c->timestamp[i] - prev;
+        uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+        ts_bytes += encode_varint(log->encode_buffer + ts_bytes, zigzag);
+        prev = c->timestamp[i];
+    }
+
+    SignalLogChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.count = (uint32_t)n;
+    header.timestamp_bytes = (uint32_t)ts_bytes;
+    header.first_timestamp = c->timestamp[0];
+    header.chunk_bytes = align8(sizeof(header)) + align8(ts_bytes) + align8(n * sizeof(int32_t)) +
+                         3 * align8(n) + SIGNAL_LOG_DOUBLE_COLUMNS * align8(n * sizeof(double));
+
+    log_write(log, &header, sizeof(header));
+    log_write(log, log->encode_buffer, ts_bytes);
+    log_write(log, c->pair_id, n * sizeof(int32_t));
+    log_write(log, c->signal, n);
+    log_write(log, c->regime, n);
+    log_write(log, c->flags, n);
+    for (int k = 0; k < SIGNAL_LOG_DOUBLE_COLUMNS; k++) {
+        log_write(log, c->columns[k], n * sizeof(double));
+    }
+}
+
+static void* flusher_main(void *arg) {
+    SignalLog *log = arg;
+
+    pthread_mutex_lock(&log->lock);
+    for (;;) {
+        while (log->queue_count == 0 && !log->closing) {
+            pthread_cond_wait(&log->has_work, &log->lock);
+        }
+        if (log->queue_count == 0 && log->closing) break;
+
+        int index = log->queue[log->queue_head];
+        log->queue_head = (log->queue_head + 1) % SIGNAL_LOG_BUFFERS;
+        log->queue_count--;
+        pthread_mutex_unlock(&log->lock);
+
+        SignalLogChunk *chunk = &log->chunks[index];
+        write_chunk(log, chunk);
+        log->stats.chunks_written++;
+        log->stats.signals_written += (uint64_t)chunk->count;
+        chunk->count = 0;
+
+        pthread_mutex_lock(&log->lock);
+        log->free_list[log->n_free++] = index;
+        pthread_cond_signal(&log->has_free);
+    }
+    pthread_mutex_unlock(&log->lock);
+
+    if (fflush(log->fp) != 0) log->failed = true;
+    return NULL;
+}
+
+static void destroy_chunk(SignalLogChunk *c) {
+    free(c->timestamp);
+    free(c->pair_id);
+    free(c->signal);
+    free(c->regime);
+    free(c->flags);
+    for (int k = 0; k < SIGNAL_LOG_DOUBLE_COLUMNS; k++) free(c->columns[k]);
+}
+
+static bool create_chunk(SignalLogChunk *c, int capacity) {
+    memset(c, 0, sizeof(*c));
+    c->timestamp = malloc(capacity * sizeof(int64_t));
+    c->pair_id = malloc(capacity * sizeof(int32_t));
+    c->signal = malloc(capacity);
+    c->regime = malloc(capacity);
+    c->flags = malloc(capacity);
+    bool ok = c->timestamp && c->pair_id && c->signal && c->regime && c->flags;
+    for (int k = 0; k < SIGNAL_LOG_DOUBLE_COLUMNS; k++) {
+        c->columns[k] = malloc(capacity * sizeof(double));
+        if (!c->columns[k]) ok = false;
+    }
+    if (!ok) return false;
+
+    // touch every page now so the first appends do not take page faults
+    memset(c->timestamp, 0, capacity * sizeof(int64_t));
+    memset(c->pair_id, 0, capacity * sizeof(int32_t));
+    memset(c->signal, 0, capacity);
+    memset(c->regime, 0, capacity);
+    memset(c->flags, 0, capacity);
+    for (int k = 0; k < SIGNAL_LOG_DOUBLE_COLUMNS; k++) memset(c->columns[k], 0, capacity * sizeof(double));
+    return true;
+}
+
+static void free_signal_log(SignalLog *log) {
+    for (int i = 0; i < SIGNAL_LOG_BUFFERS; i++) destroy_chunk(&log->chunks[i]);
+    free(log->encode_buffer);
+    free(log);
+}
+
+SignalLog* signal_log_open(const char *path, int chunk_capacity) {
+    if (!path) return NULL;
+    if (chunk_capacity <= 0) chunk_capacity = SIGNAL_LOG_DEFAULT_CHUNK;
+
+    SignalLog *log = calloc(1, sizeof(SignalLog));
+    if (!log) return NULL;
+    log->chunk_capacity = chunk_capacity;
+
+    bool ok = true;
+    for (int i = 0; i < SIGNAL_LOG_BUFFERS; i++) {
+        if (!create_chunk(&log->chunks[i], chunk_capacity)) ok = false;
+    }
+    log->encode_buffer = malloc((size_t)chunk_capacity * 10); // worst-case varint length
+    if (!ok || !log->encode_buffer) {
+        free_signal_log(log);
+        return NULL;
+    }
+
+    log->fp = fopen(path, "wb");
+    if (!log->fp) {
+        free_signal_log(log);
+        return NULL;
+    }
+
+    SignalLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SIGNAL_LOG_MAGIC, 8);
+    header.version = SIGNAL_LOG_VERSION;
+    header.chunk_capacity = (uint32_t)chunk_capacity;
+    log_write(log, &header, sizeof(header));
+
+    log->active = &log->chunks[0];
+    for (int i = 1; i < SIGNAL_LOG_BUFFERS; i++) log->free_list[log->n_free++] = i;
+
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->has_work, NULL);
+    pthread_cond_init(&log->has_free, NULL);
+    if (log->failed || pthread_create(&log->flusher, NULL, flusher_main, log) != 0) {
+        pthread_mutex_destroy(&log->lock);
+        pthread_cond_destroy(&log->has_work);
+        pthread_cond_destroy(&log->has_free);
+        fclose(log->fp);
+        free_signal_log(log);
+        return NULL;
+    }
+
+    return log;
+}
+
+// hands the active chunk to the flusher and takes a free one
+static void rotate_chunk(SignalLog *log) {
+    pthread_mutex_lock(&log->lock);
+    int index = (int)(log->active - log->chunks);
+    log->queue[(log->queue_head + log->queue_count) % SIGNAL_LOG_BUFFERS] = index;
+    log->queue_count++;
+    pthread_cond_signal(&log->has_work);
+
+    if (log->n_free == 0) {
+        log->stats.stalls++; // disk is behind: block rather than drop signals
+        while (log->n_free == 0) pthread_cond_wait(&log->has_free, &log->lock);
+    }
+    log->active = &log->chunks[log->free_list[--log->n_free]];
+    pthread_mutex_unlock(&log->lock);
+}
+
+void signal_log_append(SignalLog *log, int pair_id, const PairSignal *signal) {
+    if (!log || !signal) return;
+
+    SignalLogChunk *c = log->active;
+    int i = c->count;
+    c->timestamp[i] = signal->timestamp_micro;
+    c->pair_id[i] = pair_id;
+    c->signal[i] = (int8_t)signal->signal;
+    c->regime[i] = (int8_t)signal->regime;
+    c->flags[i] = signal->pnl_analysis.is_profitable ? SIGNAL_LOG_FLAG_PROFITABLE : 0;
+    c->columns[0][i] = signal->z_score;
+    c->columns[1][i] = signal->spread;
+    c->columns[2][i] = signal->correlation;
+    c->columns[3][i] = signal->hedge_ratio;
+    c->columns[4][i] = signal->position_size;
+    c->columns[5][i] = signal->pnl_analysis.net_pnl_after_costs;
+    c->count = i + 1;
+    log->stats.signals_appended++;
+
+    if (c->count == log->chunk_capacity) rotate_chunk(log);
+}
+
+// Compact signals carry no spread, correlation, hedge ratio or net P&L; those
+// columns are written as NaN so readers can tell them from real zeros.
+void signal_log_append_compact(SignalLog *log, const PairSignalCompact *signal) {
+    if (!log || !signal) return;
+
+    SignalLogChunk *c = log->active;
+    int i = c->count;
+    c->timestamp[i] = signal->timestamp_micro;
+    c->pair_id[i] = signal->pair_id;
+    c->signal[i] = signal->signal;
+    c->regime[i] = signal->regime;
+    c->flags[i] = signal->flags;
+    c->columns[0][i] = signal->z_score;
+    c->columns[1][i] = NAN;
+    c->columns[2][i] = NAN;
+    c->columns[3][i] = NAN;
+    c->columns[4][i] = signal->position_size;
+    c->columns[5][i] = NAN;
+    c->count = i + 1;
+    log->stats.signals_appended++;
+
+    if (c->count == log->chunk_capacity) rotate_chunk(log);
+}
+
+bool signal_log_close(SignalLog *log, SignalLogStats *stats) {
+    if (!log) return false;
+
+    if (log->active->count > 0) rotate_chunk(log);
+
+    pthread_mutex_lock(&log->lock);
+    log->closing = true;
+    pthread_cond_signal(&log->has_work);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->flusher, NULL);
+
+    bool ok = !log->failed;
+    if (fclose(log->fp) != 0) ok = false;
+    if (stats) *stats = log->stats;
+
+    pthread_mutex_destroy(&log->lock);
+    pthread_cond_destroy(&log->has_work);
+    pthread_cond_destroy(&log->has_free);
+    free_signal_log(log);
+    return ok;
+}
+
+// bytes the chunk's columns span, header included; 64-bit, so it cannot wrap
+static uint64_t chunk_extent(const SignalLogChunkHeader *chunk) {
+    uint64_t n = chunk->count;
+    return align8(sizeof(*chunk)) + align8(chunk->timestamp_bytes) + align8(n * sizeof(int32_t)) +
+           3 * align8(n) + SIGNAL_LOG_DOUBLE_COLUMNS * align8(n * sizeof(double));
+}
+
+long signal_log_replay(const char *path, SignalLogCallback callback, void *ctx) {
+    if (!path) return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SignalLogHeader)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    const uint8_t *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    posix_madvise((void*)map, size, POSIX_MADV_SEQUENTIAL);
+
+    const SignalLogHeader *header = (const SignalLogHeader*)map;
+    if (memcmp(header->magic, SIGNAL_LOG_MAGIC, 8) != 0 || header->version != SIGNAL_LOG_VERSION) {
+        munmap((void*)map, size);
+        return -1;
+    }
+
+    long n_records = 0;
+    size_t pos = align8(sizeof(SignalLogHeader));
+    while (pos + sizeof(SignalLogChunkHeader) <= size) {
+        SignalLogChunkHeader chunk;
+        memcpy(&chunk, map + pos, sizeof(chunk));
+        if (chunk.chunk_bytes > size - pos) break; // truncated tail
+        // a corrupt header stops replay: a zero length would never advance, and the
+        // columns must lie inside the chunk before any of them is read
+        if (chunk.chunk_bytes < align8(sizeof(chunk)) || chunk_extent(&chunk) > chunk.chunk_bytes) break;
+
+        size_t n = chunk.count;
+        const uint8_t *p = map + pos + align8(sizeof(chunk));
+        const uint8_t *ts = p;
+        const uint8_t *ts_end = ts + chunk.timestamp_bytes;
+        p += align8(chunk.timestamp_bytes);
+        const int32_t *pair_id = (const int32_t*)p;
+        p += align8(n * sizeof(int32_t));
+        const int8_t *sig = (const int8_t*)p;
+        p += align8(n);
+        const int8_t *regime = (const int8_t*)p;
+        p += align8(n);
+        const uint8_t *flags = p;
+        p += align8(n);
+        const double *columns[SIGNAL_LOG_DOUBLE_COLUMNS];
+        for (int k = 0; k < SIGNAL_LOG_DOUBLE_COLUMNS; k++) {
+            columns[k] = (const double*)p;
+            p += align8(n * sizeof(double));
+        }
+
+        int64_t timestamp = chunk.first_timestamp;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t zigzag;
+            size_t used = decode_varint(ts, ts_end, &zigzag);
+            if (!used) break;
+            ts += used;
+            timestamp += (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+
+            SignalLogRecord record;
+            record.timestamp_micro = timestamp;
+            record.pair_id = pair_id[i];
+            record.signal = sig[i];
+            record.regime = regime[i];
+            record.flags = flags[i];
+            record.z_score = columns[0][i];
+            record.spread = columns[1][i];
+            record.correlation = columns[2][i];
+            record.hedge_ratio = columns[3][i];
+            record.position_size = columns[4][i];
+            record.net_pnl = columns[5][i];
+            if (callback) callback(ctx, &record);
+            n_records++;
+        }
+        pos += chunk.chunk_bytes;
+    }
+
+    munmap((void*)map, size);
+    return n_records;
+}
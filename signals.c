@@ -13,7 +13,7 @@ PairSignal generate_pairs_signal(PairTracker *tracker, double current_price1, do
     
     // calc spread
     double current_spread = log(current_price1) - log(current_price2);
-    cb_push(tracker->spread_buffer, current_spread);
+    tracker_push_spread(tracker, current_spread);
     
     // rolling stats
     tracker->mean_spread = rolling_mean(tracker->spread_buffer);
@@ -24,7 +24,7 @@ PairSignal generate_pairs_signal(PairTracker *tracker, double current_price1, do
     double z_score = calculate_z_score(current_spread, tracker->mean_spread, tracker->std_spread);
     
     // Generate signal based on z-score thresholds
-    int trade_signal = mean_reversion_signal(z_score, 2.0, 0.5);
+    int trade_signal = mean_reversion_step(&tracker->position, z_score, 2.0, 0.5);
     
     // Fill signal structure
     signal.spread = current_spread;
@@ -53,7 +53,7 @@ PairSignal generate_pairs_signal_with_attention(PairTracker *tracker, double cur
     
     // Calculate current spread
     double current_spread = log(current_price1) - log(current_price2);
-    cb_push(tracker->spread_buffer, current_spread);
+    tracker_push_spread(tracker, current_spread);
     
     // Update rolling statistics
     tracker->mean_spread = rolling_mean(tracker->spread_buffer);
@@ -65,18 +65,18 @@ PairSignal generate_pairs_signal_with_attention(PairTracker *tracker, double cur
     
     // enhanced z-score w/ attention if enabled  
     if (tracker->use_attention && tracker->temporal_attention && cb_size(tracker->spread_buffer) >= 10) {
-        tracker->attention_enhanced_zscore = calculate_attention_enhanced_zscore(
-            tracker->spread_buffer, tracker->temporal_attention);
+        tracker->attention_enhanced_zscore = attention_stream_zscore(
+            &tracker->attention_stream, tracker->spread_buffer, tracker->temporal_attention);
         
         // blend trad + attention z-scores
-        double blend_factor = 0.7; // 70% attn, 30% trad
+        double blend_factor = tracker->params.attention_blend;
         z_score = blend_factor * tracker->attention_enhanced_zscore + (1 - blend_factor) * z_score;
     } else {
         tracker->attention_enhanced_zscore = z_score;
     }
     
     // Generate signal based on enhanced z-score thresholds
-    int trade_signal = mean_reversion_signal(z_score, 2.0, 0.5);
+    int trade_signal = mean_reversion_step(&tracker->position, z_score, 2.0, 0.5);
     
     // Fill signal structure
     signal.spread = current_spread;
@@ -94,27 +94,33 @@ PairSignal generate_pairs_signal_with_attention(PairTracker *tracker, double cur
 
 int mean_reversion_signal(double z_score, double entry_threshold, double exit_threshold) {
     static int current_position = 0; // 0: no position, 1: long, -1: short
+    return mean_reversion_step(&current_position, z_score, entry_threshold, exit_threshold);
+}
+
+// position state is owned by the caller (one per tracker)
+int mean_reversion_step(int *position, double z_score, double entry_threshold, double exit_threshold) {
+    int current_position = *position;
     
     // Entry signals
     if (current_position == 0) {
         if (z_score > entry_threshold) {
-            current_position = -1; // Short spread (short asset1, long asset2)
+            *position = -1; // Short spread (short asset1, long asset2)
             return -1;
         } else if (z_score < -entry_threshold) {
-            current_position = 1;  // Long spread (long asset1, short asset2)
+            *position = 1;  // Long spread (long asset1, short asset2)
             return 1;
         }
     }
     // Exit signals
     else if (current_position == 1) {
         if (z_score > -exit_threshold) {
-            current_position = 0;
+            *position = 0;
             return 0; // Close long position
         }
     }
     else if (current_position == -1) {
         if (z_score < exit_threshold) {
-            current_position = 0;
+            *position = 0;
             return 0; // Close short position
         }
     }
@@ -136,22 +142,77 @@ void print_pair_signal(PairSignal *signal) {
            signal->correlation, signal_str);
 }
 
-PairSignal generate_enhanced_pairs_signal(PairTracker *tracker, double price1, double price2,
-                                        double bid1, double ask1, double bid2, double ask2, long timestamp_micro) {
-    PairSignal signal = {0};
-    
-    if (!tracker || !tracker->price_buffer1 || !tracker->price_buffer2) {
-        return signal;
+// RMS log return of each leg over the window, from the return prefix sums when the
+// tracker keeps them and from the price rings otherwise. False until more than five
+// returns are in.
+static bool window_return_volatility(PairTracker *tracker, double *vol1, double *vol2) {
+    if (tracker->return_prefix) {
+        PrefixWindow returns = pb_window(tracker->return_prefix, tracker->window_size);
+        if (returns.n <= 5) return false;
+        double scale = (returns.n - 1.0) / returns.n;
+        *vol1 = sqrt(returns.var_x * scale + returns.mean_x * returns.mean_x);
+        *vol2 = sqrt(returns.var_y * scale + returns.mean_y * returns.mean_y);
+        return true;
+    }
+
+    int n = cb_size(tracker->price_buffer1);
+    if (n - 1 <= 5) return false;
+    double sum1 = 0.0, sum2 = 0.0;
+    for (int i = 1; i < n; i++) {
+        double r1 = log(cb_get(tracker->price_buffer1, i) / cb_get(tracker->price_buffer1, i - 1));
+        double r2 = log(cb_get(tracker->price_buffer2, i) / cb_get(tracker->price_buffer2, i - 1));
+        sum1 += r1 * r1;
+        sum2 += r2 * r2;
     }
+    *vol1 = sqrt(sum1 / (n - 1));
+    *vol2 = sqrt(sum2 / (n - 1));
+    return true;
+}
+
+// Body of the enhanced signal, specialized per feature mask. Every caller passes a
+// compile-time constant `features`, so disabled stages fold away after inlining.
+#if defined(__GNUC__)
+#define SIGNAL_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define SIGNAL_ALWAYS_INLINE inline
+#endif
+
+static SIGNAL_ALWAYS_INLINE PairSignalCompact enhanced_signal_body(PairTracker *tracker, double price1, double price2,
+                                                                   double bid1, double ask1, double bid2, double ask2,
+                                                                   long timestamp_micro, const int features) {
+    PairSignalCompact signal;
+    uint8_t flags = 0;
+    PROFILE_BEGIN(tracker);
     
     // update price buffers
     cb_push(tracker->price_buffer1, price1);
     cb_push(tracker->price_buffer2, price2);
     
-    // calc dynamic hedge ratio if enabled
-    if (tracker->use_dynamic_hedging && cb_size(tracker->price_buffer1) >= 20) {
-        tracker->current_hedge_ratio = calculate_dynamic_hedge_ratio(
-            tracker->price_buffer1, tracker->price_buffer2, 20);
+    // log returns feed the rolling hedge regression and the volatility estimate
+    int n_prices = cb_size(tracker->price_buffer1);
+    double ret1 = 0.0, ret2 = 0.0;
+    if (n_prices >= 2) {
+        ret1 = log(price1 / cb_get(tracker->price_buffer1, n_prices - 2));
+        ret2 = log(price2 / cb_get(tracker->price_buffer2, n_prices - 2));
+        if (tracker->return_prefix) pb_push(tracker->return_prefix, ret1, ret2);
+    }
+    PROFILE_STAGE(tracker, LATENCY_STAGE_PUSH);
+    
+    // calc dynamic hedge ratio if enabled; the Kalman filter updates in O(1) and
+    // takes over from the 1:1 hedge once it has seen hedge_lookback quotes
+    int hedge_lookback = tracker->params.hedge_lookback;
+    if (features & SIGNAL_FEATURE_KALMAN_HEDGE) {
+        kalman_hedge_update(&tracker->hedge_filter, price1, price2);
+        if (tracker->hedge_filter.n_updates >= hedge_lookback) {
+            tracker->current_hedge_ratio = tracker->hedge_filter.beta;
+            cb_push(tracker->hedge_ratio_buffer, tracker->current_hedge_ratio);
+        } else {
+            tracker->current_hedge_ratio = 1.0;
+        }
+    } else if ((features & SIGNAL_FEATURE_HEDGING) && n_prices >= hedge_lookback) {
+        tracker->current_hedge_ratio = tracker->return_prefix
+            ? prefix_dynamic_hedge_ratio(tracker->return_prefix, hedge_lookback)
+            : calculate_dynamic_hedge_ratio(tracker->price_buffer1, tracker->price_buffer2, hedge_lookback);
         cb_push(tracker->hedge_ratio_buffer, tracker->current_hedge_ratio);
     } else {
         tracker->current_hedge_ratio = 1.0;
@@ -159,31 +220,26 @@ PairSignal generate_enhanced_pairs_signal(PairTracker *tracker, double price1, d
     
     // calc spread using dynamic hedge ratio
     double current_spread = price1 - tracker->current_hedge_ratio * price2;
-    cb_push(tracker->spread_buffer, current_spread);
-    
-    // calc volatilities for both assets
-    if (cb_size(tracker->price_buffer1) >= 2) {
-        double ret1 = log(price1 / cb_get(tracker->price_buffer1, cb_size(tracker->price_buffer1) - 2));
-        double ret2 = log(price2 / cb_get(tracker->price_buffer2, cb_size(tracker->price_buffer2) - 2));
-        cb_push(tracker->volatility1_buffer, ret1 * ret1);
-        cb_push(tracker->volatility2_buffer, ret2 * ret2);
-    }
+    tracker_push_spread(tracker, current_spread);
+    PROFILE_STAGE(tracker, LATENCY_STAGE_HEDGE);
     
     // update rolling stats with SIMD if available
     tracker->mean_spread = simd_cb_rolling_mean(tracker->spread_buffer);
     tracker->std_spread = simd_cb_rolling_std(tracker->spread_buffer);
     tracker->correlation = simd_cb_correlation(tracker->price_buffer1, tracker->price_buffer2);
+    PROFILE_STAGE(tracker, LATENCY_STAGE_STATS);
     
     // update regime detection
-    if (tracker->use_regime_detection && tracker->regime_detector) {
+    if (features & SIGNAL_FEATURE_REGIME) {
         update_regime(tracker->regime_detector, price1, price2, tracker->correlation);
+        PROFILE_STAGE(tracker, LATENCY_STAGE_REGIME);
     }
     
-    // calc dynamic thresholds based on current volatility
+    // calc dynamic thresholds based on current volatility: the RMS log return over
+    // the window, from the same prefix sums as the hedge regression
     double vol_factor = 1.0;
-    if (cb_size(tracker->volatility1_buffer) > 5) {
-        double vol1 = sqrt(rolling_mean(tracker->volatility1_buffer));
-        double vol2 = sqrt(rolling_mean(tracker->volatility2_buffer));
+    double vol1, vol2;
+    if (window_return_volatility(tracker, &vol1, &vol2)) {
         vol_factor = (vol1 + vol2) / 0.02; // normalize around 2% daily vol
     }
     
@@ -191,27 +247,31 @@ PairSignal generate_enhanced_pairs_signal(PairTracker *tracker, double price1, d
     
     // calc z-score
     double z_score = calculate_z_score(current_spread, tracker->mean_spread, tracker->std_spread);
+    PROFILE_STAGE(tracker, LATENCY_STAGE_THRESHOLDS);
     
     // enhanced z-score w/ attention if enabled
-    if (tracker->use_attention && tracker->temporal_attention && cb_size(tracker->spread_buffer) >= 10) {
-        tracker->attention_enhanced_zscore = calculate_attention_enhanced_zscore(
-            tracker->spread_buffer, tracker->temporal_attention);
+    if ((features & SIGNAL_FEATURE_ATTENTION) && cb_size(tracker->spread_buffer) >= 10) {
+        tracker->attention_enhanced_zscore = attention_stream_zscore(
+            &tracker->attention_stream, tracker->spread_buffer, tracker->temporal_attention);
         
         // blend traditional + attention z-scores
-        double blend_factor = 0.7; // 70% attn, 30% trad
+        double blend_factor = tracker->params.attention_blend;
         z_score = blend_factor * tracker->attention_enhanced_zscore + (1 - blend_factor) * z_score;
+        PROFILE_STAGE(tracker, LATENCY_STAGE_ATTENTION);
     } else {
         tracker->attention_enhanced_zscore = z_score;
     }
     
     // generate signal using dynamic thresholds
-    int trade_signal = mean_reversion_signal(z_score, tracker->dynamic_entry_threshold, tracker->dynamic_exit_threshold);
+    int trade_signal = mean_reversion_step(&tracker->position, z_score,
+                                           tracker->dynamic_entry_threshold, tracker->dynamic_exit_threshold);
     
     // calc position size using volatility targeting if risk manager available
     double position_size = 10000.0; // default
-    if (tracker->risk_manager) {
-        // adjust target vol based on current regime
-        if (tracker->regime_detector) {
+    if (features & SIGNAL_FEATURE_RISK) {
+        // adjust target vol based on current regime, always from the configured base
+        if (features & SIGNAL_FEATURE_REGIME) {
+            tracker->risk_manager->target_volatility = tracker->params.target_volatility;
             double regime_adjusted_target = calculate_regime_adjusted_target_vol(
                 tracker->risk_manager, tracker->regime_detector->current_regime);
             tracker->risk_manager->target_volatility = regime_adjusted_target;
@@ -224,46 +284,186 @@ PairSignal generate_enhanced_pairs_signal(PairTracker *tracker, double price1, d
             double recent_return = (current_spread - cb_get(tracker->spread_buffer, cb_size(tracker->spread_buffer) - 2)) / position_size;
             update_volatility_estimate(tracker->risk_manager, recent_return);
         }
+        
+        if ((features & SIGNAL_FEATURE_KALMAN_HEDGE) && tracker->hedge_filter.n_updates >= hedge_lookback) {
+            position_size *= kalman_hedge_size_factor(&tracker->hedge_filter, price2, tracker->std_spread,
+                                                      tracker->params.hedge_uncertainty_weight);
+        }
     }
+    PROFILE_STAGE(tracker, LATENCY_STAGE_SIZING);
     
     // check transaction costs if enabled
-    PnLAnalysis pnl_analysis = {0};
-    if (tracker->use_transaction_costs) {
+    if (features & SIGNAL_FEATURE_COSTS) {
         // update transaction costs with current spreads
         tracker->transaction_costs.bid_ask_spread_asset1 = ask1 - bid1;
         tracker->transaction_costs.bid_ask_spread_asset2 = ask2 - bid2;
         
         double theoretical_pnl = fabs(z_score) * 0.3 * position_size; // rough estimate
-        pnl_analysis = calculate_pnl_with_costs(theoretical_pnl, &tracker->transaction_costs, position_size);
+        PnLAnalysis pnl_analysis = calculate_pnl_with_costs(theoretical_pnl, &tracker->transaction_costs, position_size);
         
         // override signal if not profitable after costs
-        if (!pnl_analysis.is_profitable) {
+        if (pnl_analysis.is_profitable) {
+            flags |= PAIR_SIGNAL_FLAG_PROFITABLE;
+        } else {
+            if (trade_signal != 0) flags |= PAIR_SIGNAL_FLAG_COST_VETO;
             trade_signal = 0;
         }
+        PROFILE_STAGE(tracker, LATENCY_STAGE_COSTS);
     }
+    PROFILE_END(tracker);
     
-    // fill enhanced signal structure
-    signal.spread = current_spread;
+    // keep the step's outputs; everything else the full view needs is already tracker state
+    tracker->last_z_score = z_score;
+    tracker->last_position_size = position_size;
+    tracker->last_signal = trade_signal;
+    tracker->last_update_micro = timestamp_micro;
+    
+    signal.timestamp_micro = timestamp_micro;
+    signal.pair_id = tracker->pair_id;
+    signal.signal = (int8_t)trade_signal;
+    signal.regime = (features & SIGNAL_FEATURE_REGIME) ? (int8_t)tracker->regime_detector->current_regime : 0;
+    signal.flags = flags;
+    signal.reserved = 0;
     signal.z_score = z_score;
+    signal.position_size = position_size;
+    
+    return signal;
+}
+
+// one out-of-line function per feature mask: hi selects bits 3-5, lo bits 0-2
+#define DEFINE_SIGNAL_VARIANT(hi, lo) \
+    static PairSignalCompact enhanced_signal_variant_##hi##_##lo(PairTracker *tracker, double price1, double price2, \
+                                                         double bid1, double ask1, double bid2, double ask2, \
+                                                         long timestamp_micro) { \
+        return enhanced_signal_body(tracker, price1, price2, bid1, ask1, bid2, ask2, \
+                                    timestamp_micro, ((hi) << 3) | (lo)); \
+    }
+
+#define DEFINE_SIGNAL_VARIANT_ROW(hi) \
+    DEFINE_SIGNAL_VARIANT(hi, 0) DEFINE_SIGNAL_VARIANT(hi, 1) DEFINE_SIGNAL_VARIANT(hi, 2) \
+    DEFINE_SIGNAL_VARIANT(hi, 3) DEFINE_SIGNAL_VARIANT(hi, 4) DEFINE_SIGNAL_VARIANT(hi, 5) \
+    DEFINE_SIGNAL_VARIANT(hi, 6) DEFINE_SIGNAL_VARIANT(hi, 7)
+
+#define SIGNAL_VARIANT_ROW_REFS(hi) \
+    enhanced_signal_variant_##hi##_0, enhanced_signal_variant_##hi##_1, \
+    enhanced_signal_variant_##hi##_2, enhanced_signal_variant_##hi##_3, \
+    enhanced_signal_variant_##hi##_4, enhanced_signal_variant_##hi##_5, \
+    enhanced_signal_variant_##hi##_6, enhanced_signal_variant_##hi##_7
+
+DEFINE_SIGNAL_VARIANT_ROW(0)
+DEFINE_SIGNAL_VARIANT_ROW(1)
+DEFINE_SIGNAL_VARIANT_ROW(2)
+DEFINE_SIGNAL_VARIANT_ROW(3)
+DEFINE_SIGNAL_VARIANT_ROW(4)
+DEFINE_SIGNAL_VARIANT_ROW(5)
+DEFINE_SIGNAL_VARIANT_ROW(6)
+DEFINE_SIGNAL_VARIANT_ROW(7)
+
+static const PairSignalFn signal_variants[SIGNAL_FEATURE_COUNT] = {
+    SIGNAL_VARIANT_ROW_REFS(0),
+    SIGNAL_VARIANT_ROW_REFS(1),
+    SIGNAL_VARIANT_ROW_REFS(2),
+    SIGNAL_VARIANT_ROW_REFS(3),
+    SIGNAL_VARIANT_ROW_REFS(4),
+    SIGNAL_VARIANT_ROW_REFS(5),
+    SIGNAL_VARIANT_ROW_REFS(6),
+    SIGNAL_VARIANT_ROW_REFS(7)
+};
+
+int pair_tracker_feature_mask(const PairTracker *tracker) {
+    if (!tracker) return 0;
+    
+    int features = 0;
+    if (tracker->use_attention && tracker->temporal_attention) features |= SIGNAL_FEATURE_ATTENTION;
+    // a detector that is never updated stays in regime 0, which is the same as having none
+    if (tracker->use_regime_detection && tracker->regime_detector) features |= SIGNAL_FEATURE_REGIME;
+    if (tracker->use_dynamic_hedging && tracker->hedge_ratio_buffer) {
+        features |= SIGNAL_FEATURE_HEDGING;
+        if (tracker->params.hedge_mode == HEDGE_MODE_KALMAN) features |= SIGNAL_FEATURE_KALMAN_HEDGE;
+    }
+    if (tracker->use_transaction_costs) features |= SIGNAL_FEATURE_COSTS;
+    if (tracker->risk_manager) features |= SIGNAL_FEATURE_RISK;
+    
+    return features;
+}
+
+PairSignalFn get_signal_variant(int features) {
+    return signal_variants[features & (SIGNAL_FEATURE_COUNT - 1)];
+}
+
+void select_signal_variant(PairTracker *tracker) {
+    if (!tracker) return;
+    
+    tracker->signal_features = pair_tracker_feature_mask(tracker);
+    tracker->signal_fn = get_signal_variant(tracker->signal_features);
+}
+
+PairSignalCompact generate_compact_pairs_signal(PairTracker *tracker, double price1, double price2,
+                                                double bid1, double ask1, double bid2, double ask2,
+                                                long timestamp_micro) {
+    if (!tracker || !tracker->price_buffer1 || !tracker->price_buffer2) {
+        PairSignalCompact signal;
+        memset(&signal, 0, sizeof(signal));
+        signal.pair_id = tracker ? tracker->pair_id : -1;
+        return signal;
+    }
+    
+    if (!tracker->signal_fn) {
+        select_signal_variant(tracker);
+    }
+    
+    return tracker->signal_fn(tracker, price1, price2, bid1, ask1, bid2, ask2, timestamp_micro);
+}
+
+// Full diagnostic view of the tracker's latest step. Costs are recomputed from the
+// same inputs the step used, so the result matches what the step saw; the
+// cointegration statistic is the expensive part and is optional.
+PairSignal materialize_pair_signal(PairTracker *tracker, bool include_cointegration) {
+    PairSignal signal = {0};
+    if (!tracker || !tracker->price_buffer1 || !tracker->price_buffer2) return signal;
+    
+    int n_spread = tracker->spread_buffer ? cb_size(tracker->spread_buffer) : 0;
+    signal.spread = n_spread > 0 ? cb_get(tracker->spread_buffer, n_spread - 1) : 0.0;
+    signal.z_score = tracker->last_z_score;
     signal.correlation = tracker->correlation;
     signal.hedge_ratio = tracker->current_hedge_ratio;
     signal.dynamic_threshold_entry = tracker->dynamic_entry_threshold;
     signal.dynamic_threshold_exit = tracker->dynamic_exit_threshold;
-    signal.signal = trade_signal;
-    signal.position_size = position_size;
-    signal.pnl_analysis = pnl_analysis;
-    signal.timestamp_micro = timestamp_micro;
+    signal.signal = tracker->last_signal;
+    signal.position_size = tracker->last_position_size;
+    signal.timestamp_micro = tracker->last_update_micro;
     
-    if (tracker->regime_detector) {
+    if ((tracker->signal_features & SIGNAL_FEATURE_REGIME) && tracker->regime_detector) {
         signal.regime = tracker->regime_detector->current_regime;
     }
     
+    if (tracker->signal_features & SIGNAL_FEATURE_COSTS) {
+        double theoretical_pnl = fabs(signal.z_score) * 0.3 * signal.position_size;
+        signal.pnl_analysis = calculate_pnl_with_costs(theoretical_pnl, &tracker->transaction_costs,
+                                                       signal.position_size);
+    }
+    
     // calc cointegration tests if enough data
-    if (cb_size(tracker->price_buffer1) >= 30) {
+    if (include_cointegration && cb_size(tracker->price_buffer1) >= 30) {
         signal.cointegration_stat = johansen_test(tracker->price_buffer1, tracker->price_buffer2);
     }
     
-    tracker->last_update_micro = timestamp_micro;
+    return signal;
+}
+
+PairSignal generate_enhanced_pairs_signal(PairTracker *tracker, double price1, double price2,
+                                        double bid1, double ask1, double bid2, double ask2, long timestamp_micro) {
+    if (!tracker || !tracker->price_buffer1 || !tracker->price_buffer2) {
+        PairSignal signal = {0};
+        return signal;
+    }
+    
+    generate_compact_pairs_signal(tracker, price1, price2, bid1, ask1, bid2, ask2, timestamp_micro);
+    
+    // diagnostics are timed as their own stage, outside the hot-path total
+    PROFILE_BEGIN(tracker);
+    PairSignal signal = materialize_pair_signal(tracker, true);
+    PROFILE_STAGE(tracker, LATENCY_STAGE_COINTEGRATION);
     
     return signal;
 }
@@ -221,4 +221,305 @@ double simd_cb_correlation(CircularBuffer *cb1, CircularBuffer *cb2) {
     free(data2);
     
     return result;
-}
\ No newline at end of file
+}
+// Dense matrix products for the attention projections. Row-major throughout;
+// `ld*` are row strides. C is cut into GEMM_BLOCK_M x GEMM_BLOCK_N tiles so the
+// panel of B a tile reads stays cache resident, and each tile is walked with a
+// register-blocked micro-kernel. With beta == 0, C is write-only.
+
+#define GEMM_BLOCK_M 64
+#define GEMM_BLOCK_N 64
+
+static inline void gemm_store(double *c, double sum, double alpha, double beta) {
+    *c = (beta == 0.0) ? alpha * sum : alpha * sum + beta * *c;
+}
+
+// C = alpha * A * B^T + beta * C, with A m x k and B n x k (rows are dot products)
+void simd_gemm_nt(int m, int n, int k, double alpha, const double *a, int lda,
+                  const double *b, int ldb, double beta, double *c, int ldc) {
+    if (m <= 0 || n <= 0) return;
+
+    for (int i0 = 0; i0 < m; i0 += GEMM_BLOCK_M) {
+        int i1 = i0 + GEMM_BLOCK_M < m ? i0 + GEMM_BLOCK_M : m;
+        for (int j0 = 0; j0 < n; j0 += GEMM_BLOCK_N) {
+            int j1 = j0 + GEMM_BLOCK_N < n ? j0 + GEMM_BLOCK_N : n;
+            int i = i0;
+
+            // 2 x 4 micro-tile: eight independent dot products share each load
+            for (; i + 2 <= i1; i += 2) {
+                const double *a0 = a + (size_t)i * lda;
+                const double *a1 = a0 + lda;
+                int j = j0;
+                for (; j + 4 <= j1; j += 4) {
+                    const double *b0 = b + (size_t)j * ldb;
+                    const double *b1 = b0 + ldb;
+                    const double *b2 = b1 + ldb;
+                    const double *b3 = b2 + ldb;
+                    double s[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+                    int p = 0;
+#if SIMD_AVAILABLE
+                    __m256d acc[8];
+                    for (int t = 0; t < 8; t++) acc[t] = _mm256_setzero_pd();
+                    for (; p + 4 <= k; p += 4) {
+                        __m256d va0 = _mm256_loadu_pd(a0 + p), va1 = _mm256_loadu_pd(a1 + p);
+                        __m256d vb0 = _mm256_loadu_pd(b0 + p), vb1 = _mm256_loadu_pd(b1 + p);
+                        __m256d vb2 = _mm256_loadu_pd(b2 + p), vb3 = _mm256_loadu_pd(b3 + p);
+                        acc[0] = _mm256_add_pd(acc[0], _mm256_mul_pd(va0, vb0));
+                        acc[1] = _mm256_add_pd(acc[1], _mm256_mul_pd(va0, vb1));
+                        acc[2] = _mm256_add_pd(acc[2], _mm256_mul_pd(va0, vb2));
+                        acc[3] = _mm256_add_pd(acc[3], _mm256_mul_pd(va0, vb3));
+                        acc[4] = _mm256_add_pd(acc[4], _mm256_mul_pd(va1, vb0));
+                        acc[5] = _mm256_add_pd(acc[5], _mm256_mul_pd(va1, vb1));
+                        acc[6] = _mm256_add_pd(acc[6], _mm256_mul_pd(va1, vb2));
+                        acc[7] = _mm256_add_pd(acc[7], _mm256_mul_pd(va1, vb3));
+                    }
+                    for (int t = 0; t < 8; t++) {
+                        double lanes[4];
+                        _mm256_storeu_pd(lanes, acc[t]);
+                        s[t] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+                    }
+#endif
+                    for (; p < k; p++) {
+                        s[0] += a0[p] * b0[p]; s[1] += a0[p] * b1[p];
+                        s[2] += a0[p] * b2[p]; s[3] += a0[p] * b3[p];
+                        s[4] += a1[p] * b0[p]; s[5] += a1[p] * b1[p];
+                        s[6] += a1[p] * b2[p]; s[7] += a1[p] * b3[p];
+                    }
+                    for (int t = 0; t < 4; t++) {
+                        gemm_store(&c[(size_t)i * ldc + j + t], s[t], alpha, beta);
+                        gemm_store(&c[(size_t)(i + 1) * ldc + j + t], s[4 + t], alpha, beta);
+                    }
+                }
+                for (; j < j1; j++) {
+                    const double *bj = b + (size_t)j * ldb;
+                    double s0 = 0.0, s1 = 0.0;
+                    for (int p = 0; p < k; p++) {
+                        s0 += a0[p] * bj[p];
+                        s1 += a1[p] * bj[p];
+                    }
+                    gemm_store(&c[(size_t)i * ldc + j], s0, alpha, beta);
+                    gemm_store(&c[(size_t)(i + 1) * ldc + j], s1, alpha, beta);
+                }
+            }
+
+            // odd last row
+            for (; i < i1; i++) {
+                const double *ai = a + (size_t)i * lda;
+                for (int j = j0; j < j1; j++) {
+                    const double *bj = b + (size_t)j * ldb;
+                    double s = 0.0;
+                    for (int p = 0; p < k; p++) s += ai[p] * bj[p];
+                    gemm_store(&c[(size_t)i * ldc + j], s, alpha, beta);
+                }
+            }
+        }
+    }
+}
+
+// C = alpha * A * B + beta * C, with A m x k and B k x n (rows of B are broadcast-accumulated)
+void simd_gemm_nn(int m, int n, int k, double alpha, const double *a, int lda,
+                  const double *b, int ldb, double beta, double *c, int ldc) {
+    if (m <= 0 || n <= 0) return;
+
+    double acc[GEMM_BLOCK_N];
+    for (int i0 = 0; i0 < m; i0 += GEMM_BLOCK_M) {
+        int i1 = i0 + GEMM_BLOCK_M < m ? i0 + GEMM_BLOCK_M : m;
+        for (int j0 = 0; j0 < n; j0 += GEMM_BLOCK_N) {
+            int width = (j0 + GEMM_BLOCK_N < n ? j0 + GEMM_BLOCK_N : n) - j0;
+
+            for (int i = i0; i < i1; i++) {
+                const double *ai = a + (size_t)i * lda;
+                int j = 0;
+#if SIMD_AVAILABLE
+                // 8-column strips held in two registers across the whole k loop
+                for (; j + 8 <= width; j += 8) {
+                    __m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+                    const double *bp = b + j0 + j;
+                    for (int p = 0; p < k; p++, bp += ldb) {
+                        __m256d va = _mm256_broadcast_sd(&ai[p]);
+                        c0 = _mm256_add_pd(c0, _mm256_mul_pd(va, _mm256_loadu_pd(bp)));
+                        c1 = _mm256_add_pd(c1, _mm256_mul_pd(va, _mm256_loadu_pd(bp + 4)));
+                    }
+                    _mm256_storeu_pd(&acc[j], c0);
+                    _mm256_storeu_pd(&acc[j + 4], c1);
+                }
+#endif
+                if (j < width) {
+                    for (int t = j; t < width; t++) acc[t] = 0.0;
+                    for (int p = 0; p < k; p++) {
+                        double aip = ai[p];
+                        const double *bp = b + (size_t)p * ldb + j0;
+                        for (int t = j; t < width; t++) acc[t] += aip * bp[t];
+                    }
+                }
+
+                double *ci = c + (size_t)i * ldc + j0;
+                for (int t = 0; t < width; t++) gemm_store(&ci[t], acc[t], alpha, beta);
+            }
+        }
+    }
+}
+
+// ---- softmax ----------------------------------------------------------------
+//
+// exp(x) = 2^n * exp(r), n = round(x / ln 2), |r| <= ln 2 / 2, with exp(r) from its
+// degree-12 Taylor polynomial evaluated by Estrin's scheme (relative error about
+// 4e-16). The power of two is assembled in the exponent bits, so the same
+// arithmetic runs in scalar code and in four AVX2 lanes. Inputs at or below
+// EXP_MIN_ARG, and NaN, return 0: such softmax terms contribute nothing anyway.
+// Inputs above EXP_MAX_ARG saturate near 2^1023. The bound keeps n <= 1023, since
+// the power of two assembled for n = 1024 would already be +inf.
+
+#define EXP_MIN_ARG -708.3
+#define EXP_MAX_ARG 709.08
+#define EXP_LOG2E 1.4426950408889634
+#define EXP_LN2_HI 0.693147180369123816490   // few mantissa bits, so n * hi is exact
+#define EXP_LN2_LO 1.90821492927058770002e-10
+#define EXP_SHIFTER 6755399441055744.0        // 1.5 * 2^52: adding it rounds to an integer
+
+#define SOFTMAX_BLOCK 64
+#define SOFTMAX_MAX_BLOCKS 256
+
+static inline double fast_exp(double x) {
+    if (!(x > EXP_MIN_ARG)) return 0.0;
+    if (x > EXP_MAX_ARG) x = EXP_MAX_ARG;
+
+    double t = x * EXP_LOG2E + EXP_SHIFTER;
+    double n = t - EXP_SHIFTER;
+    double r = (x - n * EXP_LN2_HI) - n * EXP_LN2_LO;
+
+    double r2 = r * r, r4 = r2 * r2, r8 = r4 * r4;
+    double p01 = 1.0 + r, p23 = 1.0 / 2 + r * (1.0 / 6), p45 = 1.0 / 24 + r * (1.0 / 120);
+    double p67 = 1.0 / 720 + r * (1.0 / 5040), p89 = 1.0 / 40320 + r * (1.0 / 362880);
+    double pab = 1.0 / 3628800 + r * (1.0 / 39916800), pc = 1.0 / 479001600;
+    double p = ((p01 + r2 * p23) + r4 * (p45 + r2 * p67)) + r8 * ((p89 + r2 * pab) + r4 * pc);
+
+    // the low bits of t hold n; move n + 1023 into the exponent field
+    uint64_t bits;
+    memcpy(&bits, &t, sizeof(bits));
+    bits = (bits + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+#if SIMD_AVAILABLE
+static inline __m256d exp_pd(__m256d x) {
+    __m256d valid = _mm256_cmp_pd(x, _mm256_set1_pd(EXP_MIN_ARG), _CMP_GT_OQ);
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN_ARG)), _mm256_set1_pd(EXP_MAX_ARG));
+
+    __m256d shifter = _mm256_set1_pd(EXP_SHIFTER);
+    __m256d t = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(EXP_LOG2E)), shifter);
+    __m256d n = _mm256_sub_pd(t, shifter);
+    __m256d r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(EXP_LN2_HI))),
+                              _mm256_mul_pd(n, _mm256_set1_pd(EXP_LN2_LO)));
+
+    __m256d r2 = _mm256_mul_pd(r, r), r4 = _mm256_mul_pd(r2, r2), r8 = _mm256_mul_pd(r4, r4);
+#define EXP_PAIR(c0, c1) _mm256_add_pd(_mm256_set1_pd(c0), _mm256_mul_pd(r, _mm256_set1_pd(c1)))
+    __m256d p01 = EXP_PAIR(1.0, 1.0), p23 = EXP_PAIR(1.0 / 2, 1.0 / 6), p45 = EXP_PAIR(1.0 / 24, 1.0 / 120);
+    __m256d p67 = EXP_PAIR(1.0 / 720, 1.0 / 5040), p89 = EXP_PAIR(1.0 / 40320, 1.0 / 362880);
+    __m256d pab = EXP_PAIR(1.0 / 3628800, 1.0 / 39916800), pc = _mm256_set1_pd(1.0 / 479001600);
+#undef EXP_PAIR
+    __m256d lo = _mm256_add_pd(_mm256_add_pd(p01, _mm256_mul_pd(r2, p23)),
+                               _mm256_mul_pd(r4, _mm256_add_pd(p45, _mm256_mul_pd(r2, p67))));
+    __m256d hi = _mm256_add_pd(_mm256_add_pd(p89, _mm256_mul_pd(r2, pab)), _mm256_mul_pd(r4, pc));
+    __m256d p = _mm256_add_pd(lo, _mm256_mul_pd(r8, hi));
+
+    __m256i bits = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(1023)), 52);
+    return _mm256_and_pd(_mm256_mul_pd(p, _mm256_castsi256_pd(bits)), valid);
+}
+#endif
+
+static double block_max(const double *x, int n) {
+    double m = -INFINITY;
+    int i = 0;
+#if SIMD_AVAILABLE
+    if (n >= 4) {
+        __m256d mv = _mm256_loadu_pd(x);
+        for (i = 4; i <= n - 4; i += 4) mv = _mm256_max_pd(mv, _mm256_loadu_pd(x + i));
+        double lanes[4];
+        _mm256_storeu_pd(lanes, mv);
+        for (int l = 0; l < 4; l++) if (lanes[l] > m) m = lanes[l];
+    }
+#endif
+    for (; i < n; i++) if (x[i] > m) m = x[i];
+    return m;
+}
+
+// out[i] = exp(x[i] - shift), returning their sum
+static double block_exp(const double *x, double *out, int n, double shift) {
+    double sum = 0.0;
+    int i = 0;
+#if SIMD_AVAILABLE
+    __m256d shift_vec = _mm256_set1_pd(shift);
+    __m256d sum_vec = _mm256_setzero_pd();
+    for (; i <= n - 4; i += 4) {
+        __m256d e = exp_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i), shift_vec));
+        _mm256_storeu_pd(out + i, e);
+        sum_vec = _mm256_add_pd(sum_vec, e);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum_vec);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++) {
+        out[i] = fast_exp(x[i] - shift);
+        sum += out[i];
+    }
+    return sum;
+}
+
+static void block_scale(double *out, int n, double factor) {
+    int i = 0;
+#if SIMD_AVAILABLE
+    __m256d f = _mm256_set1_pd(factor);
+    for (; i <= n - 4; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(out + i), f));
+#endif
+    for (; i < n; i++) out[i] *= factor;
+}
+
+// out[i] = exp(x[i]); out may alias x
+void simd_exp_array(const double *x, double *out, int length) {
+    if (!x || !out) return;
+    int i = 0;
+#if SIMD_AVAILABLE
+    for (; i <= length - 4; i += 4) _mm256_storeu_pd(out + i, exp_pd(_mm256_loadu_pd(x + i)));
+#endif
+    for (; i < length; i++) out[i] = fast_exp(x[i]);
+}
+
+// Online softmax over blocks: each block is exponentiated against its own
+// maximum while it is in L1, and the running (max, sum) pair is rescaled as
+// block maxima arrive. One sweep over the input then does the max, the exp and
+// the sum; a final sweep applies the per-block correction and 1/sum together.
+// Every element costs one exp, plus one per block. out may alias scores.
+void simd_softmax(const double *scores, double *out, int length) {
+    if (!scores || !out || length <= 0) return;
+
+    int block = SOFTMAX_BLOCK;
+    while ((length + block - 1) / block > SOFTMAX_MAX_BLOCKS) block *= 2;
+
+    double maxima[SOFTMAX_MAX_BLOCKS];
+    double max_score = -INFINITY;
+    double sum = 0.0;
+
+    for (int b = 0, start = 0; start < length; b++, start += block) {
+        int n = length - start < block ? length - start : block;
+        double m = block_max(scores + start, n);
+        double s = block_exp(scores + start, out + start, n, m);
+        maxima[b] = m;
+
+        if (m > max_score) {
+            sum = sum * fast_exp(max_score - m) + s;
+            max_score = m;
+        } else {
+            sum += s * fast_exp(m - max_score);
+        }
+    }
+
+    double inv_sum = 1.0 / sum;
+    for (int b = 0, start = 0; start < length; b++, start += block) {
+        int n = length - start < block ? length - start : block;
+        block_scale(out + start, n, fast_exp(maxima[b] - max_score) * inv_sum);
+    }
+}
@@ -0,0 +1,738 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Tracker state snapshots, native byte order:
+//
+//   [SnapshotHeader]
+//   [last price/bid/ask]       n_symbols doubles each (universe quote state)
+//   [pair directory]           n_pairs x SnapshotPairEntry
+//   [tracker records]          SnapshotTrackerRecord, then its rings and components
+//                              in a fixed order, each piece 8-byte aligned
+//
+// Rings are stored raw (capacity, size, head and the full data array), so a restored
+// tracker holds exactly the saved window contents and continues without re-warming.
+// State derived from the rings, such as the return prefix sums, is recomputed on
+// load and may differ from an uninterrupted run in the last bits. The whole file is built in memory and written with one write(); loading maps it and
+// copies each record into freshly allocated trackers.
+//
+// Bump SNAPSHOT_VERSION whenever serialized state is added or reordered.
+
+#define SNAPSHOT_MAGIC "SAKSNAP1"
+#define SNAPSHOT_VERSION 6
+
+#define SNAPSHOT_HAS_HEDGE_BUFFER   0x01
+// 0x02 held the squared-return rings before version 6; unused since
+#define SNAPSHOT_HAS_ATTENTION      0x04
+#define SNAPSHOT_HAS_REGIME         0x08
+#define SNAPSHOT_HAS_RISK           0x10
+#define SNAPSHOT_HAS_REGIME_MODEL   0x20   // follows the regime rings
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    int32_t n_symbols;       // 0 for a standalone tracker
+    int32_t n_pairs;
+    int32_t pair_capacity;
+    uint32_t reserved;
+    uint64_t file_size;
+    uint64_t directory_offset;
+} SnapshotHeader;
+
+typedef struct {
+    int32_t leg1;
+    int32_t leg2;
+    uint64_t offset;
+    uint64_t size;
+} SnapshotPairEntry;
+
+typedef struct {
+    int32_t window_size;
+    uint32_t components;     // SNAPSHOT_HAS_* bits
+    int32_t position;
+    int32_t pair_id;
+    uint8_t use_attention;
+    uint8_t use_regime_detection;
+    uint8_t use_dynamic_hedging;
+    uint8_t use_transaction_costs;
+    int32_t last_signal;
+    SignalParams params;
+    TransactionCosts transaction_costs;
+    KalmanHedge hedge_filter;
+    HalfLifeStream half_life_stream;
+    double mean_spread;
+    double std_spread;
+    double correlation;
+    double attention_enhanced_zscore;
+    double current_hedge_ratio;
+    double dynamic_entry_threshold;
+    double dynamic_exit_threshold;
+    double last_z_score;
+    double last_position_size;
+    int64_t last_update_micro;
+} SnapshotTrackerRecord;
+
+typedef struct {
+    int32_t capacity;
+    int32_t size;
+    int32_t head;
+    int32_t is_full;
+} SnapshotRing;
+
+typedef struct {
+    int32_t input_dim;
+    int32_t attention_dim;
+    int32_t sequence_length;
+    int32_t cache_sequence_length;
+    int32_t cache_feature_dim;
+    int32_t model_backed;    // weights live in a model file: only its fingerprint is stored
+    uint64_t model_fingerprint;
+} SnapshotAttention;
+
+typedef struct {
+    int32_t current_regime;
+    int32_t last_regime_change;
+    double regime_confidence;
+    double regime_probabilities[MAX_REGIMES];
+    double transition_matrix[MAX_REGIMES][MAX_REGIMES];
+    double last_price1;
+    double last_price2;
+} SnapshotRegime;
+
+// a trained detector's parameters and one-pair filter state
+typedef struct {
+    RegimeModelParams params;
+    double prob[MAX_REGIMES];
+    double vol_feature;
+    double corr_feature;
+    double short_var;
+    double long_var;
+    double corr_mean;
+    double corr_var;
+    double last_price1;
+    double last_price2;
+    int32_t n_updates;
+    int32_t reserved;
+} SnapshotRegimeModel;
+
+typedef struct {
+    double target_volatility;
+    double current_volatility;
+    double volatility_scalar;
+    double position_size;
+    double max_position_limit;
+    double portfolio_heat;
+    double risk_per_trade;
+    double sharpe_ratio;
+    double max_drawdown;
+    double smoothed_volatility;
+    int32_t volatility_window;
+    int32_t reserved;
+} SnapshotRisk;
+
+// Sizing pass when data is NULL, fill pass otherwise
+typedef struct {
+    uint8_t *data;
+    size_t pos;
+} SnapshotWriter;
+
+typedef struct {
+    const uint8_t *data;
+    size_t pos;
+    size_t end;
+    bool failed;
+    AttentionModel *model;   // re-attached to model-backed trackers, may be NULL
+} SnapshotReader;
+
+static void snap_skip(SnapshotWriter *w, size_t bytes) {
+    w->pos += (bytes + 7) & ~(size_t)7;
+}
+
+static void snap_put(SnapshotWriter *w, const void *src, size_t bytes) {
+    if (w->data) memcpy(w->data + w->pos, src, bytes);
+    snap_skip(w, bytes);
+}
+
+static void snap_get(SnapshotReader *r, void *dst, size_t bytes) {
+    size_t padded = (bytes + 7) & ~(size_t)7;
+    if (r->failed || r->end - r->pos < padded) {
+        r->failed = true;
+        memset(dst, 0, bytes);
+        return;
+    }
+    memcpy(dst, r->data + r->pos, bytes);
+    r->pos += padded;
+}
+
+static void put_ring(SnapshotWriter *w, const CircularBuffer *cb) {
+    SnapshotRing ring;
+    memset(&ring, 0, sizeof(ring));
+    ring.capacity = cb->capacity;
+    ring.size = cb->size;
+    ring.head = cb->head;
+    ring.is_full = cb->is_full;
+    snap_put(w, &ring, sizeof(ring));
+    snap_put(w, cb->data, (size_t)cb->capacity * sizeof(double));
+}
+
+// restores into *cb, allocating it when NULL; an existing ring must match in capacity
+static void get_ring(SnapshotReader *r, CircularBuffer **cb) {
+    SnapshotRing ring;
+    snap_get(r, &ring, sizeof(ring));
+    if (r->failed || ring.capacity <= 0 || ring.size < 0 || ring.size > ring.capacity ||
+        ring.head < 0 || ring.head >= ring.capacity) {
+        r->failed = true;
+        return;
+    }
+    if (!*cb) *cb = create_circular_buffer(ring.capacity);
+    if (!*cb || (*cb)->capacity != ring.capacity) {
+        r->failed = true;
+        return;
+    }
+
+    snap_get(r, (*cb)->data, (size_t)ring.capacity * sizeof(double));
+    (*cb)->size = ring.size;
+    (*cb)->head = ring.head;
+    (*cb)->is_full = ring.is_full != 0;
+}
+
+static uint32_t tracker_components(const PairTracker *t) {
+    uint32_t components = 0;
+    if (t->hedge_ratio_buffer) components |= SNAPSHOT_HAS_HEDGE_BUFFER;
+    if (t->temporal_attention && t->attention_cache) components |= SNAPSHOT_HAS_ATTENTION;
+    if (t->regime_detector) components |= SNAPSHOT_HAS_REGIME;
+    if (t->regime_detector && t->regime_detector->model) components |= SNAPSHOT_HAS_REGIME_MODEL;
+    if (t->risk_manager) components |= SNAPSHOT_HAS_RISK;
+    return components;
+}
+
+static void put_tracker(SnapshotWriter *w, const PairTracker *t) {
+    SnapshotTrackerRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.window_size = t->window_size;
+    rec.components = tracker_components(t);
+    rec.position = t->position;
+    rec.pair_id = t->pair_id;
+    rec.use_attention = t->use_attention;
+    rec.use_regime_detection = t->use_regime_detection;
+    rec.use_dynamic_hedging = t->use_dynamic_hedging;
+    rec.use_transaction_costs = t->use_transaction_costs;
+    rec.params = t->params;
+    rec.transaction_costs = t->transaction_costs;
+    rec.hedge_filter = t->hedge_filter;
+    rec.half_life_stream = t->half_life_stream;
+    rec.mean_spread = t->mean_spread;
+    rec.std_spread = t->std_spread;
+    rec.correlation = t->correlation;
+    rec.attention_enhanced_zscore = t->attention_enhanced_zscore;
+    rec.current_hedge_ratio = t->current_hedge_ratio;
+    rec.dynamic_entry_threshold = t->dynamic_entry_threshold;
+    rec.dynamic_exit_threshold = t->dynamic_exit_threshold;
+    rec.last_signal = t->last_signal;
+    rec.last_z_score = t->last_z_score;
+    rec.last_position_size = t->last_position_size;
+    rec.last_update_micro = t->last_update_micro;
+    snap_put(w, &rec, sizeof(rec));
+
+    put_ring(w, t->price_buffer1);
+    put_ring(w, t->price_buffer2);
+    put_ring(w, t->spread_buffer);
+    if (rec.components & SNAPSHOT_HAS_HEDGE_BUFFER) put_ring(w, t->hedge_ratio_buffer);
+
+    if (rec.components & SNAPSHOT_HAS_ATTENTION) {
+        const AttentionLayer *layer = t->temporal_attention;
+        SnapshotAttention att;
+        memset(&att, 0, sizeof(att));
+        att.input_dim = layer->input_dim;
+        att.attention_dim = layer->attention_dim;
+        att.sequence_length = layer->sequence_length;
+        att.cache_sequence_length = t->attention_cache->sequence_length;
+        att.cache_feature_dim = t->attention_cache->feature_dim;
+        att.model_backed = layer->model != NULL;
+        if (layer->model) att.model_fingerprint = attention_model_fingerprint(layer->model);
+        snap_put(w, &att, sizeof(att));
+
+        // Q, K, V back to back, as they sit in the layer's weight block
+        if (!layer->model) {
+            snap_put(w, layer->weights, 3 * (size_t)layer->attention_dim * layer->input_dim * sizeof(double));
+        }
+    }
+
+    if (rec.components & SNAPSHOT_HAS_REGIME) {
+        const RegimeDetector *d = t->regime_detector;
+        SnapshotRegime reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.current_regime = d->current_regime;
+        reg.last_regime_change = d->last_regime_change;
+        reg.regime_confidence = d->regime_confidence;
+        memcpy(reg.regime_probabilities, d->regime_probabilities, sizeof(reg.regime_probabilities));
+        memcpy(reg.transition_matrix, d->transition_matrix, sizeof(reg.transition_matrix));
+        reg.last_price1 = d->last_price1;
+        reg.last_price2 = d->last_price2;
+        snap_put(w, &reg, sizeof(reg));
+        put_ring(w, d->volatility_buffer);
+        put_ring(w, d->correlation_buffer);
+
+        if (rec.components & SNAPSHOT_HAS_REGIME_MODEL) {
+            const RegimeBatch *m = d->model;
+            SnapshotRegimeModel model;
+            memset(&model, 0, sizeof(model));
+            model.params = m->params;
+            for (int k = 0; k < MAX_REGIMES; k++) model.prob[k] = m->prob[k][0];
+            model.vol_feature = m->vol_feature[0];
+            model.corr_feature = m->corr_feature[0];
+            model.short_var = m->short_var[0];
+            model.long_var = m->long_var[0];
+            model.corr_mean = m->corr_mean[0];
+            model.corr_var = m->corr_var[0];
+            model.last_price1 = m->last_price1[0];
+            model.last_price2 = m->last_price2[0];
+            model.n_updates = m->n_updates[0];
+            snap_put(w, &model, sizeof(model));
+        }
+    }
+
+    if (rec.components & SNAPSHOT_HAS_RISK) {
+        const RiskManager *m = t->risk_manager;
+        SnapshotRisk risk;
+        memset(&risk, 0, sizeof(risk));
+        risk.target_volatility = m->target_volatility;
+        risk.current_volatility = m->current_volatility;
+        risk.volatility_scalar = m->volatility_scalar;
+        risk.position_size = m->position_size;
+        risk.max_position_limit = m->max_position_limit;
+        risk.portfolio_heat = m->portfolio_heat;
+        risk.risk_per_trade = m->risk_per_trade;
+        risk.sharpe_ratio = m->sharpe_ratio;
+        risk.max_drawdown = m->max_drawdown;
+        risk.smoothed_volatility = m->smoothed_volatility;
+        risk.volatility_window = m->volatility_window;
+        snap_put(w, &risk, sizeof(risk));
+        put_ring(w, m->returns_buffer);
+        put_ring(w, m->volatility_buffer);
+    }
+}
+
+// the return ring is derived state: refill it from the restored price rings
+static void rebuild_return_prefix(SnapshotReader *r, PairTracker *t) {
+    t->return_prefix = create_prefix_buffer(t->window_size);
+    if (!t->return_prefix) {
+        r->failed = true;
+        return;
+    }
+    int n = cb_size(t->price_buffer1);
+    for (int i = 1; i < n && i < cb_size(t->price_buffer2); i++) {
+        pb_push(t->return_prefix, log(cb_get(t->price_buffer1, i) / cb_get(t->price_buffer1, i - 1)),
+                log(cb_get(t->price_buffer2, i) / cb_get(t->price_buffer2, i - 1)));
+    }
+}
+
+static PairTracker* get_tracker(SnapshotReader *r) {
+    SnapshotTrackerRecord rec;
+    snap_get(r, &rec, sizeof(rec));
+    if (r->failed || rec.window_size <= 0) {
+        r->failed = true;
+        return NULL;
+    }
+
+    PairTracker *t = create_pair_tracker(rec.window_size);
+    if (!t) {
+        r->failed = true;
+        return NULL;
+    }
+
+    t->position = rec.position;
+    t->pair_id = rec.pair_id;
+    t->use_attention = rec.use_attention;
+    t->use_regime_detection = rec.use_regime_detection;
+    t->use_dynamic_hedging = rec.use_dynamic_hedging;
+    t->use_transaction_costs = rec.use_transaction_costs;
+    t->params = rec.params;
+    t->transaction_costs = rec.transaction_costs;
+    t->hedge_filter = rec.hedge_filter;
+    t->half_life_stream = rec.half_life_stream;
+    t->mean_spread = rec.mean_spread;
+    t->std_spread = rec.std_spread;
+    t->correlation = rec.correlation;
+    t->attention_enhanced_zscore = rec.attention_enhanced_zscore;
+    t->current_hedge_ratio = rec.current_hedge_ratio;
+    t->dynamic_entry_threshold = rec.dynamic_entry_threshold;
+    t->dynamic_exit_threshold = rec.dynamic_exit_threshold;
+    t->last_signal = rec.last_signal;
+    t->last_z_score = rec.last_z_score;
+    t->last_position_size = rec.last_position_size;
+    t->last_update_micro = (long)rec.last_update_micro;
+
+    get_ring(r, &t->price_buffer1);
+    get_ring(r, &t->price_buffer2);
+    get_ring(r, &t->spread_buffer);
+    if (t->spread_buffer) attention_stream_rebuild(&t->attention_stream, t->spread_buffer);
+    if (rec.components & SNAPSHOT_HAS_HEDGE_BUFFER) {
+        get_ring(r, &t->hedge_ratio_buffer);
+        if (!r->failed) rebuild_return_prefix(r, t);
+    }
+
+    if (!r->failed && (rec.components & SNAPSHOT_HAS_ATTENTION)) {
+        SnapshotAttention att;
+        snap_get(r, &att, sizeof(att));
+        bool shapes_ok = !r->failed && att.input_dim > 0 && att.attention_dim > 0 && att.sequence_length > 0 &&
+                         att.cache_sequence_length > 0 && att.cache_feature_dim > 0;
+        if (shapes_ok && att.model_backed) {
+            // only the model the tracker was saved with will do
+            if (r->model && attention_model_input_dim(r->model) == att.input_dim &&
+                attention_model_attention_dim(r->model) == att.attention_dim &&
+                attention_model_fingerprint(r->model) == att.model_fingerprint) {
+                t->temporal_attention = create_attention_layer_from_model(r->model, att.sequence_length);
+            }
+        } else if (shapes_ok) {
+            t->temporal_attention = create_attention_layer(att.input_dim, att.attention_dim, att.sequence_length);
+        }
+        if (shapes_ok) t->attention_cache = create_attention_output(att.cache_sequence_length, att.cache_feature_dim);
+        if (!t->temporal_attention || !t->attention_cache) {
+            r->failed = true;
+        } else if (!att.model_backed) {
+            AttentionLayer *layer = t->temporal_attention;
+            snap_get(r, layer->weights, 3 * (size_t)layer->attention_dim * layer->input_dim * sizeof(double));
+        }
+    }
+
+    if (!r->failed && (rec.components & SNAPSHOT_HAS_REGIME)) {
+        SnapshotRegime reg;
+        snap_get(r, &reg, sizeof(reg));
+        size_t ring_pos = r->pos;
+        SnapshotRing ring;
+        snap_get(r, &ring, sizeof(ring));
+        r->pos = ring_pos;
+
+        if (!r->failed && ring.capacity > 0) t->regime_detector = create_regime_detector(ring.capacity);
+        if (!t->regime_detector) {
+            r->failed = true;
+        } else {
+            RegimeDetector *d = t->regime_detector;
+            d->current_regime = reg.current_regime;
+            d->last_regime_change = reg.last_regime_change;
+            d->regime_confidence = reg.regime_confidence;
+            memcpy(d->regime_probabilities, reg.regime_probabilities, sizeof(reg.regime_probabilities));
+            memcpy(d->transition_matrix, reg.transition_matrix, sizeof(reg.transition_matrix));
+            d->last_price1 = reg.last_price1;
+            d->last_price2 = reg.last_price2;
+            get_ring(r, &d->volatility_buffer);
+            get_ring(r, &d->correlation_buffer);
+        }
+    }
+
+    if (!r->failed && (rec.components & SNAPSHOT_HAS_REGIME_MODEL)) {
+        SnapshotRegimeModel model;
+        snap_get(r, &model, sizeof(model));
+        RegimeDetector *d = t->regime_detector;
+        RegimeDetector saved;
+        if (d) saved = *d;
+        if (r->failed || !d || !regime_detector_set_model(d, &model.params)) {
+            r->failed = true;
+        } else {
+            // set_model restarts the filter: put back the detector fields and filter state
+            d->current_regime = saved.current_regime;
+            d->last_regime_change = saved.last_regime_change;
+            d->regime_confidence = saved.regime_confidence;
+            memcpy(d->regime_probabilities, saved.regime_probabilities, sizeof(d->regime_probabilities));
+
+            RegimeBatch *m = d->model;
+            for (int k = 0; k < MAX_REGIMES; k++) m->prob[k][0] = model.prob[k];
+            m->regime[0] = saved.current_regime;
+            m->confidence[0] = saved.regime_confidence;
+            m->vol_feature[0] = model.vol_feature;
+            m->corr_feature[0] = model.corr_feature;
+            m->short_var[0] = model.short_var;
+            m->long_var[0] = model.long_var;
+            m->corr_mean[0] = model.corr_mean;
+            m->corr_var[0] = model.corr_var;
+            m->last_price1[0] = model.last_price1;
+            m->last_price2[0] = model.last_price2;
+            m->n_updates[0] = model.n_updates;
+        }
+    }
+
+    if (!r->failed && (rec.components & SNAPSHOT_HAS_RISK)) {
+        SnapshotRisk risk;
+        snap_get(r, &risk, sizeof(risk));
+        size_t ring_pos = r->pos;
+        SnapshotRing ring;
+        snap_get(r, &ring, sizeof(ring));
+        r->pos = ring_pos;
+
+        if (!r->failed && ring.capacity > 0) t->risk_manager = create_risk_manager(ring.capacity, risk.target_volatility);
+        if (!t->risk_manager) {
+            r->failed = true;
+        } else {
+            RiskManager *m = t->risk_manager;
+            m->current_volatility = risk.current_volatility;
+            m->volatility_scalar = risk.volatility_scalar;
+            m->position_size = risk.position_size;
+            m->max_position_limit = risk.max_position_limit;
+            m->portfolio_heat = risk.portfolio_heat;
+            m->risk_per_trade = risk.risk_per_trade;
+            m->sharpe_ratio = risk.sharpe_ratio;
+            m->max_drawdown = risk.max_drawdown;
+            m->smoothed_volatility = risk.smoothed_volatility;
+            m->volatility_window = risk.volatility_window;
+            get_ring(r, &m->returns_buffer);
+            get_ring(r, &m->volatility_buffer);
+            if (!r->failed) risk_manager_rebuild(m);
+        }
+    }
+
+    if (r->failed) {
+        destroy_pair_tracker(t);
+        return NULL;
+    }
+
+    select_signal_variant(t);
+    return t;
+}
+
+static size_t tracker_record_size(const PairTracker *t) {
+    SnapshotWriter sizing = {NULL, 0};
+    put_tracker(&sizing, t);
+    return sizing.pos;
+}
+
+// flushes the directory entry of a file just renamed into place; filesystems that
+// cannot sync a directory (EINVAL) order the rename themselves
+static bool sync_parent_directory(const char *path) {
+    const char *slash = strrchr(path, '/');
+    char *dir = NULL;
+    if (slash) {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        dir = malloc(len + 1);
+        if (!dir) return false;
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+
+    int fd = open(dir ? dir : ".", O_RDONLY);
+    free(dir);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0 || errno == EINVAL;
+    close(fd);
+    return ok;
+}
+
+// builds the whole image in memory and writes it with one write(), via a temp file
+static bool write_snapshot(const char *path, PairTracker *const *trackers, const int *leg1, const int *leg2,
+                           int n_pairs, int pair_capacity, const PairUniverse *universe) {
+    int n_symbols = universe ? universe->n_symbols : 0;
+
+    SnapshotWriter w = {NULL, 0};
+    SnapshotHeader header;
+    snap_skip(&w, sizeof(header));
+    for (int k = 0; k < 3; k++) snap_skip(&w, (size_t)n_symbols * sizeof(double));
+    size_t directory_offset = w.pos;
+    snap_skip(&w, (size_t)n_pairs * sizeof(SnapshotPairEntry));
+    size_t records_offset = w.pos;
+
+    size_t *sizes = malloc((n_pairs > 0 ? n_pairs : 1) * sizeof(size_t));
+    if (!sizes) return false;
+    size_t total = records_offset;
+    for (int p = 0; p < n_pairs; p++) {
+        sizes[p] = tracker_record_size(trackers[p]);
+        total += sizes[p];
+    }
+
+    uint8_t *image = calloc(1, total);
+    if (!image) {
+        free(sizes);
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.header_size = sizeof(SnapshotHeader);
+    header.n_symbols = n_symbols;
+    header.n_pairs = n_pairs;
+    header.pair_capacity = pair_capacity;
+    header.file_size = total;
+    header.directory_offset = directory_offset;
+
+    w.data = image;
+    w.pos = 0;
+    snap_put(&w, &header, sizeof(header));
+    if (universe) {
+        snap_put(&w, universe->last_price, (size_t)n_symbols * sizeof(double));
+        snap_put(&w, universe->last_bid, (size_t)n_symbols * sizeof(double));
+        snap_put(&w, universe->last_ask, (size_t)n_symbols * sizeof(double));
+    }
+
+    size_t offset = records_offset;
+    for (int p = 0; p < n_pairs; p++) {
+        SnapshotPairEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.leg1 = leg1 ? leg1[p] : -1;
+        entry.leg2 = leg2 ? leg2[p] : -1;
+        entry.offset = offset;
+        entry.size = sizes[p];
+        snap_put(&w, &entry, sizeof(entry));
+        offset += sizes[p];
+    }
+    for (int p = 0; p < n_pairs; p++) {
+        put_tracker(&w, trackers[p]);
+    }
+    free(sizes);
+
+    // write next to the target, sync, rename, then sync the directory, so a crash
+    // leaves either the old snapshot or the complete new one
+    size_t path_len = strlen(path);
+    char *tmp_path = malloc(path_len + 5);
+    if (!tmp_path) {
+        free(image);
+        return false;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    bool ok = false;
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        size_t written = 0;
+        while (written < total) {
+            ssize_t n = write(fd, image + written, total - written);
+            if (n <= 0) break;
+            written += (size_t)n;
+        }
+        ok = (written == total) && fsync(fd) == 0;
+        if (close(fd) != 0) ok = false;
+        if (ok) ok = (rename(tmp_path, path) == 0);
+        if (!ok) unlink(tmp_path);
+        else ok = sync_parent_directory(path);
+    }
+
+    free(tmp_path);
+    free(image);
+    return ok;
+}
+
+typedef struct {
+    void *map;
+    size_t size;
+    const SnapshotHeader *header;
+    const SnapshotPairEntry *directory;
+    const double *quotes;   // last_price, last_bid, last_ask, n_symbols each
+} SnapshotMapping;
+
+static bool map_snapshot(const char *path, SnapshotMapping *m) {
+    memset(m, 0, sizeof(*m));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    m->size = (size_t)st.st_size;
+    m->map = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m->map == MAP_FAILED) {
+        m->map = NULL;
+        return false;
+    }
+
+    const SnapshotHeader *h = m->map;
+    bool valid = memcmp(h->magic, SNAPSHOT_MAGIC, 8) == 0 && h->version == SNAPSHOT_VERSION &&
+                 h->header_size == sizeof(SnapshotHeader) && h->file_size == m->size &&
+                 h->n_symbols >= 0 && h->n_pairs >= 0 && h->pair_capacity >= h->n_pairs &&
+                 h->directory_offset <= m->size &&
+                 (m->size - h->directory_offset) / sizeof(SnapshotPairEntry) >= (size_t)h->n_pairs &&
+                 sizeof(SnapshotHeader) + 3 * (size_t)h->n_symbols * sizeof(double) <= h->directory_offset;
+    if (!valid) {
+        munmap(m->map, m->size);
+        m->map = NULL;
+        return false;
+    }
+
+    m->header = h;
+    m->quotes = (const double*)((const uint8_t*)m->map + sizeof(SnapshotHeader));
+    m->directory = (const SnapshotPairEntry*)((const uint8_t*)m->map + h->directory_offset);
+    return true;
+}
+
+static PairTracker* load_entry(const SnapshotMapping *m, int p, AttentionModel *model) {
+    const SnapshotPairEntry *entry = &m->directory[p];
+    if (entry->offset > m->size || entry->size > m->size - entry->offset) return NULL;
+
+    SnapshotReader r = {(const uint8_t*)m->map, (size_t)entry->offset, (size_t)(entry->offset + entry->size),
+                        false, model};
+    return get_tracker(&r);
+}
+
+bool save_pair_tracker_snapshot(const PairTracker *tracker, const char *path) {
+    if (!tracker || !path) return false;
+    PairTracker *trackers[1];
+    trackers[0] = (PairTracker*)tracker;
+    return write_snapshot(path, trackers, NULL, NULL, 1, 1, NULL);
+}
+
+PairTracker* load_pair_tracker_snapshot(const char *path) {
+    return load_pair_tracker_snapshot_with_model(path, NULL);
+}
+
+// a tracker saved with model-backed attention views `model` again, which must be
+// the same weights; without it such a snapshot does not load
+PairTracker* load_pair_tracker_snapshot_with_model(const char *path, AttentionModel *model) {
+    if (!path) return NULL;
+
+    SnapshotMapping m;
+    if (!map_snapshot(path, &m)) return NULL;
+
+    PairTracker *tracker = m.header->n_pairs == 1 ? load_entry(&m, 0, model) : NULL;
+    munmap(m.map, m.size);
+    return tracker;
+}
+
+bool save_universe_snapshot(const PairUniverse *universe, const char *path) {
+    if (!universe || !path) return false;
+    return write_snapshot(path, universe->trackers, universe->leg1, universe->leg2,
+                          universe->n_pairs, universe->pair_capacity, universe);
+}
+
+PairUniverse* load_universe_snapshot(const char *path) {
+    return load_universe_snapshot_with_model(path, NULL);
+}
+
+PairUniverse* load_universe_snapshot_with_model(const char *path, AttentionModel *model) {
+    if (!path) return NULL;
+
+    SnapshotMapping m;
+    if (!map_snapshot(path, &m)) return NULL;
+
+    const SnapshotHeader *h = m.header;
+    PairUniverse *universe = h->n_symbols > 0 ? create_pair_universe(h->n_symbols, h->pair_capacity) : NULL;
+    bool ok = universe != NULL;
+
+    if (ok) {
+        memcpy(universe->last_price, m.quotes, (size_t)h->n_symbols * sizeof(double));
+        memcpy(universe->last_bid, m.quotes + h->n_symbols, (size_t)h->n_symbols * sizeof(double));
+        memcpy(universe->last_ask, m.quotes + 2 * (size_t)h->n_symbols, (size_t)h->n_symbols * sizeof(double));
+    }
+
+    for (int p = 0; ok && p < h->n_pairs; p++) {
+        PairTracker *tracker = load_entry(&m, p, model);
+        if (!tracker || pair_universe_add_pair(universe, m.directory[p].leg1, m.directory[p].leg2, tracker) < 0) {
+            destroy_pair_tracker(tracker);
+            ok = false;
+        }
+    }
+
+    munmap(m.map, m.size);
+    if (!ok) {
+        destroy_pair_universe(universe);
+        return NULL;
+    }
+    return universe;
+}
@@ -0,0 +1,164 @@
+#include "sakura_signals.h"
+
+// Parameter sweep over one pair of a binary tick file.
+//
+//   ./sakura_signals_sweep ticks.bin SYM1 SYM2 [--threads N] [--windows 32,64]
+//                          [--entry 1.5,2,2.5] [--exit 0.25,0.5] [--blend 0.5,0.7]
+//                          [--hedge 10,20] [--target-vol 0.1,0.15]
+//                          [--hedge-mode 0,1] [--hedge-noise 1e-10,1e-9]
+//                          [--segment-hours H --train-segments K] [--regimes model.rgm]
+//
+// Every grid point runs in parallel against the same mapping; results are printed
+// best Sharpe first. With --segment-hours the grid is re-selected walk-forward:
+// the best configuration over the previous K segments trades the next one. With
+// --regimes the pair's history is Viterbi-decoded under a trained regime model
+// and each configuration's PnL is also split by regime.
+
+static bool parse_axis(const char *text, BacktestAxis *axis) {
+    axis->count = 0;
+    while (*text && axis->count < BACKTEST_MAX_AXIS_VALUES) {
+        char *end;
+        double v = strtod(text, &end);
+        if (end == text) return false;
+        axis->values[axis->count++] = v;
+        if (*end != ',' && *end != '\0') return false;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return axis->count > 0;
+}
+
+static int compare_sharpe_desc(const void *a, const void *b) {
+    double sa = ((const BacktestResult*)a)->sharpe;
+    double sb = ((const BacktestResult*)b)->sharpe;
+    return (sa < sb) - (sa > sb);
+}
+
+// decodes the pair's regime path once, on the first configuration's correlation window
+static bool run_regime_sweep(const TickFile *file, int symbol1, int symbol2, const char *model_path,
+                             const BacktestConfig *configs, int n_configs, int n_threads, BacktestResult *results) {
+    RegimeModelParams params;
+    if (!regime_model_load(model_path, &params)) {
+        fprintf(stderr, "Cannot load regime model %s\n", model_path);
+        return false;
+    }
+
+    RegimeSequence sequence;
+    double *vol = NULL, *corr = NULL;
+    sequence.n_steps = regime_features_from_tick_file(file, symbol1, symbol2, configs[0].window_size, &params,
+                                                      &vol, &corr);
+    sequence.vol_feature = vol;
+    sequence.corr_feature = corr;
+
+    RegimePath *path = sequence.n_steps >= 0 ? regime_decode(&params, &sequence, 1, n_threads) : NULL;
+    bool ok = path && backtest_run_by_regime(file, symbol1, symbol2, configs, n_configs, n_threads,
+                                             path->regime, sequence.n_steps, results);
+
+    destroy_regime_path(path);
+    free(vol);
+    free(corr);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s ticks.bin SYM1 SYM2 [--threads N] [--windows LIST] [--entry LIST] "
+                        "[--exit LIST] [--blend LIST] [--hedge LIST] [--target-vol LIST] "
+                        "[--hedge-mode LIST] [--hedge-noise LIST] "
+                        "[--segment-hours H --train-segments K] [--regimes model.rgm]\n", argv[0]);
+        return 1;
+    }
+
+    BacktestGrid grid;
+    memset(&grid, 0, sizeof(grid));
+    int n_threads = 4;
+    double segment_hours = 0.0;
+    int train_segments = 4;
+    const char *regime_model = NULL;
+
+    for (int i = 4; i + 1 < argc; i += 2) {
+        bool ok = true;
+        if (strcmp(argv[i], "--threads") == 0) n_threads = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--segment-hours") == 0) ok = (segment_hours = atof(argv[i + 1])) > 0;
+        else if (strcmp(argv[i], "--train-segments") == 0) ok = (train_segments = atoi(argv[i + 1])) > 0;
+        else if (strcmp(argv[i], "--windows") == 0) ok = parse_axis(argv[i + 1], &grid.window_size);
+        else if (strcmp(argv[i], "--entry") == 0) ok = parse_axis(argv[i + 1], &grid.entry_threshold);
+        else if (strcmp(argv[i], "--exit") == 0) ok = parse_axis(argv[i + 1], &grid.exit_threshold);
+        else if (strcmp(argv[i], "--blend") == 0) ok = parse_axis(argv[i + 1], &grid.attention_blend);
+        else if (strcmp(argv[i], "--hedge") == 0) ok = parse_axis(argv[i + 1], &grid.hedge_lookback);
+        else if (strcmp(argv[i], "--target-vol") == 0) ok = parse_axis(argv[i + 1], &grid.target_volatility);
+        else if (strcmp(argv[i], "--hedge-mode") == 0) ok = parse_axis(argv[i + 1], &grid.hedge_mode);
+        else if (strcmp(argv[i], "--hedge-noise") == 0) ok = parse_axis(argv[i + 1], &grid.hedge_process_noise);
+        else if (strcmp(argv[i], "--regimes") == 0) regime_model = argv[i + 1];
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+            return 1;
+        }
+    }
+
+    TickFile *file = tick_file_open(argv[1]);
+    if (!file) {
+        fprintf(stderr, "Cannot open tick file %s\n", argv[1]);
+        return 1;
+    }
+    int symbol1 = tick_file_symbol_id(file, argv[2]);
+    int symbol2 = tick_file_symbol_id(file, argv[3]);
+    if (symbol1 < 0 || symbol2 < 0) {
+        fprintf(stderr, "Unknown symbol: %s\n", symbol1 < 0 ? argv[2] : argv[3]);
+        tick_file_close(file);
+        return 1;
+    }
+
+    int n_configs = 0;
+    backtest_expand_grid(&grid, NULL, 0, &n_configs);
+    BacktestConfig *configs = malloc(n_configs * sizeof(BacktestConfig));
+    BacktestResult *results = malloc(n_configs * sizeof(BacktestResult));
+    if (!configs || !results || !backtest_expand_grid(&grid, configs, n_configs, &n_configs)) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(configs);
+        free(results);
+        tick_file_close(file);
+        return 1;
+    }
+
+    uint64_t start = latency_now_ns();
+    bool ok;
+
+    if (segment_hours > 0) {
+        WalkForwardConfig wf;
+        wf.start_micro = INT64_MIN;
+        wf.end_micro = INT64_MAX;
+        wf.segment_micro = (int64_t)(segment_hours * 3600.0 * 1e6);
+        wf.train_segments = train_segments;
+        wf.n_threads = n_threads;
+
+        WalkForwardResult *result = walk_forward_run(file, symbol1, symbol2, configs, n_configs, &wf);
+        ok = result != NULL;
+        if (ok) {
+            printf("%s/%s walk-forward: %d configurations, %d windows, %d threads, %.2f s\n", argv[2], argv[3],
+                   n_configs, result->n_windows, n_threads, (double)(latency_now_ns() - start) / 1e9);
+            print_walk_forward_result(result, configs);
+        }
+        destroy_walk_forward_result(result);
+    } else {
+        ok = regime_model ? run_regime_sweep(file, symbol1, symbol2, regime_model, configs, n_configs, n_threads, results)
+                          : backtest_run(file, symbol1, symbol2, configs, n_configs, n_threads, results);
+        if (ok) {
+            qsort(results, n_configs, sizeof(BacktestResult), compare_sharpe_desc);
+            printf("%s/%s: %d configurations, %d threads, %.2f s\n", argv[2], argv[3], n_configs, n_threads,
+                   (double)(latency_now_ns() - start) / 1e9);
+            print_backtest_results(results, n_configs);
+            if (regime_model) {
+                printf("\nBy regime (%s):\n", regime_model);
+                print_backtest_regime_results(results, n_configs);
+            }
+        }
+    }
+    if (!ok) fprintf(stderr, "Backtest failed\n");
+
+    free(configs);
+    free(results);
+    tick_file_close(file);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include "sakura_signals.h"
+
+// Ticker interning: names map to dense ids 0..n-1 in first-seen order, so every
+// per-symbol array downstream is indexed directly. Lookups hash once and probe an
+// open-addressing array of ids; a name is only compared against the entry whose
+// stored hash matches. Names are truncated to TICK_SYMBOL_LEN - 1 characters, the
+// same width the tick file stores, and kept zero-padded so the name array can be
+// written out as-is.
+
+#define SYMBOL_TABLE_MIN_CAPACITY 16
+
+uint64_t symbol_hash(const char *name, int len) {
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (int i = 0; i < len; i++) {
+        h ^= (uint8_t)name[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static int clamp_symbol_len(const char *name) {
+    int len = 0;
+    while (len < TICK_SYMBOL_LEN - 1 && name[len]) len++;
+    return len;
+}
+
+// slot array stays at most half full
+static bool rehash_slots(SymbolTable *table, uint32_t n_slots) {
+    int32_t *slots = malloc(n_slots * sizeof(int32_t));
+    if (!slots) return false;
+    for (uint32_t i = 0; i < n_slots; i++) slots[i] = -1;
+
+    uint32_t mask = n_slots - 1;
+    for (int id = 0; id < table->n_symbols; id++) {
+        uint32_t i = (uint32_t)table->hashes[id] & mask;
+        while (slots[i] >= 0) i = (i + 1) & mask;
+        slots[i] = id;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slot_mask = mask;
+    return true;
+}
+
+SymbolTable* create_symbol_table(int capacity) {
+    if (capacity < SYMBOL_TABLE_MIN_CAPACITY) capacity = SYMBOL_TABLE_MIN_CAPACITY;
+
+    SymbolTable *table = calloc(1, sizeof(SymbolTable));
+    if (!table) return NULL;
+
+    table->names = calloc(capacity, sizeof(*table->names));
+    table->hashes = malloc(capacity * sizeof(uint64_t));
+    table->capacity = capacity;
+
+    uint32_t n_slots = 1;
+    while (n_slots < 2u * (uint32_t)capacity) n_slots <<= 1;
+
+    if (!table->names || !table->hashes || !rehash_slots(table, n_slots)) {
+        destroy_symbol_table(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void destroy_symbol_table(SymbolTable *table) {
+    if (table) {
+        free(table->names);
+        free(table->hashes);
+        free(table->slots);
+        free(table);
+    }
+}
+
+int symbol_table_find_n(const SymbolTable *table, const char *name, int len, uint64_t hash) {
+    if (!table || !name || len <= 0 || len >= TICK_SYMBOL_LEN) return -1;
+
+    uint32_t i = (uint32_t)hash & table->slot_mask;
+    for (int32_t id; (id = table->slots[i]) >= 0; i = (i + 1) & table->slot_mask) {
+        if (table->hashes[id] == hash && memcmp(table->names[id], name, (size_t)len) == 0 &&
+            table->names[id][len] == '\0') {
+            return id;
+        }
+    }
+    return -1;
+}
+
+int symbol_table_find(const SymbolTable *table, const char *name) {
+    if (!name) return -1;
+    int len = clamp_symbol_len(name);
+    return symbol_table_find_n(table, name, len, symbol_hash(name, len));
+}
+
+int symbol_table_intern_n(SymbolTable *table, const char *name, int len, uint64_t hash) {
+    if (!table || !name || len <= 0 || len >= TICK_SYMBOL_LEN) return -1;
+
+    int id = symbol_table_find_n(table, name, len, hash);
+    if (id >= 0) return id;
+
+    if (table->n_symbols == table->capacity) {
+        int capacity = table->capacity * 2;
+        char (*names)[TICK_SYMBOL_LEN] = realloc(table->names, capacity * sizeof(*names));
+        if (!names) return -1;
+        table->names = names;
+        memset(names + table->capacity, 0, (size_t)(capacity - table->capacity) * sizeof(*names));
+
+        uint64_t *hashes = realloc(table->hashes, capacity * sizeof(uint64_t));
+        if (!hashes) return -1;
+        table->hashes = hashes;
+        table->capacity = capacity;
+
+        if (!rehash_slots(table, (table->slot_mask + 1) * 2)) return -1;
+    }
+
+    id = table->n_symbols++;
+    memcpy(table->names[id], name, (size_t)len);
+    table->hashes[id] = hash;
+
+    uint32_t i = (uint32_t)hash & table->slot_mask;
+    while (table->slots[i] >= 0) i = (i + 1) & table->slot_mask;
+    table->slots[i] = id;
+
+    return id;
+}
+
+int symbol_table_intern(SymbolTable *table, const char *name) {
+    if (!name) return -1;
+    int len = clamp_symbol_len(name);
+    return symbol_table_intern_n(table, name, len, symbol_hash(name, len));
+}
+
+const char* symbol_table_name(const SymbolTable *table, int id) {
+    if (!table || id < 0 || id >= table->n_symbols) return NULL;
+    return table->names[id];
+}
@@ -0,0 +1,200 @@
+#include "sakura_signals.h"
+
+// Synthetic N-symbol market for load testing. Returns follow a market + sector
+// factor model; symbols inside a cointegrated group share a common stochastic trend
+// plus a mean-reverting (OU) residual. A two-state Markov chain switches between a
+// calm and a stressed regime, which scales volatility, factor loadings and quoted spreads.
+
+static uint64_t universe_next(SyntheticUniverse *u) {
+    // xorshift64* keeps the generator reentrant and reproducible per seed
+    u->rng ^= u->rng >> 12;
+    u->rng ^= u->rng << 25;
+    u->rng ^= u->rng >> 27;
+    return u->rng * 0x2545F4914F6CDD1DULL;
+}
+
+static double universe_uniform(SyntheticUniverse *u) {
+    return (double)(universe_next(u) >> 11) / 9007199254740992.0;
+}
+
+static double universe_gaussian(SyntheticUniverse *u) {
+    // Box-Muller, one draw per call
+    double u1 = universe_uniform(u);
+    double u2 = universe_uniform(u);
+    if (u1 < 1e-300) u1 = 1e-300;
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+SyntheticUniverseConfig default_synthetic_universe_config(int n_symbols) {
+    SyntheticUniverseConfig config = {0};
+
+    config.n_symbols = n_symbols;
+    config.n_sectors = n_symbols >= 8 ? n_symbols / 8 : 1;
+    config.market_loading = 0.4;
+    config.sector_loading = 0.5;
+    config.cointegrated_group_size = 4;
+    config.cointegrated_fraction = 0.5;  // half the symbols live in cointegrated groups
+    config.mean_reversion_speed = 0.05;
+    config.base_volatility = 0.001;      // per-tick return vol in the calm regime
+    config.regime_switch_prob = 0.002;
+    config.stress_vol_multiplier = 2.5;
+    config.base_spread_bps = 2.0;
+    config.tick_interval_micro = 1000;
+    config.seed = 42;
+
+    return config;
+}
+
+SyntheticUniverse* create_synthetic_universe(const SyntheticUniverseConfig *config) {
+    if (!config || config->n_symbols <= 0) return NULL;
+
+    SyntheticUniverse *u = calloc(1, sizeof(SyntheticUniverse));
+    if (!u) return NULL;
+
+    u->config = *config;
+    if (u->config.n_sectors < 1) u->config.n_sectors = 1;
+    int n = u->config.n_symbols;
+
+    int group_size = u->config.cointegrated_group_size;
+    int n_grouped = group_size > 1 ? (int)(n * u->config.cointegrated_fraction) / group_size * group_size : 0;
+    u->n_groups = group_size > 1 ? n_grouped / group_size : 0;
+
+    u->log_price = malloc(n * sizeof(double));
+    u->residual = calloc(n, sizeof(double));
+    u->group_offset = calloc(n, sizeof(double));
+    u->sector = malloc(n * sizeof(int));
+    u->group = malloc(n * sizeof(int));
+    u->sector_return = calloc(u->config.n_sectors, sizeof(double));
+    u->group_trend = calloc(u->n_groups > 0 ? u->n_groups : 1, sizeof(double));
+
+    if (!u->log_price || !u->residual || !u->group_offset || !u->sector || !u->group ||
+        !u->sector_return || !u->group_trend) {
+        destroy_synthetic_universe(u);
+        return NULL;
+    }
+
+    u->rng = u->config.seed ? u->config.seed : 0x9E3779B97F4A7C15ULL;
+    u->regime = 0;
+    u->timestamp_micro = 1640995200000000L;
+
+    for (int g = 0; g < u->n_groups; g++) {
+        u->group_trend[g] = log(20.0 + 180.0 * universe_uniform(u));
+    }
+
+    for (int s = 0; s < n; s++) {
+        // grouped symbols come first so group members have adjacent ids
+        u->group[s] = s < n_grouped ? s / group_size : -1;
+        u->sector[s] = u->group[s] >= 0 ? u->group[s] % u->config.n_sectors : s % u->config.n_sectors;
+
+        if (u->group[s] >= 0) {
+            // members trade at different levels around the shared trend
+            u->group_offset[s] = log(0.5 + universe_uniform(u));
+            u->log_price[s] = u->group_trend[u->group[s]] + u->group_offset[s];
+        } else {
+            u->log_price[s] = log(20.0 + 180.0 * universe_uniform(u));
+        }
+    }
+
+    return u;
+}
+
+void destroy_synthetic_universe(SyntheticUniverse *u) {
+    if (u) {
+        free(u->log_price);
+        free(u->residual);
+        free(u->sector);
+        free(u->group);
+        free(u->sector_return);
+        free(u->group_trend);
+        free(u->group_offset);
+        free(u);
+    }
+}
+
+void synthetic_universe_advance(SyntheticUniverse *u, TickRecord *ticks) {
+    if (!u || !ticks) return;
+
+    const SyntheticUniverseConfig *c = &u->config;
+
+    // regime switch (symmetric two-state chain)
+    if (universe_uniform(u) < c->regime_switch_prob) {
+        u->regime = 1 - u->regime;
+    }
+    double vol = c->base_volatility * (u->regime ? c->stress_vol_multiplier : 1.0);
+    // correlations tighten in stress: factors take a larger share of the variance
+    double market_w = u->regime ? fmin(0.9, c->market_loading * 1.6) : c->market_loading;
+    double sector_w = c->sector_loading;
+    double idio_w = sqrt(fmax(0.0, 1.0 - market_w * market_w - sector_w * sector_w));
+
+    double market = universe_gaussian(u);
+    for (int k = 0; k < c->n_sectors; k++) {
+        u->sector_return[k] = universe_gaussian(u);
+    }
+    for (int g = 0; g < u->n_groups; g++) {
+        // each group's common trend follows the factors of its sector
+        int k = g % c->n_sectors;
+        u->group_trend[g] += vol * (market_w * market + sector_w * u->sector_return[k] +
+                                    idio_w * universe_gaussian(u));
+    }
+
+    u->timestamp_micro += c->tick_interval_micro;
+
+    for (int s = 0; s < c->n_symbols; s++) {
+        int g = u->group[s];
+        if (g >= 0) {
+            // OU residual around the group trend keeps members cointegrated
+            u->residual[s] += -c->mean_reversion_speed * u->residual[s] + vol * universe_gaussian(u);
+            u->log_price[s] = u->group_trend[g] + u->group_offset[s] + u->residual[s];
+        } else {
+            u->log_price[s] += vol * (market_w * market + sector_w * u->sector_return[u->sector[s]] +
+                                      idio_w * universe_gaussian(u));
+        }
+
+        double mid = exp(u->log_price[s]);
+        double spread_bps = c->base_spread_bps * (u->regime ? 2.0 : 1.0) * (0.75 + 0.5 * universe_uniform(u));
+        double half = mid * spread_bps * 1e-4 * 0.5;
+
+        TickRecord *t = &ticks[s];
+        t->timestamp_micro = u->timestamp_micro;
+        t->symbol = s;
+        t->bid = mid - half;
+        t->ask = mid + half;
+        // trades print on either side of the book
+        t->last = universe_uniform(u) < 0.5 ? t->bid : t->ask;
+        t->size = (double)(100 * (1 + (int)(universe_uniform(u) * 10)));
+    }
+}
+
+int synthetic_universe_pairs(const SyntheticUniverse *u, int n_pairs, int *leg1, int *leg2) {
+    if (!u || !leg1 || !leg2 || n_pairs <= 0 || u->config.n_symbols < 2) return 0;
+
+    int count = 0;
+    int group_size = u->config.cointegrated_group_size;
+
+    // cointegrated pairs first: every combination inside each group
+    for (int g = 0; g < u->n_groups && count < n_pairs; g++) {
+        int base = g * group_size;
+        for (int i = 0; i < group_size && count < n_pairs; i++) {
+            for (int j = i + 1; j < group_size && count < n_pairs; j++) {
+                leg1[count] = base + i;
+                leg2[count] = base + j;
+                count++;
+            }
+        }
+    }
+
+    // then the remaining pairs by increasing id distance, skipping ones already taken
+    int n = u->config.n_symbols;
+    for (int offset = 1; offset < n && count < n_pairs; offset++) {
+        for (int s = 0; s < n && count < n_pairs; s++) {
+            int t = (s + offset) % n;
+            if (u->group[s] >= 0 && u->group[s] == u->group[t]) continue;
+            if (s > t) continue;
+            leg1[count] = s;
+            leg2[count] = t;
+            count++;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,725 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sakura_signals.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary tick file, native byte order:
+//
+//   [TickFileHeader]
+//   [block 0][block 1]...      each block: ts[n] sym[n] bid[n] ask[n] last[n] size[n],
+//                              every column starting on a 64-byte boundary
+//   [symbol names]             n_symbols x char[TICK_SYMBOL_LEN]
+//   [block directory]          n_blocks x TickBlockEntry, ordered by time
+//   [symbol index]             CSR: (n_symbols + 1) x uint64 offsets, then
+//                              TickSymbolBlock entries listing the blocks holding each symbol
+//
+// Records are appended in timestamp order, so time lookups are a binary search over
+// the directory and then the block's timestamp column. Readers map the file and
+// hand out pointers into it; nothing is parsed or copied.
+
+#define TICK_FILE_MAGIC "SAKTICK1"
+#define TICK_FILE_VERSION 1
+#define TICK_COLUMN_ALIGN 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t n_symbols;
+    uint64_t n_records;
+    uint32_t n_blocks;
+    uint32_t block_capacity;
+    uint64_t symbol_table_offset;
+    uint64_t directory_offset;
+    uint64_t symbol_index_offset;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    uint8_t reserved[8];
+} TickFileHeader;
+
+struct TickFileWriter {
+    FILE *fp;
+    uint64_t offset;
+    int block_capacity;
+    int block_count;
+    int64_t *ts;
+    int32_t *sym;
+    double *bid;
+    double *ask;
+    double *last;
+    double *size;
+    SymbolTable *symbols;
+    int n_symbols;
+    uint32_t block_symbol_counts[MAX_SYMBOLS];
+    TickBlockEntry *directory;
+    int n_blocks;
+    int directory_capacity;
+    TickSymbolBlock *index_entries;  // unsorted (symbol, block, count) while writing
+    int32_t *index_symbols;
+    long n_index_entries;
+    long index_capacity;
+    uint64_t n_records;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    bool failed;
+};
+
+static uint64_t align_up(uint64_t value) {
+    return (value + TICK_COLUMN_ALIGN - 1) & ~(uint64_t)(TICK_COLUMN_ALIGN - 1);
+}
+
+static void writer_emit(TickFileWriter *w, const void *data, size_t bytes) {
+    if (w->failed || bytes == 0) return;
+    if (fwrite(data, 1, bytes, w->fp) != bytes) {
+        w->failed = true;
+        return;
+    }
+    w->offset += bytes;
+}
+
+static void writer_pad(TickFileWriter *w) {
+    static const uint8_t zeros[TICK_COLUMN_ALIGN] = {0};
+    writer_emit(w, zeros, align_up(w->offset) - w->offset);
+}
+
+// byte offsets of each column inside a block of `count` records
+static void block_column_offsets(uint64_t base, uint32_t count, uint64_t offsets[6]) {
+    static const size_t widths[6] = {
+        sizeof(int64_t), sizeof(int32_t), sizeof(double), sizeof(double), sizeof(double), sizeof(double)
+    };
+    uint64_t at = base;
+    for (int c = 0; c < 6; c++) {
+        offsets[c] = at;
+        at = align_up(at + (uint64_t)count * widths[c]);
+    }
+}
+
+TickFileWriter* tick_writer_create(const char *path, int block_capacity) {
+    if (!path) return NULL;
+    if (block_capacity <= 0) block_capacity = TICK_DEFAULT_BLOCK_CAPACITY;
+
+    TickFileWriter *w = calloc(1, sizeof(TickFileWriter));
+    if (!w) return NULL;
+
+    w->block_capacity = block_capacity;
+    w->ts = malloc(block_capacity * sizeof(int64_t));
+    w->sym = malloc(block_capacity * sizeof(int32_t));
+    w->bid = malloc(block_capacity * sizeof(double));
+    w->ask = malloc(block_capacity * sizeof(double));
+    w->last = malloc(block_capacity * sizeof(double));
+    w->size = malloc(block_capacity * sizeof(double));
+    w->symbols = create_symbol_table(64);
+    w->fp = fopen(path, "wb");
+
+    if (!w->ts || !w->sym || !w->bid || !w->ask || !w->last || !w->size || !w->symbols || !w->fp) {
+        if (w->fp) fclose(w->fp);
+        w->fp = NULL;
+        tick_writer_abort(w);
+        return NULL;
+    }
+
+    // header is rewritten on close once offsets are known
+    TickFileHeader header;
+    memset(&header, 0, sizeof(header));
+    writer_emit(w, &header, sizeof(header));
+    writer_pad(w);
+
+    return w;
+}
+
+int tick_writer_add_symbol(TickFileWriter *w, const char *symbol) {
+    if (!w || !symbol || !symbol[0]) return -1;
+
+    int id = symbol_table_find(w->symbols, symbol);
+    if (id >= 0) return id;
+    if (w->n_symbols >= MAX_SYMBOLS) return -1;
+
+    id = symbol_table_intern(w->symbols, symbol);
+    if (id >= 0) w->n_symbols = w->symbols->n_symbols;
+    return id;
+}
+
+static bool writer_flush_block(TickFileWriter *w) {
+    if (w->block_count == 0) return true;
+
+    if (w->n_blocks == w->directory_capacity) {
+        int capacity = w->directory_capacity ? w->directory_capacity * 2 : 64;
+        TickBlockEntry *grown = realloc(w->directory, capacity * sizeof(TickBlockEntry));
+        if (!grown) return false;
+        w->directory = grown;
+        w->directory_capacity = capacity;
+    }
+
+    writer_pad(w);
+    TickBlockEntry *entry = &w->directory[w->n_blocks];
+    entry->offset = w->offset;
+    entry->count = (uint32_t)w->block_count;
+    entry->reserved = 0;
+    entry->first_timestamp = w->ts[0];
+    entry->last_timestamp = w->ts[w->block_count - 1];
+
+    size_t n = (size_t)w->block_count;
+    writer_emit(w, w->ts, n * sizeof(int64_t));   writer_pad(w);
+    writer_emit(w, w->sym, n * sizeof(int32_t));  writer_pad(w);
+    writer_emit(w, w->bid, n * sizeof(double));   writer_pad(w);
+    writer_emit(w, w->ask, n * sizeof(double));   writer_pad(w);
+    writer_emit(w, w->last, n * sizeof(double));  writer_pad(w);
+    writer_emit(w, w->size, n * sizeof(double));  writer_pad(w);
+
+    // record which symbols this block holds for the symbol index
+    for (int s = 0; s < w->n_symbols; s++) {
+        if (w->block_symbol_counts[s] == 0) continue;
+
+        if (w->n_index_entries == w->index_capacity) {
+            long capacity = w->index_capacity ? w->index_capacity * 2 : 1024;
+            TickSymbolBlock *grown = realloc(w->index_entries, capacity * sizeof(TickSymbolBlock));
+            if (!grown) return false;
+            w->index_entries = grown;
+            int32_t *grown_syms = realloc(w->index_symbols, capacity * sizeof(int32_t));
+            if (!grown_syms) return false;
+            w->index_symbols = grown_syms;
+            w->index_capacity = capacity;
+        }
+        w->index_entries[w->n_index_entries].block = (uint32_t)w->n_blocks;
+        w->index_entries[w->n_index_entries].count = w->block_symbol_counts[s];
+        w->index_symbols[w->n_index_entries] = s;
+        w->n_index_entries++;
+        w->block_symbol_counts[s] = 0;
+    }
+
+    w->n_blocks++;
+    w->block_count = 0;
+    return !w->failed;
+}
+
+bool tick_writer_append(TickFileWriter *w, const TickRecord *tick) {
+    if (!w || !tick || w->failed) return false;
+    if (tick->symbol < 0 || tick->symbol >= w->n_symbols) return false;
+    if (w->n_records > 0 && tick->timestamp_micro < w->last_timestamp) return false; // must be time ordered
+
+    int i = w->block_count;
+    w->ts[i] = tick->timestamp_micro;
+    w->sym[i] = tick->symbol;
+    w->bid[i] = tick->bid;
+    w->ask[i] = tick->ask;
+    w->last[i] = tick->last;
+    w->size[i] = tick->size;
+    w->block_symbol_counts[tick->symbol]++;
+
+    if (w->n_records == 0) w->first_timestamp = tick->timestamp_micro;
+    w->last_timestamp = tick->timestamp_micro;
+    w->n_records++;
+    w->block_count++;
+
+    if (w->block_count == w->block_capacity) {
+        if (!writer_flush_block(w)) {
+            w->failed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+void tick_writer_abort(TickFileWriter *w) {
+    if (w) {
+        if (w->fp) fclose(w->fp);
+        free(w->ts);
+        free(w->sym);
+        free(w->bid);
+        free(w->ask);
+        free(w->last);
+        free(w->size);
+        destroy_symbol_table(w->symbols);
+        free(w->directory);
+        free(w->index_entries);
+        free(w->index_symbols);
+        free(w);
+    }
+}
+
+bool tick_writer_close(TickFileWriter *w) {
+    if (!w) return false;
+
+    bool ok = writer_flush_block(w) && !w->failed;
+
+    TickFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TICK_FILE_MAGIC, 8);
+    header.version = TICK_FILE_VERSION;
+    header.n_symbols = (uint32_t)w->n_symbols;
+    header.n_records = w->n_records;
+    header.n_blocks = (uint32_t)w->n_blocks;
+    header.block_capacity = (uint32_t)w->block_capacity;
+    header.first_timestamp = w->first_timestamp;
+    header.last_timestamp = w->last_timestamp;
+
+    if (ok) {
+        writer_pad(w);
+        header.symbol_table_offset = w->offset;
+        writer_emit(w, w->symbols->names, (size_t)w->n_symbols * TICK_SYMBOL_LEN);
+
+        writer_pad(w);
+        header.directory_offset = w->offset;
+        writer_emit(w, w->directory, (size_t)w->n_blocks * sizeof(TickBlockEntry));
+
+        // counting sort of the (symbol, block) entries into CSR order; blocks stay ascending
+        uint64_t *offsets = calloc((size_t)w->n_symbols + 1, sizeof(uint64_t));
+        TickSymbolBlock *sorted = malloc((w->n_index_entries > 0 ? w->n_index_entries : 1) * sizeof(TickSymbolBlock));
+        if (offsets && sorted) {
+            for (long i = 0; i < w->n_index_entries; i++) offsets[w->index_symbols[i] + 1]++;
+            for (int s = 0; s < w->n_symbols; s++) offsets[s + 1] += offsets[s];
+
+            uint64_t *fill = malloc(((size_t)w->n_symbols + 1) * sizeof(uint64_t));
+            if (fill) {
+                memcpy(fill, offsets, ((size_t)w->n_symbols + 1) * sizeof(uint64_t));
+                for (long i = 0; i < w->n_index_entries; i++) {
+                    sorted[fill[w->index_symbols[i]]++] = w->index_entries[i];
+                }
+                free(fill);
+
+                writer_pad(w);
+                header.symbol_index_offset = w->offset;
+                writer_emit(w, offsets, ((size_t)w->n_symbols + 1) * sizeof(uint64_t));
+                writer_emit(w, sorted, (size_t)w->n_index_entries * sizeof(TickSymbolBlock));
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+        free(offsets);
+        free(sorted);
+    }
+
+    ok = ok && !w->failed;
+    if (ok) {
+        ok = fseeko(w->fp, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, w->fp) == 1;
+    }
+    if (fclose(w->fp) != 0) ok = false;
+    w->fp = NULL;
+
+    tick_writer_abort(w);
+    return ok;
+}
+
+// Every offset readers will dereference must land inside the mapping: the header
+// sections, each block's columns and each symbol's slice of the index. The block
+// data itself is not scanned, so opening stays independent of the file's size.
+static bool tick_file_layout_valid(const uint8_t *base, size_t map_size) {
+    const TickFileHeader *header = (const TickFileHeader *)base;
+    if (header->n_symbols > MAX_SYMBOLS || header->n_blocks > INT_MAX) return false;
+    if (header->symbol_table_offset > map_size || header->directory_offset > map_size ||
+        header->symbol_index_offset > map_size || header->directory_offset % sizeof(uint64_t) != 0 ||
+        header->symbol_index_offset % sizeof(uint64_t) != 0) return false;
+    if (header->symbol_table_offset + (uint64_t)header->n_symbols * TICK_SYMBOL_LEN > map_size ||
+        header->directory_offset + (uint64_t)header->n_blocks * sizeof(TickBlockEntry) > map_size ||
+        header->symbol_index_offset + ((uint64_t)header->n_symbols + 1) * sizeof(uint64_t) > map_size) return false;
+
+    const TickBlockEntry *blocks = (const TickBlockEntry *)(base + header->directory_offset);
+    for (uint32_t b = 0; b < header->n_blocks; b++) {
+        if (blocks[b].offset > map_size || blocks[b].offset % TICK_COLUMN_ALIGN != 0) return false;
+        uint64_t offsets[6];
+        block_column_offsets(blocks[b].offset, blocks[b].count, offsets);
+        if (offsets[5] + (uint64_t)blocks[b].count * sizeof(double) > map_size) return false;
+    }
+
+    const uint64_t *symbol_offsets = (const uint64_t *)(base + header->symbol_index_offset);
+    const TickSymbolBlock *symbol_blocks = (const TickSymbolBlock *)(symbol_offsets + header->n_symbols + 1);
+    uint64_t index_room = (map_size - ((const uint8_t *)symbol_blocks - base)) / sizeof(TickSymbolBlock);
+    if (symbol_offsets[0] != 0) return false;
+    for (uint32_t i = 0; i < header->n_symbols; i++) {
+        if (symbol_offsets[i + 1] < symbol_offsets[i] || symbol_offsets[i + 1] > index_room) return false;
+    }
+    for (uint64_t e = 0; e < symbol_offsets[header->n_symbols]; e++) {
+        if (symbol_blocks[e].block >= header->n_blocks) return false;
+    }
+    return true;
+}
+
+TickFile* tick_file_open(const char *path) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TickFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if (map == MAP_FAILED) return NULL;
+
+    const TickFileHeader *header = map;
+    size_t map_size = (size_t)st.st_size;
+    if (memcmp(header->magic, TICK_FILE_MAGIC, 8) != 0 || header->version != TICK_FILE_VERSION ||
+        !tick_file_layout_valid(map, map_size)) {
+        munmap(map, map_size);
+        return NULL;
+    }
+
+    TickFile *file = calloc(1, sizeof(TickFile));
+    if (!file) {
+        munmap(map, map_size);
+        return NULL;
+    }
+
+    const uint8_t *base = map;
+    file->map = map;
+    file->map_size = map_size;
+    file->n_symbols = (int)header->n_symbols;
+    file->n_blocks = (int)header->n_blocks;
+    file->n_records = header->n_records;
+    file->first_timestamp = header->first_timestamp;
+    file->last_timestamp = header->last_timestamp;
+    file->symbols = (const char (*)[TICK_SYMBOL_LEN])(base + header->symbol_table_offset);
+    file->blocks = (const TickBlockEntry *)(base + header->directory_offset);
+    file->symbol_offsets = (const uint64_t *)(base + header->symbol_index_offset);
+    file->symbol_blocks = (const TickSymbolBlock *)(file->symbol_offsets + file->n_symbols + 1);
+
+    // intern the names once; a file whose names do not map back to their own ids is corrupt
+    file->symbol_table = create_symbol_table(file->n_symbols);
+    bool names_ok = file->symbol_table != NULL;
+    for (int i = 0; i < file->n_symbols && names_ok; i++) {
+        char name[TICK_SYMBOL_LEN];
+        memcpy(name, file->symbols[i], TICK_SYMBOL_LEN);
+        name[TICK_SYMBOL_LEN - 1] = '\0';
+        names_ok = symbol_table_intern(file->symbol_table, name) == i;
+    }
+    if (!names_ok) {
+        tick_file_close(file);
+        return NULL;
+    }
+
+    // replays walk the columns front to back
+    posix_madvise(map, map_size, POSIX_MADV_SEQUENTIAL);
+
+    return file;
+}
+
+void tick_file_close(TickFile *file) {
+    if (file) {
+        munmap(file->map, file->map_size);
+        destroy_symbol_table(file->symbol_table);
+        free(file);
+    }
+}
+
+int tick_file_symbol_id(const TickFile *file, const char *symbol) {
+    if (!file || !symbol) return -1;
+
+    return symbol_table_find(file->symbol_table, symbol);
+}
+
+TickBlockView tick_file_block(const TickFile *file, int block) {
+    TickBlockView view = {0};
+    if (!file || block < 0 || block >= file->n_blocks) return view;
+
+    const TickBlockEntry *entry = &file->blocks[block];
+    uint64_t offsets[6];
+    block_column_offsets(entry->offset, entry->count, offsets);
+
+    const uint8_t *base = file->map;
+    view.timestamp_micro = (const int64_t *)(base + offsets[0]);
+    view.symbol = (const int32_t *)(base + offsets[1]);
+    view.bid = (const double *)(base + offsets[2]);
+    view.ask = (const double *)(base + offsets[3]);
+    view.last = (const double *)(base + offsets[4]);
+    view.size = (const double *)(base + offsets[5]);
+    view.count = (int)entry->count;
+
+    return view;
+}
+
+int tick_file_symbol_blocks(const TickFile *file, int symbol, const TickSymbolBlock **blocks) {
+    if (!file || symbol < 0 || symbol >= file->n_symbols) return 0;
+
+    uint64_t begin = file->symbol_offsets[symbol];
+    uint64_t end = file->symbol_offsets[symbol + 1];
+    if (blocks) *blocks = &file->symbol_blocks[begin];
+    return (int)(end - begin);
+}
+
+TickCursor tick_file_seek(const TickFile *file, int64_t timestamp_micro) {
+    TickCursor cursor = {0, 0};
+    if (!file || file->n_blocks == 0) return cursor;
+
+    // first block whose last timestamp reaches the target
+    int lo = 0, hi = file->n_blocks;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (file->blocks[mid].last_timestamp < timestamp_micro) lo = mid + 1;
+        else hi = mid;
+    }
+    cursor.block = lo;
+    if (lo == file->n_blocks) return cursor; // past the end
+
+    // then the first record at or after the target inside it
+    TickBlockView view = tick_file_block(file, lo);
+    int a = 0, b = view.count;
+    while (a < b) {
+        int mid = a + (b - a) / 2;
+        if (view.timestamp_micro[mid] < timestamp_micro) a = mid + 1;
+        else b = mid;
+    }
+    cursor.index = a;
+
+    return cursor;
+}
+
+// first entry of a symbol's block list whose block reaches start_micro
+static int symbol_blocks_seek(const TickFile *file, const TickSymbolBlock *blocks, int n, int64_t start_micro) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (file->blocks[blocks[mid].block].last_timestamp < start_micro) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// The symbol's last quote before start_micro. It sits in the block the seek lands
+// on or, failing that, in the one listed before it, so at most two blocks are read.
+// With `priced`, quotes without a positive last price are passed over, which may
+// walk further back through the symbol's blocks.
+static bool last_quote_before(const TickFile *file, int symbol, int64_t start_micro, bool priced,
+                              TickBlockView *view, int *row) {
+    const TickSymbolBlock *blocks = NULL;
+    int n = tick_file_symbol_blocks(file, symbol, &blocks);
+    int k = symbol_blocks_seek(file, blocks, n, start_micro);
+
+    for (int j = (k < n ? k : n - 1); j >= 0 && (priced || j >= k - 1); j--) {
+        *view = tick_file_block(file, (int)blocks[j].block);
+        for (int r = view->count - 1; r >= 0; r--) {
+            if (priced && view->last[r] <= 0.0) continue;
+            if (view->symbol[r] == symbol && view->timestamp_micro[r] < start_micro) {
+                *row = r;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Replays one pair; `callback` receives materialized signals, `compact_callback` the
+// hot-path records. Diagnostics are only built when someone asked for them.
+static long replay_pair(const TickFile *file, PairTracker *tracker, int symbol1, int symbol2,
+                        int64_t start_micro, int64_t end_micro, PairSignalCallback callback,
+                        PairSignalCompactCallback compact_callback, void *callback_ctx) {
+    if (!file || !tracker || symbol1 < 0 || symbol2 < 0 ||
+        symbol1 >= file->n_symbols || symbol2 >= file->n_symbols) return 0;
+
+    const TickSymbolBlock *blocks1, *blocks2;
+    int n1 = tick_file_symbol_blocks(file, symbol1, &blocks1);
+    int n2 = tick_file_symbol_blocks(file, symbol2, &blocks2);
+
+    double last1 = 0.0, bid1 = 0.0, ask1 = 0.0;
+    double last2 = 0.0, bid2 = 0.0, ask2 = 0.0;
+    long n_signals = 0;
+
+    // each leg starts from its last quote before the window
+    TickBlockView seed;
+    int seed_row;
+    if (last_quote_before(file, symbol1, start_micro, false, &seed, &seed_row)) {
+        last1 = seed.last[seed_row]; bid1 = seed.bid[seed_row]; ask1 = seed.ask[seed_row];
+    }
+    if (last_quote_before(file, symbol2, start_micro, false, &seed, &seed_row)) {
+        last2 = seed.last[seed_row]; bid2 = seed.bid[seed_row]; ask2 = seed.ask[seed_row];
+    }
+    int i1 = symbol_blocks_seek(file, blocks1, n1, start_micro);
+    int i2 = symbol_blocks_seek(file, blocks2, n2, start_micro);
+
+    // merge the two symbols' block lists so only blocks holding either leg are touched
+    while (i1 < n1 || i2 < n2) {
+        uint32_t block;
+        if (i2 >= n2 || (i1 < n1 && blocks1[i1].block <= blocks2[i2].block)) {
+            block = blocks1[i1].block;
+        } else {
+            block = blocks2[i2].block;
+        }
+        while (i1 < n1 && blocks1[i1].block == block) i1++;
+        while (i2 < n2 && blocks2[i2].block == block) i2++;
+
+        if (file->blocks[block].first_timestamp >= end_micro) break;
+
+        TickBlockView view = tick_file_block(file, (int)block);
+        for (int r = 0; r < view.count; r++) {
+            int32_t sym = view.symbol[r];
+            if (sym != symbol1 && sym != symbol2) continue;
+
+            int64_t ts = view.timestamp_micro[r];
+            if (ts >= end_micro) break;
+
+            // quotes before the window only move the latest prices
+            if (sym == symbol1) {
+                last1 = view.last[r]; bid1 = view.bid[r]; ask1 = view.ask[r];
+            } else {
+                last2 = view.last[r]; bid2 = view.bid[r]; ask2 = view.ask[r];
+            }
+            if (ts < start_micro || last1 <= 0.0 || last2 <= 0.0) continue;
+
+            PairSignalCompact signal = generate_compact_pairs_signal(tracker, last1, last2,
+                                                                     bid1, ask1, bid2, ask2, (long)ts);
+            n_signals++;
+            if (compact_callback) compact_callback(callback_ctx, &signal);
+            if (callback) {
+                PairSignal full = materialize_pair_signal(tracker, true);
+                callback(callback_ctx, &full);
+            }
+        }
+    }
+
+    return n_signals;
+}
+
+long replay_pair_from_tick_file(const TickFile *file, PairTracker *tracker, int symbol1, int symbol2,
+                                int64_t start_micro, int64_t end_micro,
+                                PairSignalCallback callback, void *callback_ctx) {
+    return replay_pair(file, tracker, symbol1, symbol2, start_micro, end_micro, callback, NULL, callback_ctx);
+}
+
+long replay_pair_from_tick_file_compact(const TickFile *file, PairTracker *tracker, int symbol1, int symbol2,
+                                        int64_t start_micro, int64_t end_micro,
+                                        PairSignalCompactCallback callback, void *callback_ctx) {
+    return replay_pair(file, tracker, symbol1, symbol2, start_micro, end_micro, NULL, callback, callback_ctx);
+}
+
+// symbols[0] is the basket's target, symbols[1..n_legs] its legs; every quote of
+// any member updates the basket once all members have a price
+long replay_basket_from_tick_file(const TickFile *file, BasketTracker *basket, const int *symbols,
+                                  int64_t start_micro, int64_t end_micro,
+                                  PairSignalCompactCallback callback, void *callback_ctx) {
+    if (!file || !basket || !symbols) return 0;
+
+    int n_members = basket->n_legs + 1;
+    for (int m = 0; m < n_members; m++) {
+        if (symbols[m] < 0 || symbols[m] >= file->n_symbols) return 0;
+    }
+
+    // symbol -> member slot; a symbol listed twice could never price both its
+    // slots, so such a basket is rejected
+    int *member = malloc(file->n_symbols * sizeof(int));
+    if (!member) return 0;
+    for (int i = 0; i < file->n_symbols; i++) member[i] = -1;
+    for (int m = 0; m < n_members; m++) {
+        if (member[symbols[m]] >= 0) {
+            free(member);
+            return 0;
+        }
+        member[symbols[m]] = m;
+    }
+
+    // each member starts from its last priced quote before the window
+    const TickSymbolBlock *blocks[BASKET_MAX_LEGS + 1];
+    int n_blocks[BASKET_MAX_LEGS + 1], next[BASKET_MAX_LEGS + 1];
+    double last[BASKET_MAX_LEGS + 1] = {0};
+    int n_priced = 0;
+    for (int m = 0; m < n_members; m++) {
+        TickBlockView seed;
+        int row;
+        if (last_quote_before(file, symbols[m], start_micro, true, &seed, &row)) {
+            last[m] = seed.last[row];
+            n_priced++;
+        }
+        n_blocks[m] = tick_file_symbol_blocks(file, symbols[m], &blocks[m]);
+        next[m] = symbol_blocks_seek(file, blocks[m], n_blocks[m], start_micro);
+    }
+
+    long n_signals = 0;
+
+    // merge the members' block lists so only blocks holding one of them are touched
+    for (;;) {
+        uint32_t block = UINT32_MAX;
+        for (int m = 0; m < n_members; m++) {
+            if (next[m] < n_blocks[m] && blocks[m][next[m]].block < block) block = blocks[m][next[m]].block;
+        }
+        if (block == UINT32_MAX) break;
+        for (int m = 0; m < n_members; m++) {
+            while (next[m] < n_blocks[m] && blocks[m][next[m]].block == block) next[m]++;
+        }
+
+        if (file->blocks[block].first_timestamp >= end_micro) break;
+
+        TickBlockView view = tick_file_block(file, (int)block);
+        for (int r = 0; r < view.count; r++) {
+            int32_t sym = view.symbol[r];
+            if (sym < 0 || sym >= file->n_symbols || member[sym] < 0) continue;
+
+            int64_t ts = view.timestamp_micro[r];
+            if (ts >= end_micro) break;
+
+            // quotes before the window only move the latest prices
+            int m = member[sym];
+            if (view.last[r] <= 0.0) continue;
+            if (last[m] <= 0.0) n_priced++;
+            last[m] = view.last[r];
+            if (ts < start_micro || n_priced < n_members) continue;
+
+            PairSignalCompact signal = basket_tracker_update(basket, last[0], last + 1, (long)ts);
+            n_signals++;
+            if (callback) callback(callback_ctx, &signal);
+        }
+    }
+
+    free(member);
+    return n_signals;
+}
+
+long replay_universe_from_tick_file(const TickFile *file, PairUniverse *universe,
+                                    int64_t start_micro, int64_t end_micro,
+                                    PairSignalCallback callback, void *callback_ctx) {
+    if (!file || !universe) return 0;
+
+    // without a callback nobody reads the diagnostics, so only the compact records are built
+    size_t n_slots = universe->n_pairs > 0 ? (size_t)universe->n_pairs : 1;
+    PairSignal *signals = callback ? malloc(n_slots * sizeof(PairSignal)) : NULL;
+    PairSignalCompact *compact = callback ? NULL : malloc(n_slots * sizeof(PairSignalCompact));
+    if (!signals && !compact) return 0;
+
+    // every symbol starts from its last quote before the window, without stepping the pairs
+    for (int sym = 0; sym < universe->n_symbols && sym < file->n_symbols; sym++) {
+        TickBlockView seed;
+        int row;
+        if (!last_quote_before(file, sym, start_micro, false, &seed, &row)) continue;
+        universe->last_price[sym] = seed.last[row];
+        universe->last_bid[sym] = seed.bid[row];
+        universe->last_ask[sym] = seed.ask[row];
+    }
+
+    long n_signals = 0;
+    TickCursor cursor = tick_file_seek(file, start_micro);
+
+    for (int b = cursor.block; b < file->n_blocks; b++) {
+        TickBlockView view = tick_file_block(file, b);
+        if (view.count > 0 && view.timestamp_micro[0] >= end_micro) break;
+
+        for (int r = (b == cursor.block ? cursor.index : 0); r < view.count; r++) {
+            if (view.timestamp_micro[r] >= end_micro) break;
+            if (view.symbol[r] >= universe->n_symbols) continue;
+
+            TickRecord tick;
+            tick.timestamp_micro = view.timestamp_micro[r];
+            tick.symbol = view.symbol[r];
+            tick.bid = view.bid[r];
+            tick.ask = view.ask[r];
+            tick.last = view.last[r];
+            tick.size = view.size[r];
+
+            if (callback) {
+                int n = pair_universe_on_quote(universe, &tick, signals, universe->n_pairs);
+                for (int k = 0; k < n && k < universe->n_pairs; k++) callback(callback_ctx, &signals[k]);
+                n_signals += n;
+            } else {
+                n_signals += pair_universe_on_quote_compact(universe, &tick, compact, universe->n_pairs);
+            }
+        }
+    }
+
+    free(signals);
+    free(compact);
+    return n_signals;
+}
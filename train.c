@@ -0,0 +1,190 @@
+#include "sakura_signals.h"
+#include <pthread.h>
+
+// Fits the regime HMM to pairs of a binary tick file and writes the parameters
+// detectors load with regime_model_load.
+//
+//   ./sakura_signals_train ticks.bin model.rgm SYM1:SYM2 [SYM3:SYM4 ...]
+//                          [--threads N] [--window W] [--iterations N] [--chunk N]
+//
+// Each pair is replayed through a minimal tracker so the features see the same
+// prices and rolling correlation a live detector would. Pairs are replayed in
+// parallel, then regime_train runs Baum-Welch over all of them.
+
+typedef struct {
+    int symbol1;
+    int symbol2;
+    double *vol_feature;
+    double *corr_feature;
+    int n_steps;
+} TrainPair;
+
+typedef struct {
+    const TickFile *file;
+    TrainPair *pairs;
+    int n_pairs;
+    int window;
+    const RegimeModelParams *params;
+    int *next_pair;
+    bool failed;
+} TrainWorker;
+
+static void* train_worker_main(void *arg) {
+    TrainWorker *w = arg;
+
+    for (;;) {
+        int i = __atomic_fetch_add(w->next_pair, 1, __ATOMIC_RELAXED);
+        if (i >= w->n_pairs) break;
+
+        TrainPair *pair = &w->pairs[i];
+        pair->n_steps = regime_features_from_tick_file(w->file, pair->symbol1, pair->symbol2, w->window, w->params,
+                                                       &pair->vol_feature, &pair->corr_feature);
+        if (pair->n_steps < 0) {
+            pair->n_steps = 0;
+            w->failed = true;
+        }
+    }
+    return NULL;
+}
+
+static bool parse_pair(const TickFile *file, const char *text, TrainPair *pair) {
+    const char *colon = strchr(text, ':');
+    if (!colon || colon == text || colon[1] == '\0' || colon - text >= TICK_SYMBOL_LEN) return false;
+
+    char first[TICK_SYMBOL_LEN];
+    memcpy(first, text, (size_t)(colon - text));
+    first[colon - text] = '\0';
+
+    memset(pair, 0, sizeof(*pair));
+    pair->symbol1 = tick_file_symbol_id(file, first);
+    pair->symbol2 = tick_file_symbol_id(file, colon + 1);
+    return pair->symbol1 >= 0 && pair->symbol2 >= 0;
+}
+
+static void print_params(const RegimeModelParams *p) {
+    static const char *names[MAX_REGIMES] = {"normal", "stress", "crisis"};
+    for (int k = 0; k < MAX_REGIMES; k++) {
+        printf("  %-6s  initial %.3f  transition %.4f %.4f %.4f  vol ratio %.3f (sd %.3f)  corr disp %.4f (sd %.4f)\n",
+               names[k], p->initial[k], p->transition[k][0], p->transition[k][1], p->transition[k][2],
+               p->emission_mean[k][0], sqrt(p->emission_var[k][0]),
+               p->emission_mean[k][1], sqrt(p->emission_var[k][1]));
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s ticks.bin model.rgm SYM1:SYM2 [SYM3:SYM4 ...] [--threads N] [--window W] "
+                        "[--iterations N] [--chunk N]\n", argv[0]);
+        return 1;
+    }
+
+    TickFile *file = tick_file_open(argv[1]);
+    if (!file) {
+        fprintf(stderr, "Cannot open tick file %s\n", argv[1]);
+        return 1;
+    }
+
+    RegimeTrainingConfig config;
+    regime_training_default_config(&config);
+    int window = 50;
+
+    TrainPair *pairs = calloc(argc, sizeof(TrainPair));
+    int n_pairs = 0;
+    bool ok = pairs != NULL;
+
+    for (int i = 3; ok && i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0) {
+            if (i + 1 >= argc) ok = false;
+            else if (strcmp(argv[i], "--threads") == 0) ok = (config.n_threads = atoi(argv[i + 1])) > 0;
+            else if (strcmp(argv[i], "--window") == 0) ok = (window = atoi(argv[i + 1])) >= 10;
+            else if (strcmp(argv[i], "--iterations") == 0) ok = (config.max_iterations = atoi(argv[i + 1])) > 0;
+            else if (strcmp(argv[i], "--chunk") == 0) ok = (config.chunk_steps = atoi(argv[i + 1])) >= 2;
+            else ok = false;
+            if (!ok) fprintf(stderr, "Invalid option: %s %s\n", argv[i], i + 1 < argc ? argv[i + 1] : "");
+            i++;
+        } else if (!parse_pair(file, argv[i], &pairs[n_pairs++])) {
+            fprintf(stderr, "Invalid pair: %s\n", argv[i]);
+            ok = false;
+        }
+    }
+    if (ok && n_pairs == 0) {
+        fprintf(stderr, "No pairs given\n");
+        ok = false;
+    }
+
+    RegimeModelParams params;
+    regime_model_default_params(&params);
+
+    // ---- features, one pair per worker at a time
+    uint64_t start = latency_now_ns();
+    long total_steps = 0;
+    if (ok) {
+        int n_threads = config.n_threads < n_pairs ? config.n_threads : n_pairs;
+        TrainWorker *workers = calloc(n_threads, sizeof(TrainWorker));
+        pthread_t *threads = malloc(n_threads * sizeof(pthread_t));
+        ok = workers && threads;
+
+        if (ok) {
+            int next_pair = 0;
+            for (int t = 0; t < n_threads; t++) {
+                workers[t].file = file;
+                workers[t].pairs = pairs;
+                workers[t].n_pairs = n_pairs;
+                workers[t].window = window;
+                workers[t].params = &params;
+                workers[t].next_pair = &next_pair;
+            }
+            // pairs are claimed from a shared counter, so threads that fail to start
+            // just leave more of them to the others
+            int n_started = 1;
+            while (n_started < n_threads &&
+                   pthread_create(&threads[n_started], NULL, train_worker_main, &workers[n_started]) == 0) {
+                n_started++;
+            }
+            train_worker_main(&workers[0]);
+            for (int t = 1; t < n_started; t++) pthread_join(threads[t], NULL);
+            for (int t = 0; t < n_threads; t++) ok = ok && !workers[t].failed;
+        }
+        free(workers);
+        free(threads);
+
+        for (int i = 0; i < n_pairs; i++) total_steps += pairs[i].n_steps;
+        if (!ok) fprintf(stderr, "Feature extraction failed\n");
+    }
+    double extract_s = (double)(latency_now_ns() - start) / 1e9;
+
+    // ---- Baum-Welch
+    RegimeSequence *sequences = ok ? malloc(n_pairs * sizeof(RegimeSequence)) : NULL;
+    RegimeTrainingResult result;
+    if (ok) {
+        ok = sequences != NULL;
+        for (int i = 0; ok && i < n_pairs; i++) {
+            sequences[i].vol_feature = pairs[i].vol_feature;
+            sequences[i].corr_feature = pairs[i].corr_feature;
+            sequences[i].n_steps = pairs[i].n_steps;
+        }
+        start = latency_now_ns();
+        ok = ok && regime_train(sequences, n_pairs, &config, &params, &result);
+        if (!ok) fprintf(stderr, "Training failed\n");
+    }
+
+    if (ok) {
+        printf("%d pairs, %ld steps: features %.2f s, training %.2f s (%d iterations%s, %d threads)\n",
+               n_pairs, total_steps, extract_s, (double)(latency_now_ns() - start) / 1e9, result.iterations,
+               result.converged ? ", converged" : "", config.n_threads);
+        printf("log-likelihood %.6g\n", result.log_likelihood);
+        print_params(&params);
+
+        ok = regime_model_save(&params, argv[2]);
+        if (!ok) fprintf(stderr, "Cannot write %s\n", argv[2]);
+    }
+
+    for (int i = 0; pairs && i < n_pairs; i++) {
+        free(pairs[i].vol_feature);
+        free(pairs[i].corr_feature);
+    }
+    free(pairs);
+    free(sequences);
+    tick_file_close(file);
+    return ok ? 0 : 1;
+}